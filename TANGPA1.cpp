@@ -11,22 +11,344 @@
 #include <stdexcept>
 #include <fstream>  // For file handling
 #include <string>   
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <new>
+#include <cstring>
+#include <charconv>
+#include <cstdint>
+#include <climits>
+#include <cctype>
+#include <cstdlib>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <sstream>
+#include <filesystem>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>  // For the AVX2 / AVX-512 SpMV kernels
+#define SPARSE_MATRIX_X86_SIMD 1
+#endif
+#ifndef _WIN32
+#include <sys/mman.h>  // For memory-mapping the input files
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>  // For the open file limit of the out-of-core merge
+#endif
+
+/**
+ * @struct ValueTraits
+ * @brief Compile-time description of a value type a matrix can hold.
+ *
+ * Specialized for the four value types the matrices are instantiated with. `BINARY_TYPE` is the value
+ * type code of the binary file format, `MARKET_FIELD` the field written in Matrix Market files and
+ * `NAME` the spelling used on the command line.
+ */
+template <typename T>
+struct ValueTraits;
+
+template <>
+struct ValueTraits<std::int32_t> {
+    static constexpr std::uint32_t BINARY_TYPE = 1;
+    static constexpr const char* NAME = "int32";
+    static constexpr const char* MARKET_FIELD = "integer";
+};
+
+template <>
+struct ValueTraits<std::int64_t> {
+    static constexpr std::uint32_t BINARY_TYPE = 2;
+    static constexpr const char* NAME = "int64";
+    static constexpr const char* MARKET_FIELD = "integer";
+};
+
+template <>
+struct ValueTraits<float> {
+    static constexpr std::uint32_t BINARY_TYPE = 3;
+    static constexpr const char* NAME = "float";
+    static constexpr const char* MARKET_FIELD = "real";
+};
+
+template <>
+struct ValueTraits<double> {
+    static constexpr std::uint32_t BINARY_TYPE = 4;
+    static constexpr const char* NAME = "double";
+    static constexpr const char* MARKET_FIELD = "real";
+};
+
+/**
+ * @brief Returns a + b, and for integer types throws instead of overflowing.
+ *
+ * @throws std::overflow_error if the sum of two integers does not fit in T.
+ */
+template <typename T>
+inline T checkedAdd(T a, T b) {
+    if constexpr (std::is_integral<T>::value) {
+        T sum;
+#if defined(__GNUC__)
+        if (__builtin_add_overflow(a, b, &sum)) {
+            throw std::overflow_error("Integer overflow in matrix operation");
+        }
+#else
+        if ((b > 0 && a > std::numeric_limits<T>::max() - b) || (b < 0 && a < std::numeric_limits<T>::min() - b)) {
+            throw std::overflow_error("Integer overflow in matrix operation");
+        }
+        sum = a + b;
+#endif
+        return sum;
+    } else {
+        return a + b;
+    }
+}
+
+/**
+ * @brief Returns a * b, and for integer types throws instead of overflowing.
+ *
+ * @throws std::overflow_error if the product of two integers does not fit in T.
+ */
+template <typename T>
+inline T checkedMultiply(T a, T b) {
+    if constexpr (std::is_integral<T>::value) {
+        T product;
+#if defined(__GNUC__)
+        if (__builtin_mul_overflow(a, b, &product)) {
+            throw std::overflow_error("Integer overflow in matrix operation");
+        }
+#else
+        // Compare with the bounds divided by one factor, by sign, so the product is only formed once it fits
+        const T max = std::numeric_limits<T>::max();
+        const T min = std::numeric_limits<T>::min();
+        if (a > 0 ? (b > 0 ? a > max / b : b < min / a) : (b > 0 ? a < min / b : (a != 0 && b < max / a))) {
+            throw std::overflow_error("Integer overflow in matrix operation");
+        }
+        product = a * b;
+#endif
+        return product;
+    } else {
+        return a * b;
+    }
+}
+
+/**
+ * @brief Writes `value` to `out` with `std::to_chars`: integers as usual, floating-point values in the
+ * shortest form that reads back to the same value.
+ */
+template <typename T>
+inline void writeValue(std::ostream & out, T value) {
+    char buffer[32];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.write(buffer, result.ptr - buffer);
+}
+
+/**
+ * @class BufferedWriter
+ * @brief Formats text into one large block with `std::to_chars` and hands it to a stream a block at a time.
+ *
+ * Used on the export and display paths instead of one `operator<<` per field, which goes through the
+ * sentry and locale of the stream every time. The block is written out when it is full, on flush() and
+ * on destruction; nothing reaches the stream in between, so other writes to it must wait for flush().
+ */
+class BufferedWriter {
+    private:
+    static constexpr std::size_t BLOCK_SIZE = std::size_t(1) << 20;  ///< Bytes gathered before a write.
+    static constexpr std::size_t MAX_NUMBER = 64;                     ///< Room for any single number.
+
+    std::ostream & out;
+    std::unique_ptr<char[]> block;
+    std::size_t used;
+
+    /**
+     * @brief Writes the block out first if fewer than `length` bytes are left in it.
+     */
+    void reserve(std::size_t length) {
+        if (used + length > BLOCK_SIZE) {
+            flush();
+        }
+    }
+
+    public:
+    /**
+     * @brief Constructs a writer that appends to `out`.
+     */
+    explicit BufferedWriter(std::ostream & out) : out(out), block(new char[BLOCK_SIZE]), used(0) {}
+
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter & operator=(const BufferedWriter &) = delete;
+
+    /**
+     * @brief Writes out what is left in the block.
+     */
+    ~BufferedWriter() { flush(); }
+
+    /**
+     * @brief Appends one character.
+     */
+    void put(char c) {
+        reserve(1);
+        block[used++] = c;
+    }
+
+    /**
+     * @brief Appends `length` characters, writing long text straight to the stream.
+     */
+    void write(const char* text, std::size_t length) {
+        if (length == 0) { // `text` may then be null, which memcpy does not allow
+            return;
+        }
+        if (length > BLOCK_SIZE) {
+            flush();
+            out.write(text, length);
+            return;
+        }
+        reserve(length);
+        std::memcpy(block.get() + used, text, length);
+        used += length;
+    }
+
+    /**
+     * @brief Appends a number: integers as usual, floating-point values in the shortest form that reads
+     * back to the same value, as writeValue().
+     */
+    template <typename Number>
+    void writeNumber(Number value) {
+        reserve(MAX_NUMBER);
+        used = std::to_chars(block.get() + used, block.get() + BLOCK_SIZE, value).ptr - block.get();
+    }
+
+    /**
+     * @brief Appends a number the way `std::cout << value` prints it by default: integers as usual,
+     * floating-point values with 6 significant digits.
+     */
+    template <typename Number>
+    void writeDisplayNumber(Number value) {
+        if constexpr (std::is_floating_point<Number>::value) {
+            reserve(MAX_NUMBER);
+            used = std::to_chars(block.get() + used, block.get() + BLOCK_SIZE, value, std::chars_format::general, 6).ptr - block.get();
+        } else {
+            writeNumber(value);
+        }
+    }
+
+    /**
+     * @brief Writes the block to the stream and starts a new one.
+     */
+    void flush() {
+        if (used != 0) {
+            out.write(block.get(), used);
+            used = 0;
+        }
+    }
+};
+
+/**
+ * @enum DisplayMode
+ * @brief How display() prints a matrix on the console.
+ */
+enum class DisplayMode {
+    Auto,    ///< Dense up to DENSE_DISPLAY_LIMIT elements, sparse above.
+    Dense,   ///< Every element, zeros included, one row per line.
+    Sparse,  ///< Only the stored elements, as `row,col,value` lines like the CSV export.
+    None     ///< Nothing at all.
+};
+
+static constexpr std::size_t DENSE_DISPLAY_LIMIT = 10000; ///< Largest rows x cols that DisplayMode::Auto prints densely.
+
+/**
+ * @brief Resolves DisplayMode::Auto for a `numRow` x `numCol` matrix.
+ */
+inline DisplayMode displayModeFor(DisplayMode mode, std::size_t numRow, std::size_t numCol) {
+    if (mode != DisplayMode::Auto) {
+        return mode;
+    }
+    return numCol == 0 || numRow <= DENSE_DISPLAY_LIMIT / numCol ? DisplayMode::Dense : DisplayMode::Sparse;
+}
+
+/**
+ * @struct MatrixStats
+ * @brief Process-wide counters of the hot paths of the matrices, compiled in with `-DSPARSE_MATRIX_STATS`.
+ *
+ * access, insert and remove count their calls and the list nodes they step over (hops) in a local variable
+ * and add them once per call. Node pools add their allocation and free counts when they are destroyed,
+ * and the bytes of their slabs when a slab is allocated or released. Without SPARSE_MATRIX_STATS the
+ * SPARSE_MATRIX_COUNT macro does nothing and the counters stay at zero.
+ */
+struct MatrixStats {
+#ifdef SPARSE_MATRIX_STATS
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+
+    std::atomic<std::uint64_t> accessCalls{0};      ///< Calls to access().
+    std::atomic<std::uint64_t> accessHops{0};       ///< Nodes stepped over by access().
+    std::atomic<std::uint64_t> insertCalls{0};      ///< Calls to insert().
+    std::atomic<std::uint64_t> insertHops{0};       ///< Nodes stepped over by insert(), in the row and the column.
+    std::atomic<std::uint64_t> removeCalls{0};      ///< Calls to remove().
+    std::atomic<std::uint64_t> removeHops{0};       ///< Nodes stepped over by remove(), in the row and the column.
+    std::atomic<std::uint64_t> nodeAllocations{0};  ///< Nodes handed out by destroyed pools.
+    std::atomic<std::uint64_t> nodeFrees{0};        ///< Nodes given back to destroyed pools.
+    std::atomic<std::uint64_t> bytesHeld{0};        ///< Bytes of the slabs currently allocated.
+    std::atomic<std::uint64_t> peakBytesHeld{0};    ///< Highest value of bytesHeld.
+
+    /**
+     * @brief Adds `bytes` to the bytes held, raising the peak if needed.
+     */
+    void addBytes(std::uint64_t bytes) {
+        std::uint64_t held = bytesHeld.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        std::uint64_t peak = peakBytesHeld.load(std::memory_order_relaxed);
+        while (held > peak && !peakBytesHeld.compare_exchange_weak(peak, held, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Writes the counters, one per line, or a note that they were compiled out.
+     */
+    void report(std::ostream & out) const;
+};
+
+/**
+ * @brief Returns the counters of the process.
+ */
+inline MatrixStats & matrixStats() {
+    static MatrixStats stats;
+    return stats;
+}
+
+#ifdef SPARSE_MATRIX_STATS
+#define SPARSE_MATRIX_COUNT(counter, amount) (matrixStats().counter.fetch_add((amount), std::memory_order_relaxed))
+#else
+#define SPARSE_MATRIX_COUNT(counter, amount) ((void)(amount))  // Compiled out, the local counts are optimized away
+#endif
 
 /**
  * @struct Node
  * @brief Represents a node in a circularly-linked list for a sparse matrix.
  *
- * The Node struct holds an integer data value and pointers to the next nodes
+ * The Node struct holds a data value of type T and pointers to the next nodes
  * in the same row and column of the sparse matrix. This allows efficient
  * traversal of non-zero elements in the matrix.
+ *
+ * Members are laid out from the widest to the narrowest so that no padding is needed between them:
+ * with 32-bit indices and values a node is 32 bytes, and with 16-bit indices and a float it is 24.
  */
+template <typename T, typename Index>
 struct Node {
-    int data;     ///< The data value stored in the node.
-    unsigned int rowIndex; ///< The row index of the node (for the matrix).
-    unsigned int colIndex; ///< The column index of the node (for the matrix).
     Node* nextRow; ///< Pointer to the next node in the same column.
     Node* nextCol; ///< Pointer to the next node in the same row.
+    Index rowIndex; ///< The row index of the node (for the matrix).
+    Index colIndex; ///< The column index of the node (for the matrix).
+    T data;     ///< The data value stored in the node.
 
     /**
      * @brief Constructs a new Node object.
@@ -34,537 +356,7573 @@ struct Node {
      * Initializes the node with the specified data, row index, and column index.
      * Pointers are set to nullptr by default.
      *
-     * @param int data The value stored in the node.
-     * @param unsigned int rowIndex The row number of the node in the matrix.
-     * @param unsigned int colIndex The column number of the node in the matrix.
+     * @param T data The value stored in the node.
+     * @param Index rowIndex The row number of the node in the matrix.
+     * @param Index colIndex The column number of the node in the matrix.
      */
-    Node(int data = 0, unsigned int rowIndex = 0, unsigned int colIndex = 0)
-        : data{data}, rowIndex{rowIndex}, colIndex{colIndex}, nextRow{nullptr}, nextCol{nullptr} {}
+    Node(T data = 0, Index rowIndex = 0, Index colIndex = 0)
+        : nextRow{nullptr}, nextCol{nullptr}, rowIndex{rowIndex}, colIndex{colIndex}, data{data} {}
 };
 
+static_assert(sizeof(Node<float, std::uint16_t>) < sizeof(Node<std::int32_t, std::uint32_t>), "narrow nodes must be smaller");
+
 /**
- * @class SparseMatrix
- * @brief Represents a Sparse Matrix using circularly-linked lists.
+ * @struct Triplet
+ * @brief One (row, column, value) entry of a matrix, as read from an input file.
  *
- * The SparseMatrix class efficiently stores non-zero elements of a matrix using circularly-linked lists.
- * Each non-zero element is represented as a Node, which contains its value, row, and column indices.
- * The matrix is sparse, meaning that most elements are zero, so only non-zero elements are stored.
- * The class supports various matrix operations such as addition, multiplication, transposition, and scalar multiplication.
+ * Used to hand a batch of entries to SparseMatrix::fromTriplets.
  */
-class SparseMatrix {
+template <typename T, typename Index>
+struct Triplet {
+    T data;          ///< The value of the entry.
+    Index rowIndex;  ///< The row index of the entry.
+    Index colIndex;  ///< The column index of the entry.
+
+    /**
+     * @brief Constructs a new Triplet object.
+     *
+     * @param T data The value of the entry.
+     * @param Index rowIndex The row index of the entry.
+     * @param Index colIndex The column index of the entry.
+     */
+    Triplet(T data = 0, Index rowIndex = 0, Index colIndex = 0)
+        : data{data}, rowIndex{rowIndex}, colIndex{colIndex} {}
+};
+
+/**
+ * @class SlabCache
+ * @brief Keeps the slabs released by node pools on one thread for the next pools built on that thread.
+ *
+ * Caching is off until a thread creates a SlabCache, and lasts until the cache is destroyed. While it is on,
+ * NodePool takes its slabs from the cache when one of the right size is there, and gives them back to the
+ * cache instead of freeing them, up to a byte limit. The batch workers of `main` each hold one, so a job
+ * builds its matrices in the memory of the previous job instead of going back to the system every time.
+ * Other threads can share() a cache, as the threads of a ThreadPool built for it do; a lock then guards it.
+ */
+class SlabCache {
     private:
-    Node* header;  ///< Pointer to the very header node 0:0
-    unsigned int numRow;  // Number of rows in the matrix
-    unsigned int numCol; // Number of columns in the matrix
-    Node** rowHeaders;  // Dynamic Array of pointers that point to row-header nodes
-    Node** colHeaders;  // Dynamic Array of pointers that point to column-header nodes
+    /**
+     * @struct Block
+     * @brief One cached slab.
+     */
+    struct Block {
+        void* memory;       ///< Start of the slab.
+        std::size_t bytes;  ///< Size of the slab.
+    };
+
+    static SlabCache*& active() {
+        thread_local SlabCache* cache = nullptr;
+        return cache;
+    }
 
+    std::mutex lock;            ///< Guards the blocks, for the threads that share the cache.
+    std::vector<Block> blocks;  ///< Cached slabs, most recently released last.
+    std::size_t bytesCached;    ///< Sum of the sizes of the cached slabs.
+    std::size_t byteLimit;      ///< Slabs that would take the cache past this size are freed.
+    SlabCache* previous;        ///< The cache this one replaced on the thread.
 
     public:
     /**
-     * @brief Constructs a SparseMatrix object.
-     *
-     * Initializes a sparse matrix of the specified dimension (row x col).
+     * @brief Turns caching on for the calling thread.
      *
-     * @param unsigned int numRow The number of rows of the matrix
-     * @param unsigned int numCol The number of columns of the matrix
+     * @param std::size_t byteLimit The most bytes of slabs kept at a time.
      */
-    SparseMatrix(unsigned int numRow = 0, unsigned int numCol = 0) : numRow(numRow), numCol(numCol) {
-        header = new Node(0, numRow, numCol); //Create a Top-Left Header node at 0:0 with row and col numbers stored inside rowIndex, colIndex
-
-        // Allocate memory for row and column headers, and initialize each with a placeholder node
-        rowHeaders = new Node*[numRow + 1];  // +1 to handle 1-based indexing
-        colHeaders = new Node*[numCol + 1];  // +1 to handle 1-based indexing
+    explicit SlabCache(std::size_t byteLimit = std::size_t(256) << 20)
+        : bytesCached(0), byteLimit(byteLimit), previous(active()) {
+        active() = this;
+    }
 
-        // Assign header to be the first element of rowHeaders and colHeaders arrays
-        rowHeaders[0] = header;
-        colHeaders[0] = header;
+    SlabCache(const SlabCache &) = delete;
+    SlabCache & operator=(const SlabCache &) = delete;
 
-        // Giving placeholders some dummy values
-        for (int i = 1; i <= numRow; i++) {
-            rowHeaders[i] = new Node(0, i, 0);  // Placeholder for each row
-            rowHeaders[i]->nextCol = rowHeaders[i];  // Circular: points back to its placeholder node
+    /**
+     * @brief Frees the cached slabs and turns caching off again (or back to the previous cache).
+     */
+    ~SlabCache() {
+        active() = previous;
+        for (const Block & block : blocks) {
+            ::operator delete(block.memory);
         }
+    }
+
+    /**
+     * @brief Makes `cache` the cache of the calling thread as well, or turns caching off with nullptr. The
+     * cache must outlive the thread's use of it.
+     */
+    static void share(SlabCache* cache) {
+        active() = cache;
+    }
 
-        for (int j = 1; j <= numCol; j++) {
-            colHeaders[j] = new Node(0, 0, j);  // Placeholder for each column
-            colHeaders[j]->nextRow = colHeaders[j];  // Circular: points back to itself
+    /**
+     * @brief Returns a slab of `bytes` bytes: a cached one of that size if the thread has one, else a new one.
+     */
+    static void* allocate(std::size_t bytes) {
+        SlabCache* cache = active();
+        if (cache != nullptr) {
+            std::lock_guard<std::mutex> guard(cache->lock);
+            for (std::size_t i = cache->blocks.size(); i-- > 0;) {
+                if (cache->blocks[i].bytes == bytes) {
+                    void* memory = cache->blocks[i].memory;
+                    cache->blocks.erase(cache->blocks.begin() + i);
+                    cache->bytesCached -= bytes;
+                    return memory;
+                }
+            }
         }
+        return ::operator new(bytes);
     }
 
     /**
-     * @brief Destructor for the SparseMatrix class.
-     *
-     * The destructor is responsible for freeing all dynamically allocated memory
-     * associated with the sparse matrix. It traverses the matrix to delete
-     * all nodes and ensures that no memory leaks occur when the SparseMatrix object
-     * is destroyed.
+     * @brief Gives back a slab obtained from allocate(), to the cache of the calling thread if it has room.
      */
-    ~SparseMatrix() {
-        // Delete all nodes by traversing through each row (excluding the row headers)
-        for (int i = 1; i <= numRow; i++) {
-            Node* current = rowHeaders[i]->nextCol;
-            Node* head = rowHeaders[i]; // The header of the row
-            while (current != head) {  // Stop when we return to the header
-                Node* nextNode = current->nextCol;
-                delete current;
-                current = nextNode;
+    static void release(void* memory, std::size_t bytes) {
+        SlabCache* cache = active();
+        if (cache != nullptr) {
+            std::lock_guard<std::mutex> guard(cache->lock);
+            if (cache->bytesCached + bytes <= cache->byteLimit) {
+                cache->blocks.push_back(Block{memory, bytes});
+                cache->bytesCached += bytes;
+                return;
             }
-            delete rowHeaders[i]; // Delete the row header itself
         }
+        ::operator delete(memory);
+    }
 
-        // Free the arrays of row and column headers
-        delete[] rowHeaders;
-        delete[] colHeaders;
-        rowHeaders = nullptr;
-        colHeaders =nullptr;
-        // Finally delete the header pointer
-        delete header;
-        header = nullptr;
+    /**
+     * @brief Returns the bytes of the slabs currently cached.
+     */
+    std::size_t bytes() const {
+        return bytesCached;
     }
-   
+};
+
+/**
+ * @class NodePool
+ * @brief Slab allocator that owns every Node of one SparseMatrix, for nodes of type `Node<T, Index>`.
+ *
+ * Nodes are carved out of large slabs instead of being allocated one by one with `new`. Removed nodes
+ * go on a free list (linked through `nextCol`) and are handed out again first. Since Node has no
+ * resources of its own, destroying the pool releases all the slabs at once, without visiting any node,
+ * and reset() recycles every node at once while keeping the slabs for the next matrix built in the pool.
+ * Slabs go through the SlabCache of the thread, if it has one.
+ */
+template <typename T, typename Index>
+class NodePool {
+    private:
+    using Node = ::Node<T, Index>;
+
+    static constexpr std::size_t MIN_SLAB_NODES = 64;     ///< Size of the first slab when nothing was reserved.
+    static constexpr std::size_t MAX_SLAB_NODES = 65536;  ///< Slabs stop doubling at this size.
+
+    /**
+     * @struct Slab
+     * @brief One contiguous block of uninitialized nodes.
+     */
+    struct Slab {
+        Node* nodes;           ///< Start of the block.
+        std::size_t capacity;  ///< Number of nodes the block can hold.
+    };
+
+    std::vector<Slab> slabs;     ///< Every slab owned by the pool, the ones after `currentSlab` are spare.
+    std::size_t currentSlab;     ///< Index of the slab being filled.
+    std::size_t slabUsed;        ///< Number of nodes handed out from the current slab.
+    std::size_t nextSlabNodes;   ///< Capacity of the next slab to allocate.
+    Node* freeList;              ///< Released nodes, ready to be reused.
+    std::size_t allocations;     ///< Number of allocate() calls.
+    std::size_t frees;           ///< Number of release() calls.
+
     /**
-     * @brief Displays the entire sparse matrix.
+     * @brief Makes the next slab of at least `minNodes` nodes the current one: the following spare slab
+     * if it is large enough, or else a newly allocated one.
      *
-     * This function iterates through the entire matrix and prints the elements.
-     * If a node exists for a specific row and column, it prints the node's data.
-     * Otherwise, it prints 0 for elements that are not explicitly stored.
+     * @param std::size_t minNodes The minimum capacity of the slab.
      */
-    void display();
+    void addSlab(std::size_t minNodes);
 
     /**
-     * @brief Returns the row length of the Sparse Matrix.
+     * @brief Frees every slab, and adds the counts of the pool to matrixStats() when they are compiled in.
+     */
+    void releaseSlabs();
+
+    public:
+    /**
+     * @brief Constructs an empty pool. No memory is allocated until the first node is requested.
+     */
+    NodePool() : currentSlab(0), slabUsed(0), nextSlabNodes(MIN_SLAB_NODES), freeList(nullptr), allocations(0), frees(0) {}
+
+    /**
+     * @brief Takes over the slabs of another pool, leaving it empty.
      *
-     * This method returns the row length of the matrix. For example,
-     * if the matrix is 10x5, this method will return 10.
-     * The method is marked as 'const', guarantees that the state of the matrix is not altered.
-     * 
-     * @return int: The row length of the matrix.
+     * @param NodePool && other The pool to move from.
      */
-    int rowLength() const;
+    NodePool(NodePool && other) noexcept;
 
     /**
-     * @brief Returns the column length of the Sparse Matrix.
+     * @brief Releases the slabs of this pool and takes over those of another pool, leaving it empty.
      *
-     * This method returns the column length of the matrix. For example,
-     * if the matrix is 10x5, this method will return 5.
-     * The method is marked as 'const', guarantees that the state of the matrix is not altered.
+     * @param NodePool && other The pool to move from.
      *
-     * @return int: The column length of the matrix.
+     * @return NodePool & This pool.
      */
-    int colLength() const;
+    NodePool & operator=(NodePool && other) noexcept;
+
+    NodePool(const NodePool &) = delete;
+    NodePool & operator=(const NodePool &) = delete;
 
     /**
-     * @brief Accesses the value at the specified row and column in the sparse matrix.
+     * @brief Releases every slab in bulk. All nodes handed out by the pool become invalid.
+     */
+    ~NodePool();
+
+    /**
+     * @brief Makes sure the next slab holds at least `count` nodes, e.g. for the header nodes of a matrix.
      *
-     * This method retrieves the value stored in the matrix at the given row and column.
-     * If no value is stored at that position, it will return 0
-     * The method is marked as 'const', guarantees that the state of the matrix is not altered.
+     * @param std::size_t count The number of nodes about to be allocated.
+     */
+    void reserve(std::size_t count);
+
+    /**
+     * @brief Returns a node initialized like `new Node(data, rowIndex, colIndex)`.
      *
-     * @param int rowIndex The row index of the element to access.
-     * @param int colIndex The column index of the element to access.
-     * 
-     * @return int The value at the specified row and column. Returns 0 if the element is not stored.
-     * 
-     * @throws std::out_of_range if the rowIndex or colIndex is outside the matrix bounds.
+     * @param T data The value stored in the node.
+     * @param Index rowIndex The row number of the node in the matrix.
+     * @param Index colIndex The column number of the node in the matrix.
+     *
+     * @return Node* The new node, owned by the pool.
      */
-    int access(int rowIndex, int colIndex) const;
+    Node* allocate(T data = 0, Index rowIndex = 0, Index colIndex = 0);
 
     /**
-     * @brief Adds a non-zero element to the matrix.
+     * @brief Puts a node back on the free list.
      *
-     * Inserts a new non-zero element into the matrix at the specified row and column.
-     * This method uses the circularly-linked list structure to efficiently store the element.
+     * @param Node* node A node previously returned by allocate() on this pool.
+     */
+    void release(Node* node);
+
+    /**
+     * @brief Takes over the slabs and free nodes of another pool, leaving it empty.
      *
-     * @param int data The non-zero value to be added to the matrix.
-     * @param int rowIndex The row index of the element.
-     * @param int colIndex The column index of the element.
-     * 
-     * @throws std::out_of_range if the rowIndex or colIndex is outside the matrix bounds.
+     * Used to merge the pools in which parallel tasks built their part of a matrix. The nodes keep their
+     * addresses and now belong to this pool.
+     *
+     * @param NodePool && other The pool to merge into this one.
      */
-    void insert(int data, int rowIndex, int colIndex);
+    void adopt(NodePool && other);
 
     /**
-     * @brief Removes a non-zero element from the sparse matrix at the specified row and column.
+     * @brief Takes back every node handed out, without visiting them or freeing any slab.
      *
-     * This function removes the element at the given row and column in the sparse matrix.
-     * It throws an exception if the specified element is zero (indicating no non-zero element at that position),
-     * or if the row and column indices are out of bounds for the matrix.
+     * Allocation starts again at the beginning of the first slab, so a matrix rebuilt in the pool gets
+     * the memory of the previous one. All nodes handed out by the pool become invalid.
+     */
+    void reset();
+
+    std::size_t allocationCount() const { return allocations; }  ///< Number of nodes ever allocated.
+    std::size_t freeCount() const { return frees; }              ///< Number of nodes ever released.
+    std::size_t liveNodes() const { return allocations - frees; } ///< Number of nodes currently in use.
+    std::size_t slabCount() const { return slabs.size(); }        ///< Number of slabs held.
+
+    /**
+     * @brief Returns the number of bytes reserved by all the slabs.
      *
-     * @param int rowIndex The row index of the element to remove.
-     * @param int colIndex The column index of the element to remove.
-     * 
-     * @throws std::out_of_range if the rowIndex or colIndex is outside the matrix bounds.
-     * @throws std::invalid_argument if the element at the specified position is zero (no non-zero element to remove).
+     * @return std::size_t The memory held by the pool.
      */
-    void remove(int rowIndex, int colIndex);
+    std::size_t bytesReserved() const;
+};
 
+/**
+ * @class ThreadPool
+ * @brief Fixed set of worker threads that run submitted tasks, with work stealing.
+ *
+ * Every worker owns a task deque. Tasks submitted from a worker go to its own deque, the others are
+ * spread round-robin. A worker takes its newest task first and, when its deque is empty, steals the
+ * oldest task of another worker, so unevenly sized tasks still keep every thread busy.
+ */
+class ThreadPool {
+    private:
     /**
-     * @brief Perform matrix addition of two sparse matrices.
-     * 
-     * This function performs the matrix addition operation on two input sparse matrices, `a` and `b`. 
-     * The function returns a new sparse matrix, `c`, which represents the sum of the input matrices. 
-     * Matrix addition is only valid when the dimensions of both matrices are the same. If the input 
-     * matrices have different dimensions, an exception will be thrown.
-     * 
-     * The parameters are passed as `const` references to avoid unnecessary copying and to ensure 
-     * that the input matrices are not modified by the function, improving both performance and safety.
-     * 
-     * @param const SparseMatrix & a: A const reference to a SparseMatrix object representing the first matrix to be added. 
-     *          Passing by reference avoids copying the matrix, and the const qualifier ensures that 
-     *          the matrix is not modified.
-     * @param const SparseMatrix & b: A const reference to a SparseMatrix object representing the second matrix to be added. 
-     *          Like `a`, this is passed by reference for efficiency and marked const to guarantee 
-     *          the matrix is not altered.
-     * 
-     * @return SparseMatrix The resulting sparse matrix `c` after adding matrix `a` and matrix `b`.
-     * 
-     * @throws std::invalid_argument If the dimensions of matrices `a` and `b` do not match.
+     * @struct WorkerQueue
+     * @brief The task deque of one worker.
      */
-    static SparseMatrix matrixAddition(const SparseMatrix & a, const SparseMatrix & b);
+    struct WorkerQueue {
+        std::mutex lock;                               ///< Guards `tasks`.
+        std::deque<std::function<void()>> tasks;       ///< Tasks waiting to run.
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;  ///< One deque per worker.
+    std::vector<std::thread> workers;                  ///< The worker threads.
+    std::mutex stateLock;                              ///< Guards the counters below.
+    std::condition_variable wakeUp;                    ///< Signalled when tasks are queued or on shutdown.
+    std::condition_variable allDone;                   ///< Signalled when no task is pending any more.
+    std::size_t queued;                                ///< Tasks waiting in the deques.
+    std::size_t pending;                               ///< Tasks submitted and not finished yet.
+    std::size_t nextQueue;                             ///< Round-robin target for outside submissions.
+    bool stopping;                                     ///< Set by the destructor.
+    std::exception_ptr firstError;                     ///< First exception thrown by a task.
 
     /**
-     * @brief Perform matrix multiplication of two sparse matrices.
-     * 
-     * This function performs the matrix multiplication operation on two input sparse matrices, `a` and `b`. 
-     * The function returns a new sparse matrix, `c`, which represents the sum of the input matrices. 
-     * Matrix multiplication is only valid when the number of columns of the first matrix equal to the number of rows
-     * of the second matrix
-     * 
-     * The parameters are passed as `const` references to avoid unnecessary copying and to ensure 
-     * that the input matrices are not modified by the function, improving both performance and safety.
-     * 
-     * @param const SparseMatrix & a: A const reference to a SparseMatrix object representing the first matrix to be added. 
-     *          Passing by reference avoids copying the matrix, and the const qualifier ensures that 
-     *          the matrix is not modified.
-     * @param const SparseMatrix & b: A const reference to a SparseMatrix object representing the second matrix to be added. 
-     *          Like `a`, this is passed by reference for efficiency and marked const to guarantee 
-     *          the matrix is not altered.
-     * 
-     * @return SparseMatrix The resulting sparse matrix `c` after multipliying matrix `a` and matrix `b`.
-     * 
-     * @throws std::invalid_argument If the dimensions of matrices `a` and `b` are not valid to perform matrix multiplication.
+     * @brief Takes a task from the worker's own deque, or steals one from another worker.
+     *
+     * @return bool false if every deque was empty.
      */
-    static SparseMatrix matrixMultiplication(const SparseMatrix & a, const SparseMatrix & b);
+    bool takeTask(std::size_t index, std::function<void()> & task);
 
     /**
-     * @brief Perform matrix transposition on a sparse matrix.
-     * 
-     * This function performs the transposition operation on the input sparse matrix `a`. 
-     * The function returns a new sparse matrix, `b`, which represents the transposed version of the input matrix.
-     * In matrix transposition, the rows of the matrix are turned into columns and vice versa.
-     * 
-     * The parameter is passed as a `const` reference to avoid unnecessary copying and to ensure 
-     * that the input matrix is not modified by the function, improving both performance and safety.
-     * 
-     * @param const SparseMatrix & a: A const reference to a SparseMatrix object representing the matrix to be transposed. 
-     *          Passing by reference avoids copying the matrix, and the const qualifier ensures that 
-     *          the matrix is not modified.
-     * 
-     * @return SparseMatrix The resulting sparse matrix `b` after transposing matrix `a`.
+     * @brief Main loop of worker `index`.
      */
-    static SparseMatrix matrixTransposition(const SparseMatrix & a);
+    void workerLoop(std::size_t index, SlabCache * slabs);
+
+    public:
+    /**
+     * @brief Starts `threads` workers (at least one).
+     *
+     * @param unsigned int threads The number of worker threads.
+     * @param SlabCache * slabs A cache the workers share(), so that node pools built on them reuse its slabs,
+     *        or nullptr. It must outlive the pool.
+     */
+    explicit ThreadPool(unsigned int threads, SlabCache * slabs = nullptr);
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief Finishes the queued tasks and joins the workers.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Returns the number of worker threads.
+     */
+    std::size_t size() const { return workers.size(); }
+
+    /**
+     * @brief Queues a task. It must not call wait() on the same pool.
+     *
+     * @param std::function<void()> task The task to run.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Blocks until every submitted task has finished.
+     *
+     * @throws The first exception thrown by a task since the last wait(), if any.
+     */
+    void wait();
+
+    /**
+     * @brief Runs `body(first, last)` over `parts` even slices of [begin, end) and waits for them.
+     *
+     * @param std::size_t begin The first index.
+     * @param std::size_t end One past the last index.
+     * @param std::size_t parts The number of slices.
+     * @param Function body Called with the bounds of every slice.
+     */
+    template <typename Function>
+    void parallelFor(std::size_t begin, std::size_t end, std::size_t parts, Function body);
+};
+
+/**
+ * @class BoundedQueue
+ * @brief Queue of at most `capacity` items between two threads, which caps the memory held between two
+ * stages of a pipeline.
+ *
+ * push() blocks while the queue is full and pop() while it is empty. close() ends the stream: pop() then
+ * returns false once the queued items are gone.
+ */
+template <typename Item>
+class BoundedQueue {
+    private:
+    std::deque<Item> items;
+    std::size_t capacity;
+    bool closed;
+    std::mutex lock;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+
+    public:
+    /**
+     * @brief Constructs an empty queue holding up to `capacity` items (at least one).
+     */
+    explicit BoundedQueue(std::size_t capacity) : capacity(std::max<std::size_t>(1, capacity)), closed(false) {}
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue & operator=(const BoundedQueue &) = delete;
+
+    /**
+     * @brief Appends an item, waiting for room first.
+     */
+    void push(Item item) {
+        std::unique_lock<std::mutex> guard(lock);
+        notFull.wait(guard, [this]() { return items.size() < capacity; });
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+    }
+
+    /**
+     * @brief Takes the oldest item, waiting for one first.
+     *
+     * @return bool false if the queue is closed and empty.
+     */
+    bool pop(Item & item) {
+        std::unique_lock<std::mutex> guard(lock);
+        notEmpty.wait(guard, [this]() { return closed || !items.empty(); });
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Marks the end of the stream. No item may be pushed afterwards.
+     */
+    void close() {
+        std::lock_guard<std::mutex> guard(lock);
+        closed = true;
+        notEmpty.notify_all();
+    }
+};
+
+template <typename T = std::int32_t, typename Index = std::uint32_t> class TransposedView;
+template <typename T = std::int32_t, typename Index = std::uint32_t> class MatrixExpression;
+template <typename T = std::int32_t, typename Index = std::uint32_t> struct CompressedStorage;
+template <typename T = std::int32_t, typename Index = std::uint32_t> class CSRMatrix;
+template <typename T = std::int32_t, typename Index = std::uint32_t> class CSCMatrix;
+class BinaryMatrixFile;
+
+/**
+ * @class SparseMatrix
+ * @brief Represents a Sparse Matrix using circularly-linked lists.
+ *
+ * The SparseMatrix class efficiently stores non-zero elements of a matrix using circularly-linked lists.
+ * Each non-zero element is represented as a Node, which contains its value, row, and column indices.
+ * The matrix is sparse, meaning that most elements are zero, so only non-zero elements are stored.
+ * The class supports various matrix operations such as addition, multiplication, transposition, and scalar multiplication.
+ *
+ * The matrix is a template over the type of its values `T` and of its indices `Index` (an unsigned type
+ * wide enough for the dimensions), and is explicitly instantiated for int32, int64, float and double values
+ * with 32-bit indices. Integer additions and products throw std::overflow_error instead of wrapping around.
+ */
+template <typename T = std::int32_t, typename Index = std::uint32_t>
+class SparseMatrix {
+    static_assert(std::is_unsigned<Index>::value, "Index must be an unsigned integer type");
+
+    public:
+    using Node = ::Node<T, Index>;
+    using Triplet = ::Triplet<T, Index>;
+    using NodePool = ::NodePool<T, Index>;
+    using TransposedView = ::TransposedView<T, Index>;
+    using CSRMatrix = ::CSRMatrix<T, Index>;
+    using CSCMatrix = ::CSCMatrix<T, Index>;
+    using CompressedStorage = ::CompressedStorage<T, Index>;
+
+    private:
+    Node* header;  ///< Pointer to the very header node 0:0
+    Index numRow;  // Number of rows in the matrix
+    Index numCol; // Number of columns in the matrix
+    Node** rowHeaders;  // Dynamic Array of pointers that point to row-header nodes
+    Node** colHeaders;  // Dynamic Array of pointers that point to column-header nodes
+    NodePool pool;  // Owns every node of the matrix, including the header and placeholder nodes
+
+    /**
+     * @struct LineIndex
+     * @brief Ordered index of the long rows and columns of the matrix: column to node for a row, row to
+     * node for a column. Point lookups and updates on an indexed line take O(log n) instead of a list walk.
+     */
+    struct LineIndex {
+        std::size_t minLength;  ///< A line is indexed once a walk along it passes this many nodes.
+        std::vector<std::unique_ptr<std::map<Index, Node*>>> rows;  ///< Index of row i, or null.
+        std::vector<std::unique_ptr<std::map<Index, Node*>>> cols;  ///< Index of column j, or null.
+    };
+    std::unique_ptr<LineIndex> index;  // Null unless buildIndex() was called
+
+    /**
+     * @brief Appends a new node at the tail of its row list and its column list.
+     *
+     * Used by the bulk operations that produce a matrix row by row. Nodes must be emitted in increasing
+     * column order within a row and in increasing row order overall, so that appending at the tails keeps
+     * every list sorted without searching.
+     *
+     * @param T data The non-zero value of the new node.
+     * @param Index rowIndex The row index of the new node.
+     * @param Index colIndex The column index of the new node.
+     * @param Node*& rowTail The last node of the row list, advanced to the new node.
+     * @param std::vector<Node*> & colTails The last node of every column list, updated for `colIndex`.
+     */
+    void appendNode(T data, Index rowIndex, Index colIndex, Node*& rowTail, std::vector<Node*> & colTails);
+
+    /**
+     * @struct Accumulator
+     * @brief Scratch space of the row-wise product: partial sums per column, the row that last touched
+     * each column, and the columns touched by the current row.
+     */
+    struct Accumulator {
+        std::vector<T> values;
+        std::vector<Index> lastTouched;
+        std::vector<Index> touched;
+
+        explicit Accumulator(Index numCol) : values(numCol + 1, 0), lastTouched(numCol + 1, 0) {}
+    };
+
+    /**
+     * @class RowWriter
+     * @brief Appends nodes to the row lists of a matrix from a given pool, leaving the column links to
+     * linkColumns(). Lets parallel tasks build disjoint rows of one matrix.
+     */
+    class RowWriter {
+        private:
+        SparseMatrix & matrix;
+        NodePool & pool;
+        Index row;
+        Node* rowTail;
+
+        public:
+        RowWriter(SparseMatrix & matrix, NodePool & pool) : matrix(matrix), pool(pool), row(0), rowTail(nullptr) {}
+
+        /**
+         * @brief Starts appending to row `rowIndex`, which must be empty.
+         */
+        void beginRow(Index rowIndex) {
+            row = rowIndex;
+            rowTail = matrix.rowHeaders[rowIndex];
+        }
+
+        /**
+         * @brief Appends a node at the end of the current row. Columns must come in increasing order.
+         */
+        void append(T data, Index colIndex) {
+            Node* newNode = pool.allocate(data, row, colIndex);
+            newNode->nextCol = matrix.rowHeaders[row];
+            rowTail->nextCol = newNode;
+            rowTail = newNode;
+        }
+    };
+
+    /**
+     * @brief Computes row `i` of `a` + `b` by merging the two sorted row lists.
+     *
+     * @param Emit emit Called as `emit(data, colIndex)` for every non-zero of the row, in column order.
+     */
+    template <typename Emit>
+    static void addRow(const SparseMatrix & a, const SparseMatrix & b, Index i, Emit emit);
+
+    /**
+     * @brief Computes row `i` of `a` * `k` from the stored nodes of the row.
+     *
+     * @param Emit emit Called as `emit(data, colIndex)` for every non-zero of the row, in column order.
+     */
+    template <typename Emit>
+    static void scaleRow(const SparseMatrix & a, T k, Index i, Emit emit);
+
+    /**
+     * @brief Computes row `i` of the product (Gustavson's algorithm): for every non-zero a(i,k), row k of
+     * the right operand is scaled and accumulated into `accumulator`.
+     *
+     * When `TransposeB` is true the right operand is taken as the transpose of `b`: row k of the
+     * operand is column k of `b`, walked through the `nextRow` links, so no transposed copy is built.
+     *
+     * @param Emit emit Called as `emit(data, colIndex)` for every non-zero of the row, in column order.
+     */
+    template <bool TransposeB, typename Emit>
+    static void multiplyRow(const SparseMatrix & a, const SparseMatrix & b, Index i, Accumulator & accumulator, Emit emit);
+
+    /**
+     * @brief Row-wise product shared by the matrixMultiplication and multiplyInto overloads.
+     *
+     * @param const SparseMatrix & a The left operand.
+     * @param const SparseMatrix & b The right operand, or the matrix whose transpose is the right operand.
+     * @param SparseMatrix & c Receives the product, reshaped with reshape(); must not be `a` or `b`.
+     */
+    template <bool TransposeB>
+    static void multiplyRows(const SparseMatrix & a, const SparseMatrix & b, SparseMatrix & c);
+
+    /**
+     * @brief Counts the stored elements of every row, in parallel over even row ranges.
+     *
+     * @return std::vector<std::size_t> The length of row i at index i (index 0 unused).
+     */
+    static std::vector<std::size_t> rowLengths(const SparseMatrix & m, ThreadPool & threads);
+
+    /**
+     * @brief Builds a new matrix whose rows are produced in parallel.
+     *
+     * The rows are split into ranges of about equal total `rowWork` (e.g. non-zeros or multiply-adds), a
+     * few per thread so that work stealing can even out the rest. Each range is built by
+     * `kernel(firstRow, lastRow, writer)` with its own RowWriter and node pool; the pools are then merged
+     * into the result and the column lists are linked in one pass.
+     *
+     * @param const std::vector<std::size_t> & rowWork Estimated cost of every row (index 0 unused).
+     *
+     * @return SparseMatrix The assembled matrix.
+     */
+    template <typename RowKernel>
+    static SparseMatrix buildRowsInParallel(Index numRow, Index numCol, const std::vector<std::size_t> & rowWork,
+                                            ThreadPool & threads, RowKernel kernel);
+
+    /**
+     * @brief Rebuilds every column list from the row lists, in one pass in row order.
+     */
+    void linkColumns();
+
+    /**
+     * @brief Allocates the header node and the row and column placeholders, each list empty and circular.
+     */
+    void initHeaders();
+
+    /**
+     * @brief Empties the matrix and gives it the dimensions `numRow` x `numCol`.
+     *
+     * Every node goes back to the pool at once with NodePool::reset(), so the matrix is rebuilt in the
+     * same slabs, and the header arrays are kept when the dimensions do not change.
+     */
+    void reshape(Index numRow, Index numCol);
+
+    /**
+     * @brief Unlinks and releases every stored node whose value is zero, e.g. after a floating-point
+     * scaling underflowed.
+     */
+    void removeZeros();
+
+    /**
+     * @brief Sorts entries by (row, column) with two stable counting-sort passes, in O(n + rows + cols).
+     *
+     * Entries at the same position stay in input order. The bounds must already have been checked.
+     */
+    static std::vector<Triplet> sortTriplets(Index numRow, Index numCol, const std::vector<Triplet> & triplets);
+
+    /**
+     * @brief Parallel sort-and-build shared by the threaded fromTriplets overloads.
+     *
+     * The rows are cut into a few ranges of equal height per thread. Every part of the input counts its
+     * entries per range, then scatters them into place, so each range holds its entries in input order. The
+     * ranges are then sorted by (row, column) with a stable sort, each on its own, and the rows built with
+     * buildRowsInParallel.
+     *
+     * @param const std::vector<std::pair<const Triplet*, const Triplet*>> & parts The entries, as consecutive
+     *        pieces of the input in order.
+     */
+    static SparseMatrix buildFromTriplets(Index numRow, Index numCol, const std::vector<std::pair<const Triplet*, const Triplet*>> & parts,
+                                          ThreadPool & threads);
+
+    /**
+     * @brief Returns the last node of row `rowIndex` before column `colIndex`, or the row placeholder:
+     * through the index of the row if it has one, otherwise by walking the row list.
+     *
+     * @param std::uint64_t & hops Incremented for every node walked over.
+     */
+    Node* rowPredecessor(Index rowIndex, Index colIndex, std::uint64_t & hops) const;
+
+    /**
+     * @brief Returns the last node of column `colIndex` before row `rowIndex`, or the column placeholder,
+     * like rowPredecessor().
+     */
+    Node* colPredecessor(Index colIndex, Index rowIndex, std::uint64_t & hops) const;
+
+    /**
+     * @brief Builds the index of row `rowIndex` (or column `colIndex`) from its list.
+     */
+    void indexRow(Index rowIndex);
+    void indexCol(Index colIndex);
+
+    /**
+     * @brief Records a node just linked (or updated) in the line index: adds it to the index of its row and
+     * column, or indexes them if the walks to reach it were `minLength` nodes or longer.
+     */
+    void indexAdd(Node* node, std::uint64_t rowHops, std::uint64_t colHops);
+
+    /**
+     * @brief Drops a node just unlinked from the line index, or indexes its row and column if the walks to
+     * reach it were `minLength` nodes or longer.
+     */
+    void indexRemove(Node* node, std::uint64_t rowHops, std::uint64_t colHops);
+
+    friend TransposedView;
+    friend class MatrixExpression<T, Index>;
+    friend class BinaryMatrixFile;
+
+
+    public:
+    /**
+     * @brief Constructs a SparseMatrix object.
+     *
+     * Initializes a sparse matrix of the specified dimension (row x col).
+     *
+     * @param Index numRow The number of rows of the matrix
+     * @param Index numCol The number of columns of the matrix
+     */
+    SparseMatrix(Index numRow = 0, Index numCol = 0) : numRow(numRow), numCol(numCol) {
+        // Allocate memory for row and column headers, and initialize each with a placeholder node
+        rowHeaders = new Node*[numRow + 1];  // +1 to handle 1-based indexing
+        colHeaders = new Node*[numCol + 1];  // +1 to handle 1-based indexing
+        initHeaders();
+    }
+
+    /**
+     * @brief Move constructor for the SparseMatrix class.
+     *
+     * Takes over the header arrays and the node pool of `other` without copying any node, so that
+     * matrices can be returned by value. `other` is left empty and may only be destroyed.
+     *
+     * @param SparseMatrix && other The matrix to move from.
+     */
+    SparseMatrix(SparseMatrix && other) noexcept
+        : header(other.header), numRow(other.numRow), numCol(other.numCol),
+          rowHeaders(other.rowHeaders), colHeaders(other.colHeaders), pool(std::move(other.pool)),
+          index(std::move(other.index)) {
+        other.header = nullptr;
+        other.numRow = 0;
+        other.numCol = 0;
+        other.rowHeaders = nullptr;
+        other.colHeaders = nullptr;
+    }
+
+    /**
+     * @brief Move assignment operator for the SparseMatrix class.
+     *
+     * Frees the nodes and header arrays of this matrix and takes over those of `other`, which is left
+     * empty and may only be destroyed or assigned to.
+     *
+     * @param SparseMatrix && other The matrix to move from.
+     *
+     * @return SparseMatrix & This matrix.
+     */
+    SparseMatrix & operator=(SparseMatrix && other) noexcept {
+        if (this != &other) {
+            delete[] rowHeaders;
+            delete[] colHeaders;
+            header = other.header;
+            numRow = other.numRow;
+            numCol = other.numCol;
+            rowHeaders = other.rowHeaders;
+            colHeaders = other.colHeaders;
+            pool = std::move(other.pool);
+            index = std::move(other.index);
+
+            other.header = nullptr;
+            other.numRow = 0;
+            other.numCol = 0;
+            other.rowHeaders = nullptr;
+            other.colHeaders = nullptr;
+        }
+        return *this;
+    }
+
+    SparseMatrix(const SparseMatrix &) = delete;
+    SparseMatrix & operator=(const SparseMatrix &) = delete;
+
+    /**
+     * @brief Destructor for the SparseMatrix class.
+     *
+     * Every node, including the headers and placeholders, lives in the node pool, so the destructor
+     * only frees the header arrays and lets the pool release its slabs in bulk, without walking the rows.
+     */
+    ~SparseMatrix() {
+        // Free the arrays of row and column headers
+        delete[] rowHeaders;
+        delete[] colHeaders;
+        rowHeaders = nullptr;
+        colHeaders =nullptr;
+        header = nullptr; // Released with the pool
+    }
+
+    /**
+     * @brief Returns the node pool of the matrix, to query allocation counts and memory usage.
+     *
+     * @return const NodePool & The pool that owns the nodes of this matrix.
+     */
+    const NodePool & nodePool() const { return pool; }
+
+    static constexpr std::size_t INDEX_MIN_LENGTH = 64;  ///< Default line length from which buildIndex() indexes a line.
+
+    /**
+     * @brief Turns on the line index, for point-update workloads on long rows or columns.
+     *
+     * Every row and column holding at least `minLength` nodes gets an ordered index (a std::map from the
+     * column or row number to the node), so access, insert and remove find their position on it in
+     * O(log n), and remove finds the predecessor in the column the same way. From then on, insert and
+     * remove also index any line they had to walk `minLength` nodes or more along, and keep the indexed
+     * lines up to date. In-place bulk operations (`+=`, `*=`, multiplyInto) rebuild the index. Each
+     * indexed node costs a map entry in its row and in its column.
+     *
+     * @param std::size_t minLength The line length from which lines are indexed.
+     */
+    void buildIndex(std::size_t minLength = INDEX_MIN_LENGTH);
+
+    /**
+     * @brief Turns off the line index and frees it.
+     */
+    void dropIndex() { index.reset(); }
+
+    /**
+     * @brief Returns true if buildIndex() turned the line index on.
+     */
+    bool hasIndex() const { return index != nullptr; }
+   
+    /**
+     * @brief Displays the sparse matrix.
+     *
+     * In dense mode this function iterates through the entire matrix and prints the elements.
+     * If a node exists for a specific row and column, it prints the node's data.
+     * Otherwise, it prints 0 for elements that are not explicitly stored.
+     * In sparse mode only the stored elements are printed, by walking the row lists. The text is
+     * gathered with a BufferedWriter and written in large blocks.
+     *
+     * @param DisplayMode mode Dense, sparse or nothing; Auto prints densely only up to DENSE_DISPLAY_LIMIT elements.
+     * @param std::ostream & out The stream to print to.
+     */
+    void display(DisplayMode mode = DisplayMode::Auto, std::ostream & out = std::cout) const;
+
+    /**
+     * @brief Returns the row length of the Sparse Matrix.
+     *
+     * This method returns the row length of the matrix. For example,
+     * if the matrix is 10x5, this method will return 10.
+     * The method is marked as 'const', guarantees that the state of the matrix is not altered.
+     * 
+     * @return Index: The row length of the matrix.
+     */
+    Index rowLength() const;
+
+    /**
+     * @brief Returns the column length of the Sparse Matrix.
+     *
+     * This method returns the column length of the matrix. For example,
+     * if the matrix is 10x5, this method will return 5.
+     * The method is marked as 'const', guarantees that the state of the matrix is not altered.
+     *
+     * @return Index: The column length of the matrix.
+     */
+    Index colLength() const;
+
+    /**
+     * @brief Accesses the value at the specified row and column in the sparse matrix.
+     *
+     * This method retrieves the value stored in the matrix at the given row and column.
+     * If no value is stored at that position, it will return 0
+     * The method is marked as 'const', guarantees that the state of the matrix is not altered.
+     *
+     * @param Index rowIndex The row index of the element to access.
+     * @param Index colIndex The column index of the element to access.
+     * 
+     * @return T The value at the specified row and column. Returns 0 if the element is not stored.
+     * 
+     * @throws std::out_of_range if the rowIndex or colIndex is outside the matrix bounds.
+     */
+    T access(Index rowIndex, Index colIndex) const;
+
+    /**
+     * @brief Adds a non-zero element to the matrix.
+     *
+     * Inserts a new non-zero element into the matrix at the specified row and column.
+     * This method uses the circularly-linked list structure to efficiently store the element.
+     * Inserting a zero removes the element at that position, if there is one.
+     *
+     * @param T data The value to be stored in the matrix.
+     * @param Index rowIndex The row index of the element.
+     * @param Index colIndex The column index of the element.
+     * 
+     * @throws std::out_of_range if the rowIndex or colIndex is outside the matrix bounds.
+     */
+    void insert(T data, Index rowIndex, Index colIndex);
+
+    /**
+     * @brief Removes a non-zero element from the sparse matrix at the specified row and column.
+     *
+     * This function removes the element at the given row and column in the sparse matrix.
+     * It throws an exception if the specified element is zero (indicating no non-zero element at that position),
+     * or if the row and column indices are out of bounds for the matrix.
+     *
+     * @param Index rowIndex The row index of the element to remove.
+     * @param Index colIndex The column index of the element to remove.
+     * 
+     * @throws std::out_of_range if the rowIndex or colIndex is outside the matrix bounds.
+     * @throws std::invalid_argument if the element at the specified position is zero (no non-zero element to remove).
+     */
+    void remove(Index rowIndex, Index colIndex);
+
+    /**
+     * @brief Applies a batch of inserts, overwrites and deletes in one sweep.
+     *
+     * Every entry sets the element at its position, as insert would: a non-zero value is inserted or
+     * overwrites the stored one, and a zero value deletes the element. The batch is sorted by (row, column),
+     * so each affected row is walked once for all of its updates, and then each affected column once for
+     * the nodes that were linked or unlinked. When a position appears more than once the last entry wins.
+     *
+     * @param const std::vector<Triplet> & batch The updates, in any order.
+     *
+     * @throws std::out_of_range if an entry is outside the matrix bounds. The matrix is then left unchanged.
+     */
+    void applyUpdates(const std::vector<Triplet> & batch);
+
+    /**
+     * @brief Perform matrix addition of two sparse matrices.
+     * 
+     * This function performs the matrix addition operation on two input sparse matrices, `a` and `b`. 
+     * The function returns a new sparse matrix, `c`, which represents the sum of the input matrices. 
+     * Matrix addition is only valid when the dimensions of both matrices are the same. If the input 
+     * matrices have different dimensions, an exception will be thrown.
+     * 
+     * The parameters are passed as `const` references to avoid unnecessary copying and to ensure 
+     * that the input matrices are not modified by the function, improving both performance and safety.
+     * 
+     * @param const SparseMatrix & a: A const reference to a SparseMatrix object representing the first matrix to be added. 
+     *          Passing by reference avoids copying the matrix, and the const qualifier ensures that 
+     *          the matrix is not modified.
+     * @param const SparseMatrix & b: A const reference to a SparseMatrix object representing the second matrix to be added. 
+     *          Like `a`, this is passed by reference for efficiency and marked const to guarantee 
+     *          the matrix is not altered.
+     * 
+     * The sorted row lists of `a` and `b` are merged directly, so the cost is linear in the number of non-zeros.
+     * 
+     * @return SparseMatrix The resulting sparse matrix `c` after adding matrix `a` and matrix `b`.
+     * 
+     * @throws std::invalid_argument If the dimensions of matrices `a` and `b` do not match.
+     * @throws std::overflow_error If a sum of integers does not fit in T.
+     */
+    static SparseMatrix matrixAddition(const SparseMatrix & a, const SparseMatrix & b);
+
+    /**
+     * @brief Perform matrix multiplication of two sparse matrices.
+     * 
+     * This function performs the matrix multiplication operation on two input sparse matrices, `a` and `b`. 
+     * The function returns a new sparse matrix, `c`, which represents the sum of the input matrices. 
+     * Matrix multiplication is only valid when the number of columns of the first matrix equal to the number of rows
+     * of the second matrix
+     * 
+     * The parameters are passed as `const` references to avoid unnecessary copying and to ensure 
+     * that the input matrices are not modified by the function, improving both performance and safety.
+     * 
+     * @param const SparseMatrix & a: A const reference to a SparseMatrix object representing the first matrix to be added. 
+     *          Passing by reference avoids copying the matrix, and the const qualifier ensures that 
+     *          the matrix is not modified.
+     * @param const SparseMatrix & b: A const reference to a SparseMatrix object representing the second matrix to be added. 
+     *          Like `a`, this is passed by reference for efficiency and marked const to guarantee 
+     *          the matrix is not altered.
+     * 
+     * @return SparseMatrix The resulting sparse matrix `c` after multipliying matrix `a` and matrix `b`.
+     * 
+     * The product is computed row by row (Gustavson's algorithm): for every non-zero a(i,k) the row k of `b` is
+     * scaled and accumulated into a sparse accumulator, so the cost depends on the number of non-zeros and
+     * multiply-adds instead of on the matrix dimensions.
+     * 
+     * @throws std::invalid_argument If the dimensions of matrices `a` and `b` are not valid to perform matrix multiplication.
+     * @throws std::overflow_error If a product or partial sum of integers does not fit in T.
+     */
+    static SparseMatrix matrixMultiplication(const SparseMatrix & a, const SparseMatrix & b);
+
+    /**
+     * @brief Perform matrix multiplication of a sparse matrix and a transposed view.
+     * 
+     * Computes `a` times the transpose of the matrix behind `b` (for example A·Aᵀ) by reading the column
+     * lists of that matrix as the rows of the right operand, without materializing the transpose.
+     * 
+     * @param const SparseMatrix & a: A const reference to the left operand.
+     * @param const TransposedView & b: A view of the right operand.
+     * 
+     * @return SparseMatrix The resulting sparse matrix `c` after multipliying matrix `a` and the view `b`.
+     * 
+     * @throws std::invalid_argument If the dimensions of `a` and `b` are not valid to perform matrix multiplication.
+     */
+    static SparseMatrix matrixMultiplication(const SparseMatrix & a, const TransposedView & b);
+
+    /**
+     * @brief Perform matrix multiplication into an existing matrix.
+     *
+     * Same product as matrixMultiplication, but written into `result`, whose previous contents are
+     * discarded: its node pool is reset and the product is built in the same slabs, and its header arrays
+     * are kept when its dimensions already match. Iterative algorithms that compute a product of the same
+     * shape every step then allocate no nodes after the first one.
+     *
+     * @param const SparseMatrix & a: The left operand.
+     * @param const SparseMatrix & b: The right operand.
+     * @param SparseMatrix & result: Receives `a` * `b`; must be a different matrix from `a` and `b`.
+     *
+     * @throws std::invalid_argument If the dimensions are not valid to perform matrix multiplication, or if
+     *          `result` is one of the operands.
+     * @throws std::overflow_error If a product or partial sum of integers does not fit in T.
+     */
+    static void multiplyInto(const SparseMatrix & a, const SparseMatrix & b, SparseMatrix & result);
+
+    /**
+     * @brief Perform matrix multiplication of a sparse matrix and a transposed view into an existing matrix.
+     *
+     * @param const SparseMatrix & a: The left operand.
+     * @param const TransposedView & b: A view of the right operand.
+     * @param SparseMatrix & result: Receives `a` * `b`; must not be `a` or the matrix behind `b`.
+     *
+     * @throws std::invalid_argument If the dimensions are not valid to perform matrix multiplication, or if
+     *          `result` is one of the operands.
+     */
+    static void multiplyInto(const SparseMatrix & a, const TransposedView & b, SparseMatrix & result);
+
+    /**
+     * @brief Adds `b` to this matrix in place.
+     *
+     * The row lists of `b` are merged into the rows of this matrix: existing nodes are updated, nodes that
+     * cancel out to zero are unlinked and go back to the pool, and new nodes are taken from the pool's free
+     * list first. The cost is linear in the non-zeros of both matrices plus the number of columns.
+     *
+     * @param const SparseMatrix & b: The matrix to add, which may be this matrix.
+     *
+     * @return SparseMatrix & This matrix.
+     *
+     * @throws std::invalid_argument If the dimensions of the matrices do not match.
+     * @throws std::overflow_error If a sum of integers does not fit in T. The matrix is then left valid, with
+     *          the rows before the failing element already added.
+     */
+    SparseMatrix & operator+=(const SparseMatrix & b);
+
+    /**
+     * @brief Multiplies every element of this matrix by `k` in place.
+     *
+     * The stored values are scaled without allocating anything. With `k` equal to 0 the matrix is emptied
+     * and its nodes recycled, as with multiplyInto.
+     *
+     * @param T k: The scalar value to multiply each element of the matrix by.
+     *
+     * @return SparseMatrix & This matrix.
+     *
+     * @throws std::overflow_error If a product of integers does not fit in T. The matrix is then left valid,
+     *          with the elements before the failing one already scaled.
+     */
+    SparseMatrix & operator*=(T k);
+
+    /**
+     * @brief Perform matrix transposition on a sparse matrix.
+     * 
+     * This function performs the transposition operation on the input sparse matrix `a`. 
+     * The function returns a new sparse matrix, `b`, which represents the transposed version of the input matrix.
+     * In matrix transposition, the rows of the matrix are turned into columns and vice versa.
+     * 
+     * The parameter is passed as a `const` reference to avoid unnecessary copying and to ensure 
+     * that the input matrix is not modified by the function, improving both performance and safety.
+     * 
+     * @param const SparseMatrix & a: A const reference to a SparseMatrix object representing the matrix to be transposed. 
+     *          Passing by reference avoids copying the matrix, and the const qualifier ensures that 
+     *          the matrix is not modified.
+     * 
+     * Each column list of `a` is walked in order and becomes the corresponding row of `b`, so the rows of
+     * the result are emitted in order with tail appends and the cost is linear in the number of non-zeros.
+     * 
+     * @return SparseMatrix The resulting sparse matrix `b` after transposing matrix `a`.
+     */
+    static SparseMatrix matrixTransposition(const SparseMatrix & a);
+
+    /**
+     * @brief Returns a zero-copy transposed view of this matrix.
+     *
+     * The view swaps the roles of the row and column lists instead of copying any node, so it is only
+     * valid while this matrix is alive and unchanged.
+     *
+     * @return TransposedView A read-only view of the transpose of this matrix.
+     */
+    TransposedView transposedView() const;
+
+    /**
+     * @brief Perform matrix addition of two matrices in compressed sparse row form.
+     *
+     * Same semantics as the SparseMatrix overload, computed by merging the sorted rows of the arrays.
+     *
+     * @return CSRMatrix The sum of `a` and `b`.
+     *
+     * @throws std::invalid_argument If the dimensions of matrices `a` and `b` do not match.
+     */
+    static CSRMatrix matrixAddition(const CSRMatrix & a, const CSRMatrix & b);
+
+    /**
+     * @brief Perform matrix addition of two matrices in compressed sparse column form.
+     *
+     * @return CSCMatrix The sum of `a` and `b`.
+     *
+     * @throws std::invalid_argument If the dimensions of matrices `a` and `b` do not match.
+     */
+    static CSCMatrix matrixAddition(const CSCMatrix & a, const CSCMatrix & b);
+
+    /**
+     * @brief Perform matrix multiplication of two matrices in compressed sparse row form.
+     *
+     * @return CSRMatrix The product of `a` and `b`.
+     *
+     * @throws std::invalid_argument If the dimensions of matrices `a` and `b` are not valid to perform matrix multiplication.
+     */
+    static CSRMatrix matrixMultiplication(const CSRMatrix & a, const CSRMatrix & b);
+
+    /**
+     * @brief Perform matrix multiplication of two matrices in compressed sparse column form.
+     *
+     * Computed column by column, as the row-wise product of the transposed operands.
+     *
+     * @return CSCMatrix The product of `a` and `b`.
+     *
+     * @throws std::invalid_argument If the dimensions of matrices `a` and `b` are not valid to perform matrix multiplication.
+     */
+    static CSCMatrix matrixMultiplication(const CSCMatrix & a, const CSCMatrix & b);
+
+    /**
+     * @brief Perform matrix transposition on a matrix in compressed sparse row form.
+     *
+     * @return CSRMatrix The transpose of `a`, again in row form.
+     */
+    static CSRMatrix matrixTransposition(const CSRMatrix & a);
+
+    /**
+     * @brief Perform matrix transposition on a matrix in compressed sparse column form.
+     *
+     * @return CSCMatrix The transpose of `a`, again in column form.
+     */
+    static CSCMatrix matrixTransposition(const CSCMatrix & a);
+
+    /**
+     * @brief Perform scalar multiplication on a matrix in compressed sparse row form.
+     *
+     * @return CSRMatrix The matrix `a` with every element multiplied by `k`.
+     */
+    static CSRMatrix matrixScalarMultiplication(const CSRMatrix & a, T k);
+
+    /**
+     * @brief Perform scalar multiplication on a matrix in compressed sparse column form.
+     *
+     * @return CSCMatrix The matrix `a` with every element multiplied by `k`.
+     */
+    static CSCMatrix matrixScalarMultiplication(const CSCMatrix & a, T k);
+
+    /**
+     * @brief Builds a matrix from a batch of (row, column, value) entries in one pass.
+     *
+     * The entries are radix-sorted by (row, column) with two stable counting-sort passes, then every node is
+     * linked at the tail of its row and column lists, so the cost is O(nnz + rows + cols) whatever the input
+     * order. The result is the same as inserting the entries one by one: when a position appears more than
+     * once the last entry wins, and a zero value leaves its position empty.
+     *
+     * @param Index numRow The number of rows of the matrix
+     * @param Index numCol The number of columns of the matrix
+     * @param const std::vector<Triplet> & triplets The entries, in any order.
+     *
+     * @return SparseMatrix The matrix holding the entries.
+     *
+     * @throws std::out_of_range if an entry is outside the matrix bounds.
+     */
+    static SparseMatrix fromTriplets(Index numRow, Index numCol, const std::vector<Triplet> & triplets);
+
+    /**
+     * @brief Builds a matrix from a batch of entries as fromTriplets does, sorting and building it on the
+     * threads of `threads`.
+     *
+     * @throws std::out_of_range if an entry is outside the matrix bounds.
+     */
+    static SparseMatrix fromTriplets(Index numRow, Index numCol, const std::vector<Triplet> & triplets, ThreadPool & threads);
+
+    /**
+     * @brief Builds a matrix from the entries of several buffers, taken in order as if they were one batch, on
+     * the threads of `threads`. The buffers are merged by the sort, never concatenated, e.g. the per-chunk
+     * buffers of the parallel MatrixFileParser::readSection.
+     *
+     * @throws std::out_of_range if an entry is outside the matrix bounds.
+     */
+    static SparseMatrix fromTriplets(Index numRow, Index numCol, const std::vector<std::vector<Triplet>> & buffers, ThreadPool & threads);
+
+    /**
+     * @brief Converts the matrix to compressed sparse row form.
+     *
+     * Walks every row list once, so the cost is linear in rows plus non-zeros.
+     *
+     * @return CSRMatrix The same matrix in compressed sparse row form.
+     */
+    CSRMatrix toCSR() const;
+
+    /**
+     * @brief Converts the matrix to compressed sparse column form.
+     *
+     * Walks every column list once, so the cost is linear in columns plus non-zeros.
+     *
+     * @return CSCMatrix The same matrix in compressed sparse column form.
+     */
+    CSCMatrix toCSC() const;
+
+    /**
+     * @brief Builds a linked SparseMatrix from compressed sparse row form.
+     *
+     * @param const CSRMatrix & csr The matrix to convert.
+     *
+     * @return SparseMatrix The same matrix as circularly-linked lists, ready for insert/remove.
+     */
+    static SparseMatrix fromCSR(const CSRMatrix & csr);
+
+    /**
+     * @brief Builds a linked SparseMatrix from compressed sparse column form.
+     *
+     * @param const CSCMatrix & csc The matrix to convert.
+     *
+     * @return SparseMatrix The same matrix as circularly-linked lists, ready for insert/remove.
+     */
+    static SparseMatrix fromCSC(const CSCMatrix & csc);
+
+    /**
+     * @brief Returns the name of the file that exportToCSV writes for `filePath`.
+     *
+     * "_output" is appended before the file extension, or at the end if there is none.
+     *
+     * @param const std::string & filePath: Path and name of the input file.
+     *
+     * @return std::string The path of the output file.
+     */
+    static std::string outputFilePath(const std::string & filePath);
+
+    /**
+     * @brief Multiplies the matrix by a dense vector (SpMV): y = A·x.
+     *
+     * Walks every row list once. Vectors are 0-based: `x[j - 1]` pairs with column j and `y[i - 1]` is
+     * the result for row i.
+     *
+     * @param const std::vector<T> & x The vector, of size colLength().
+     *
+     * @return std::vector<T> The product, of size rowLength().
+     *
+     * @throws std::invalid_argument if the size of `x` does not match.
+     * @throws std::overflow_error if an integer product or partial sum does not fit in T.
+     */
+    std::vector<T> multiplyVector(const std::vector<T> & x) const;
+
+    /**
+     * @brief Multiplies the matrix by a dense vector on the threads of `threads`, each range of rows
+     * writing its own part of the result.
+     */
+    std::vector<T> multiplyVector(const std::vector<T> & x, ThreadPool & threads) const;
+
+    /**
+     * @brief Multiplies the transpose of the matrix by a dense vector: y = Aᵀ·x.
+     *
+     * Walks every column list once, so each result is gathered without building the transpose.
+     *
+     * @param const std::vector<T> & x The vector, of size rowLength().
+     *
+     * @return std::vector<T> The product, of size colLength().
+     *
+     * @throws std::invalid_argument if the size of `x` does not match.
+     * @throws std::overflow_error if an integer product or partial sum does not fit in T.
+     */
+    std::vector<T> multiplyVectorTransposed(const std::vector<T> & x) const;
+
+    /**
+     * @brief Multiplies the transpose of the matrix by a dense vector on the threads of `threads`, each
+     * range of columns writing its own part of the result.
+     */
+    std::vector<T> multiplyVectorTransposed(const std::vector<T> & x, ThreadPool & threads) const;
+
+    /**
+     * @brief Perform scalar multiplication on a sparse matrix.
+     * 
+     * This function performs scalar multiplication on the input sparse matrix `a` by multiplying each element 
+     * of the matrix by the scalar `k`. The function returns a new sparse matrix, `b`, which contains the 
+     * scaled elements of the original matrix.
+     * 
+     * The matrix `a` is passed as a `const` reference to avoid unnecessary copying and ensure that the 
+     * input matrix is not modified, improving both performance and safety. The scalar `k` is passed by value 
+     * since it is a simple data type.
+     * 
+     * @param const SparseMatrix & a: A const reference to a SparseMatrix object representing the matrix to be multiplied by the scalar.
+     *          Passing by reference avoids copying the matrix, and the const qualifier ensures that the matrix is not modified.
+     * @param T k: The scalar value to multiply each element of the matrix by.
+     * 
+     * Only the stored nodes of `a` are visited, so the cost is linear in the number of non-zeros.
+     * 
+     * @return SparseMatrix The resulting sparse matrix `b` after multiplying each element of matrix `a` by scalar `k`.
+     *
+     * @throws std::overflow_error If a product of integers does not fit in T.
+     */
+    static SparseMatrix matrixScalarMultiplication(const SparseMatrix & a, T k);
+
+    /**
+     * @brief Perform matrix addition on the threads of `threads`.
+     *
+     * Rows are split into ranges balanced by their number of non-zeros and every range builds its own
+     * result rows. Same result and exceptions as the single-threaded overload.
+     */
+    static SparseMatrix matrixAddition(const SparseMatrix & a, const SparseMatrix & b, ThreadPool & threads);
+
+    /**
+     * @brief Perform matrix multiplication on the threads of `threads`.
+     *
+     * Rows are split into ranges balanced by their number of multiply-adds and every range builds its own
+     * result rows with its own sparse accumulator. Same result and exceptions as the single-threaded overload.
+     */
+    static SparseMatrix matrixMultiplication(const SparseMatrix & a, const SparseMatrix & b, ThreadPool & threads);
+
+    /**
+     * @brief Perform scalar multiplication on the threads of `threads`.
+     *
+     * Rows are split into ranges balanced by their number of non-zeros. Same result as the
+     * single-threaded overload.
+     */
+    static SparseMatrix matrixScalarMultiplication(const SparseMatrix & a, T k, ThreadPool & threads);
+
+    /**
+     * @brief Export non-zero elements of the sparse matrix to a CSV file.
+     * 
+     * This function exports the non-zero elements of the sparse matrix to a CSV file. The output filename 
+     * is based on `filePath`, with "_output" appended before the file extension (or added if none exists).
+     * 
+     * Each line in the CSV contains the row index, column index, and value of a non-zero element. The file 
+     * is opened in truncation mode to overwrite any existing content.
+     * 
+     * @param const std::string & filePath: Path and name of the output file. The filename is modified to 
+     *          include "_output".
+     * @param std::ostream & out: Stream the confirmation message is printed to.
+     */
+    void exportToCSV(const std::string & filePath, std::ostream & out = std::cout);
+
+    /**
+     * @brief Export the matrix to a file in the binary format of BinaryMatrixFile.
+     *
+     * The row pointers, column indices and values are streamed straight from the row lists in three
+     * passes, so no compressed copy of the matrix is built in memory. Unlike exportToCSV, the file is
+     * written at exactly `outputPath`.
+     *
+     * @param const std::string & outputPath: Path and name of the output file.
+     *
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void exportToBinary(const std::string & outputPath) const;
+
+    /**
+     * @brief Reads a matrix from a Matrix Market (.mtx) coordinate file.
+     *
+     * Supports the `integer`, `real` and `pattern` fields with `general`, `symmetric` and `skew-symmetric`
+     * symmetry. The file is memory-mapped and read in a single pass into a buffer of all its entries (twice
+     * as many for the symmetric forms), which is then built with fromTriplets; the buffer is pre-sized from the
+     * entry count of the size line, capped by what the file and the matrix can hold. For an integer T, real
+     * values must be whole numbers.
+     *
+     * @param const std::string & filePath Path of the .mtx file.
+     *
+     * @return SparseMatrix The matrix described by the file.
+     *
+     * @throws std::runtime_error if the file cannot be opened or is not a supported Matrix Market file, or a
+     *         skew-symmetric file has a diagonal entry.
+     * @throws std::out_of_range if an entry is outside the matrix bounds.
+     * @throws std::overflow_error if the mirror of a skew-symmetric integer entry does not fit in T.
+     */
+    static SparseMatrix importMatrixMarket(const std::string & filePath);
+
+    /**
+     * @brief Export the matrix to a Matrix Market (.mtx) coordinate file, with the `integer` field for
+     * integer T and the `real` field otherwise.
+     *
+     * Entries are streamed from the row lists in row order. With `symmetric`, only the lower triangle is
+     * written and the file is marked `symmetric`; the matrix is first checked to be symmetric by comparing
+     * every row list with the matching column list.
+     *
+     * @param const std::string & outputPath Path and name of the output file.
+     * @param bool symmetric true to write the symmetric form.
+     *
+     * @throws std::invalid_argument if `symmetric` is requested for a matrix that is not symmetric.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void exportToMatrixMarket(const std::string & outputPath, bool symmetric = false) const;
+
+};
+
+/**
+ * @class TransposedView
+ * @brief Read-only, zero-copy view of the transpose of a SparseMatrix.
+ *
+ * Row i of the view is column i of the underlying matrix. Since every node is linked into both its row
+ * list and its column list, the view walks the `nextRow` links where the matrix would walk `nextCol`,
+ * and nothing is materialized until `materialize()` is called.
+ */
+template <typename T, typename Index>
+class TransposedView {
+    public:
+    using SparseMatrix = ::SparseMatrix<T, Index>;
+    using Node = ::Node<T, Index>;
+
+    private:
+    const SparseMatrix & matrix; ///< The matrix being viewed, must outlive the view.
+
+    public:
+    /**
+     * @brief Constructs a view of the transpose of `matrix`.
+     *
+     * @param const SparseMatrix & matrix The matrix to view.
+     */
+    explicit TransposedView(const SparseMatrix & matrix) : matrix(matrix) {}
+
+    /**
+     * @brief Returns the underlying (non-transposed) matrix.
+     *
+     * @return const SparseMatrix & The matrix behind this view.
+     */
+    const SparseMatrix & base() const { return matrix; }
+
+    /**
+     * @brief Returns the row length of the view, which is the column length of the matrix.
+     *
+     * @return Index: The row length of the view.
+     */
+    Index rowLength() const;
+
+    /**
+     * @brief Returns the column length of the view, which is the row length of the matrix.
+     *
+     * @return Index: The column length of the view.
+     */
+    Index colLength() const;
+
+    /**
+     * @brief Accesses the value at the specified row and column of the view.
+     *
+     * Walks the column list `rowIndex` of the underlying matrix.
+     *
+     * @param Index rowIndex The row index in the view.
+     * @param Index colIndex The column index in the view.
+     * 
+     * @return T The value at the specified position. Returns 0 if the element is not stored.
+     * 
+     * @throws std::out_of_range if the rowIndex or colIndex is outside the view bounds.
+     */
+    T access(Index rowIndex, Index colIndex) const;
+
+    /**
+     * @brief Displays the transposed matrix, in the same modes as SparseMatrix::display.
+     */
+    void display(DisplayMode mode = DisplayMode::Auto, std::ostream & out = std::cout) const;
+
+    /**
+     * @brief Builds a standalone SparseMatrix holding the transpose.
+     *
+     * @return SparseMatrix The same result as SparseMatrix::matrixTransposition.
+     */
+    SparseMatrix materialize() const;
+};
+
+/**
+ * @class MatrixExpression
+ * @brief Lazy chain of matrix operations, evaluated row by row in one pass without intermediate matrices.
+ *
+ * An expression is built from SparseMatrix operands with `+`, `-`, `*` (by a matrix or a scalar) and
+ * transposed(), and nothing is computed until evaluate(). Transposes are pushed down to the operands as the
+ * expression is built, (A*B)ᵀ becoming Bᵀ*Aᵀ and (A+B)ᵀ becoming Aᵀ+Bᵀ, where they read the column lists as
+ * rows like TransposedView does. Each row of the result is then computed by one fused kernel over the whole
+ * tree: sums merge the rows of their terms, scalars scale them on the way through, and products accumulate
+ * the rows of their right factor as in matrixMultiplication. Only one row of every subexpression is held at
+ * a time, so `k*A + B`, `(A*B)ᵀ` or `A + Bᵀ` allocate nothing but the nodes of the result. The one exception
+ * is a right factor that is not an operand, as in `A*(B*C)` or `A*(B+C)`: its rows are read once per non-zero
+ * of a column of the left factor, so it is evaluated once into a matrix before the pass.
+ *
+ * An expression only refers to its operands, which must outlive it. Dimensions are checked as it is built.
+ */
+template <typename T, typename Index>
+class MatrixExpression {
+    public:
+    using SparseMatrix = ::SparseMatrix<T, Index>;
+    using Node = ::Node<T, Index>;
+    using Entry = std::pair<Index, T>;  ///< Column and value of one element of a row.
+
+    private:
+    /**
+     * @struct Term
+     * @brief One node of the expression tree. Terms are immutable and shared by the expressions built on them.
+     */
+    struct Term {
+        enum Kind { OPERAND, SCALE, SUM, PRODUCT };
+        Kind kind;
+        Index numRow;                          ///< Rows of the value of the term.
+        Index numCol;                          ///< Columns of the value of the term.
+        std::size_t size;                      ///< Number of terms in the subtree, this one included.
+        const SparseMatrix* matrix;            ///< The matrix of an OPERAND.
+        bool transposed;                       ///< Whether an OPERAND is read through its column lists.
+        T scalar;                              ///< The factor of a SCALE.
+        std::shared_ptr<const Term> left;      ///< The scaled term, or the left term of a SUM or PRODUCT.
+        std::shared_ptr<const Term> right;     ///< The right term of a SUM or PRODUCT.
+    };
+
+    /**
+     * @struct Workspace
+     * @brief Scratch space of one evaluating thread: two row buffers per term, numbered in depth-first
+     * order, and the accumulator of every PRODUCT.
+     */
+    struct Workspace {
+        /**
+         * @brief Partial sums per column, stamped with the call that last touched them, so that a product
+         * can be asked for the same row twice in a row.
+         */
+        struct Accumulator {
+            std::vector<T> values;
+            std::vector<std::size_t> stamps;
+            std::vector<Index> touched;
+            std::size_t stamp = 0;
+        };
+        std::vector<std::vector<Entry>> leftRows;
+        std::vector<std::vector<Entry>> rightRows;
+        std::vector<Accumulator> accumulators;
+
+        explicit Workspace(std::size_t terms) : leftRows(terms), rightRows(terms), accumulators(terms) {}
+    };
+
+    std::shared_ptr<const Term> root;
+
+    MatrixExpression() {}  // Null expression, only for the parser
+
+    explicit MatrixExpression(std::shared_ptr<const Term> root) : root(std::move(root)) {}
+
+    static std::shared_ptr<const Term> makeTerm(typename Term::Kind kind, Index numRow, Index numCol, T scalar,
+                                                std::shared_ptr<const Term> left, std::shared_ptr<const Term> right);
+    static std::shared_ptr<const Term> transpose(const std::shared_ptr<const Term> & term);
+    static MatrixExpression sum(const MatrixExpression & a, const MatrixExpression & b);
+    static MatrixExpression product(const MatrixExpression & a, const MatrixExpression & b);
+    static MatrixExpression scale(const MatrixExpression & a, T k);
+
+    /**
+     * @brief Returns `term` with the right factor of every PRODUCT that is not an operand replaced by an
+     * operand holding its value, evaluated once into `factors`. The kernel reads row k of the right factor
+     * once per non-zero in column k of the left one, so a compound factor would otherwise be recomputed
+     * that many times, and again at every level of nesting.
+     *
+     * @param ThreadPool * threads Evaluates the factors on the pool, or nullptr.
+     */
+    static std::shared_ptr<const Term> materializeFactors(const std::shared_ptr<const Term> & term, std::deque<SparseMatrix> & factors,
+                                                          ThreadPool * threads);
+
+    /**
+     * @brief The fused kernel: computes row `i` of `term` into `out`, sorted by column and without zeros.
+     *
+     * @param std::size_t slot The depth-first number of `term`, which picks its buffers in `workspace`.
+     */
+    static void row(const Term & term, std::size_t slot, Index i, Workspace & workspace, std::vector<Entry> & out);
+
+    struct ParsedValue;  // A scalar or an expression, while parsing
+    static ParsedValue parseSum(const char*& p, const char* end, const std::vector<const SparseMatrix*> & operands);
+    static ParsedValue parseProduct(const char*& p, const char* end, const std::vector<const SparseMatrix*> & operands);
+    static ParsedValue parseFactor(const char*& p, const char* end, const std::vector<const SparseMatrix*> & operands);
+
+    public:
+    /**
+     * @brief Wraps a matrix as the leaf of an expression.
+     */
+    explicit MatrixExpression(const SparseMatrix & matrix);
+
+    Index rowLength() const { return root->numRow; }  ///< The number of rows of the value.
+    Index colLength() const { return root->numCol; }  ///< The number of columns of the value.
+
+    /**
+     * @brief Returns the transpose of the expression.
+     */
+    MatrixExpression transposed() const { return MatrixExpression(transpose(root)); }
+
+    /**
+     * @brief Builds the sum, difference or product of two expressions, or the product with a scalar.
+     *
+     * @throws std::invalid_argument If the dimensions do not match.
+     */
+    friend MatrixExpression operator+(const MatrixExpression & a, const MatrixExpression & b) { return sum(a, b); }
+    friend MatrixExpression operator-(const MatrixExpression & a, const MatrixExpression & b) { return sum(a, scale(b, T(-1))); }
+    friend MatrixExpression operator*(const MatrixExpression & a, const MatrixExpression & b) { return product(a, b); }
+    friend MatrixExpression operator*(T k, const MatrixExpression & a) { return scale(a, k); }
+    friend MatrixExpression operator*(const MatrixExpression & a, T k) { return scale(a, k); }
+
+    /**
+     * @brief Computes the value of the expression, one fused pass per row.
+     *
+     * @return SparseMatrix The result.
+     *
+     * @throws std::overflow_error If an integer sum or product does not fit in T.
+     */
+    SparseMatrix evaluate() const;
+
+    /**
+     * @brief Computes the value of the expression, with the rows spread over a thread pool as in
+     * SparseMatrix::buildRowsInParallel. Every range of rows gets its own workspace.
+     */
+    SparseMatrix evaluate(ThreadPool & threads) const;
+
+    /**
+     * @brief Computes the rows of the value in order, handing each one to `consume(i, entries)` as soon as it
+     * is done, e.g. to stream it to a file, and building the value only if `result` is given.
+     *
+     * @param Consume consume Called with the row number and its entries, sorted by column and without zeros;
+     *        the entries are overwritten by the next row.
+     * @param SparseMatrix * result An empty matrix of the shape of the value, which receives the rows too, or
+     *        nullptr.
+     *
+     * @throws std::invalid_argument If `result` does not have the shape of the value.
+     */
+    template <typename Consume>
+    void evaluateRows(Consume consume, SparseMatrix * result = nullptr) const;
+
+    /**
+     * @brief Parses an expression such as `2*A + B'` or `(A*B)^T - C`.
+     *
+     * Operands are the letters `A` to `Z`, standing for `operands[0]`, `operands[1]` and so on. The grammar
+     * has `+` and `-`, then `*` between matrices or with a number, unary `-`, parentheses, and the postfix
+     * transposes `'`, `^T` and `ᵀ`; spaces are ignored.
+     *
+     * @throws std::invalid_argument If the text is not a valid expression, names a missing operand, does not
+     *          denote a matrix, or has mismatched dimensions.
+     */
+    static MatrixExpression parse(const std::string & text, const std::vector<const SparseMatrix*> & operands);
+};
+
+/**
+ * @struct CompressedStorage
+ * @brief Compressed sparse arrays shared by the CSR and CSC representations.
+ *
+ * The non-zeros are grouped by their "major" index (rows for CSR, columns for CSC). The entries of
+ * major line m (1-based) occupy positions `majorPtr[m - 1]` up to `majorPtr[m] - 1` of `minorIndex`
+ * and `values`, sorted by their 1-based minor index. Compared to one heap-allocated Node per element,
+ * an entry costs one index and one value stored contiguously.
+ *
+ * The kernels are written in terms of major and minor lines, so each of them serves both forms.
+ */
+template <typename T, typename Index>
+struct CompressedStorage {
+    Index numMajor; ///< Number of major lines (rows for CSR, columns for CSC).
+    Index numMinor; ///< Length of a major line (columns for CSR, rows for CSC).
+    std::vector<std::size_t> majorPtr; ///< Start offset of every major line, plus the end offset.
+    std::vector<Index> minorIndex; ///< Minor index of every entry.
+    std::vector<T> values; ///< Value of every entry.
+
+    /**
+     * @brief Constructs empty storage of the given shape.
+     *
+     * @param Index numMajor The number of major lines.
+     * @param Index numMinor The length of a major line.
+     */
+    CompressedStorage(Index numMajor = 0, Index numMinor = 0)
+        : numMajor(numMajor), numMinor(numMinor), majorPtr(numMajor + 1, 0) {}
+
+    /**
+     * @brief Returns the number of stored non-zero entries.
+     *
+     * @return std::size_t The number of entries.
+     */
+    std::size_t nonZeros() const { return values.size(); }
+
+    /**
+     * @brief Returns the number of bytes held by the arrays.
+     *
+     * @return std::size_t The memory used by the storage.
+     */
+    std::size_t memoryUsage() const;
+
+    /**
+     * @brief Looks up one entry by binary search within its major line.
+     *
+     * @param Index major The 1-based major index.
+     * @param Index minor The 1-based minor index.
+     *
+     * @return T The stored value, or 0 if the entry is not stored.
+     */
+    T find(Index major, Index minor) const;
+
+    /**
+     * @brief Adds two storages of the same shape by merging their major lines.
+     *
+     * @throws std::invalid_argument If the shapes do not match.
+     * @throws std::overflow_error If a sum of integers does not fit in T.
+     */
+    static CompressedStorage add(const CompressedStorage & a, const CompressedStorage & b);
+
+    /**
+     * @brief Multiplies every entry by `k` in one pass over the arrays.
+     */
+    static CompressedStorage scale(const CompressedStorage & a, T k);
+
+    /**
+     * @brief Row-wise (Gustavson) product: major line i of the result is the sum, over the entries
+     * (i, k) of `x`, of x(i, k) times major line k of `y`.
+     *
+     * With CSR operands this is x·y. With CSC operands, passing them in swapped order gives the CSC of
+     * the product.
+     *
+     * @throws std::invalid_argument If the minor length of `x` differs from the major count of `y`.
+     * @throws std::overflow_error If a product or partial sum of integers does not fit in T.
+     */
+    static CompressedStorage multiply(const CompressedStorage & x, const CompressedStorage & y);
+
+    /**
+     * @brief Regroups the entries by minor index with a counting sort, in O(nnz + lines).
+     *
+     * The result holds the same matrix in the other form (CSR to CSC and back), or equally the
+     * transposed matrix in the same form.
+     */
+    static CompressedStorage transpose(const CompressedStorage & a);
+
+    /**
+     * @brief Computes y[m - 1] = sum of the entries of major line m times x[minor - 1], for the lines
+     * firstMajor up to lastMajor - 1.
+     *
+     * For int32 values with 32-bit indices, dispatches once, on first use, to the widest kernel the CPU
+     * supports: AVX-512 or AVX2 gathers of `x`, or the scalar loop. Other types always use the scalar loop.
+     * Integer sums and products are checked as in the matrix operations; the SIMD kernels compute in 64 bits
+     * and redo a line with the scalar loop whenever it might overflow, so every kernel throws on the same lines.
+     *
+     * @throws std::overflow_error if an integer product or partial sum does not fit in T.
+     */
+    static void multiplyVectorLines(const CompressedStorage & a, const T* x, T* y, std::size_t firstMajor, std::size_t lastMajor);
+
+    /**
+     * @brief Returns the name of the kernel multiplyVectorLines runs on this CPU ("avx512", "avx2" or "scalar").
+     */
+    static const char* vectorKernelName();
+
+    /**
+     * @brief Adds, for the lines firstMajor up to lastMajor - 1, every entry times x[major - 1] to
+     * y[minor - 1]. This is the product by the matrix the other way round (scatter form).
+     *
+     * @throws std::overflow_error if an integer product or partial sum does not fit in T.
+     */
+    static void scatterVectorLines(const CompressedStorage & a, const T* x, T* y, std::size_t firstMajor, std::size_t lastMajor);
+};
+
+/**
+ * @class CSRMatrix
+ * @brief A matrix in compressed sparse row form.
+ *
+ * Read-mostly counterpart of SparseMatrix: cheap to traverse and to run bulk arithmetic on, but
+ * elements cannot be inserted or removed in place. Convert with SparseMatrix::toCSR and
+ * SparseMatrix::fromCSR.
+ */
+template <typename T, typename Index>
+class CSRMatrix {
+    public:
+    using CompressedStorage = ::CompressedStorage<T, Index>;
+    using CSCMatrix = ::CSCMatrix<T, Index>;
+
+    CompressedStorage storage; ///< The arrays, with rows as the major dimension.
+
+    /**
+     * @brief Constructs an empty matrix of the specified dimension (row x col).
+     *
+     * @param Index numRow The number of rows of the matrix
+     * @param Index numCol The number of columns of the matrix
+     */
+    CSRMatrix(Index numRow = 0, Index numCol = 0) : storage(numRow, numCol) {}
+
+    /**
+     * @brief Wraps existing storage whose major dimension is the rows.
+     *
+     * @param CompressedStorage storage The arrays to take over.
+     */
+    explicit CSRMatrix(CompressedStorage storage) : storage(std::move(storage)) {}
+
+    Index rowLength() const { return storage.numMajor; }  ///< The number of rows.
+    Index colLength() const { return storage.numMinor; }  ///< The number of columns.
+    std::size_t nonZeros() const { return storage.nonZeros(); }  ///< The number of stored elements.
+
+    /**
+     * @brief Accesses the value at the specified row and column.
+     *
+     * @return T The value at the specified row and column. Returns 0 if the element is not stored.
+     *
+     * @throws std::out_of_range if the rowIndex or colIndex is outside the matrix bounds.
+     */
+    T access(Index rowIndex, Index colIndex) const;
+
+    /**
+     * @brief Converts to compressed sparse column form.
+     *
+     * @return CSCMatrix The same matrix in column form.
+     */
+    CSCMatrix toCSC() const;
+
+    /**
+     * @brief Export the non-zero elements to a CSV file, in the same format as SparseMatrix::exportToCSV.
+     *
+     * @param const std::string & filePath: Path and name of the input file. The filename is modified to
+     *          include "_output".
+     * @param std::ostream & out: Stream the confirmation message is printed to.
+     */
+    void exportToCSV(const std::string & filePath, std::ostream & out = std::cout) const;
+
+    /**
+     * @brief Export the matrix to a file in the binary format of BinaryMatrixFile.
+     *
+     * @param const std::string & outputPath: Path and name of the output file.
+     *
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void exportToBinary(const std::string & outputPath) const;
+
+    /**
+     * @brief Multiplies the matrix by a dense vector (SpMV): y = A·x, with the SIMD kernel of
+     * CompressedStorage::multiplyVectorLines. Vectors are 0-based as in SparseMatrix::multiplyVector.
+     *
+     * @throws std::invalid_argument if the size of `x` does not match.
+     * @throws std::overflow_error if an integer product or partial sum does not fit in T.
+     */
+    std::vector<T> multiplyVector(const std::vector<T> & x) const;
+
+    /**
+     * @brief Multiplies the matrix by a dense vector on the threads of `threads`, with the rows split into
+     * ranges of about equal non-zeros.
+     */
+    std::vector<T> multiplyVector(const std::vector<T> & x, ThreadPool & threads) const;
+
+    /**
+     * @brief Multiplies the transpose of the matrix by a dense vector: y = Aᵀ·x, by scattering every row.
+     *
+     * @throws std::invalid_argument if the size of `x` does not match.
+     * @throws std::overflow_error if an integer product or partial sum does not fit in T.
+     */
+    std::vector<T> multiplyVectorTransposed(const std::vector<T> & x) const;
+
+    /**
+     * @brief Multiplies the transpose of the matrix by a dense vector on the threads of `threads`. Every
+     * range of rows scatters into its own partial result, and the partial results are then summed.
+     */
+    std::vector<T> multiplyVectorTransposed(const std::vector<T> & x, ThreadPool & threads) const;
+};
+
+/**
+ * @class CSCMatrix
+ * @brief A matrix in compressed sparse column form.
+ *
+ * Convert with SparseMatrix::toCSC and SparseMatrix::fromCSC.
+ */
+template <typename T, typename Index>
+class CSCMatrix {
+    public:
+    using CompressedStorage = ::CompressedStorage<T, Index>;
+    using CSRMatrix = ::CSRMatrix<T, Index>;
+
+    CompressedStorage storage; ///< The arrays, with columns as the major dimension.
+
+    /**
+     * @brief Constructs an empty matrix of the specified dimension (row x col).
+     *
+     * @param Index numRow The number of rows of the matrix
+     * @param Index numCol The number of columns of the matrix
+     */
+    CSCMatrix(Index numRow = 0, Index numCol = 0) : storage(numCol, numRow) {}
+
+    /**
+     * @brief Wraps existing storage whose major dimension is the columns.
+     *
+     * @param CompressedStorage storage The arrays to take over.
+     */
+    explicit CSCMatrix(CompressedStorage storage) : storage(std::move(storage)) {}
+
+    Index rowLength() const { return storage.numMinor; }  ///< The number of rows.
+    Index colLength() const { return storage.numMajor; }  ///< The number of columns.
+    std::size_t nonZeros() const { return storage.nonZeros(); }  ///< The number of stored elements.
+
+    /**
+     * @brief Accesses the value at the specified row and column.
+     *
+     * @return T The value at the specified row and column. Returns 0 if the element is not stored.
+     *
+     * @throws std::out_of_range if the rowIndex or colIndex is outside the matrix bounds.
+     */
+    T access(Index rowIndex, Index colIndex) const;
+
+    /**
+     * @brief Converts to compressed sparse row form.
+     *
+     * @return CSRMatrix The same matrix in row form.
+     */
+    CSRMatrix toCSR() const;
+};
+
+/**
+ * @class HypersparseMatrix
+ * @brief Doubly-compressed variant of SparseMatrix for huge dimensions with few non-empty rows and columns.
+ *
+ * SparseMatrix allocates a placeholder node for every row and column up front, which rules out matrices such
+ * as the adjacency matrix of a graph with 10^9 vertices. Here the placeholders only exist for the rows and
+ * columns that hold at least one element, and are found through two sorted directories (row or column number
+ * to placeholder); a line whose last element is removed loses its placeholder again. Memory is then linear in
+ * the number of non-zeros, whatever the dimensions, for one O(log n) directory lookup per access, insert or
+ * remove. The rows and columns themselves are the same circular lists of Node as in SparseMatrix.
+ *
+ * Indices are 64-bit by default. The matrix supports the operations of the CSV jobs, with the same ThreadPool
+ * overloads; there is no binary form, since the `.smb` format stores 32-bit column indices.
+ */
+template <typename T = std::int32_t, typename Index = std::uint64_t>
+class HypersparseMatrix {
+    static_assert(std::is_unsigned<Index>::value, "Index must be an unsigned integer type");
+
+    public:
+    using Node = ::Node<T, Index>;
+    using Triplet = ::Triplet<T, Index>;
+    using NodePool = ::NodePool<T, Index>;
+    using Directory = std::map<Index, Node*>;  ///< Line number to placeholder, for the non-empty lines only.
+
+    private:
+    Index numRow;          // Number of rows in the matrix
+    Index numCol;          // Number of columns in the matrix
+    Directory rowHeaders;  // Placeholders of the non-empty rows
+    Directory colHeaders;  // Placeholders of the non-empty columns
+    NodePool pool;         // Owns every node of the matrix, including the placeholders
+
+    /**
+     * @class RowWriter
+     * @brief Appends rows in increasing order to a pool, creating the placeholder of a row with its first
+     * element, so that rows which end up empty cost nothing. The rows are handed to the matrix with addRows().
+     */
+    class RowWriter {
+        private:
+        NodePool & pool;
+        Index row;
+        Node* rowTail;
+
+        public:
+        std::vector<std::pair<Index, Node*>> headers;  ///< The placeholders of the rows written, in order.
+
+        explicit RowWriter(NodePool & pool) : pool(pool), row(0), rowTail(nullptr) {}
+
+        /**
+         * @brief Starts appending to row `rowIndex`, which must come after the rows already written.
+         */
+        void beginRow(Index rowIndex) {
+            row = rowIndex;
+            rowTail = nullptr;
+        }
+
+        /**
+         * @brief Appends a node at the end of the current row. Columns must come in increasing order.
+         */
+        void append(T data, Index colIndex) {
+            if (rowTail == nullptr) { // First element of the row
+                rowTail = pool.allocate(0, row, 0);
+                rowTail->nextCol = rowTail;
+                headers.push_back(std::make_pair(row, rowTail));
+            }
+            Node* newNode = pool.allocate(data, row, colIndex);
+            newNode->nextCol = headers.back().second;
+            rowTail->nextCol = newNode;
+            rowTail = newNode;
+        }
+    };
+
+    /**
+     * @brief Adds the rows of a RowWriter, which must come after the rows of the matrix. Their nodes must
+     * already belong to the pool of the matrix.
+     */
+    void addRows(const RowWriter & writer);
+
+    /**
+     * @brief Builds every column list and the column directory from the row lists, in one pass in row order.
+     * The matrix must not have any column yet.
+     */
+    void linkColumns();
+
+    /**
+     * @brief Builds a new matrix from `work.size()` rows produced by `kernel(first, last, writer)`, for the
+     * rows at positions [first, last) of the caller's list.
+     *
+     * Without threads the kernel runs once over every position. With threads the positions are split into
+     * ranges of about equal `work`, a few per thread, each built in its own pool, as in
+     * SparseMatrix::buildRowsInParallel.
+     *
+     * @param const std::vector<std::size_t> & work Estimated cost of the row at every position.
+     * @param ThreadPool * threads The pool to run on, or nullptr to run on the calling thread.
+     */
+    template <typename RowKernel>
+    static HypersparseMatrix buildRows(Index numRow, Index numCol, const std::vector<std::size_t> & work,
+                                       ThreadPool * threads, RowKernel kernel);
+
+    static HypersparseMatrix add(const HypersparseMatrix & a, const HypersparseMatrix & b, ThreadPool * threads);
+    static HypersparseMatrix multiply(const HypersparseMatrix & a, const HypersparseMatrix & b, ThreadPool * threads);
+    static HypersparseMatrix scale(const HypersparseMatrix & a, T k, ThreadPool * threads);
+
+    public:
+    /**
+     * @brief Constructs an empty `numRow` x `numCol` matrix. Nothing is allocated until an element is stored.
+     */
+    HypersparseMatrix(Index numRow, Index numCol) : numRow(numRow), numCol(numCol) {}
+
+    HypersparseMatrix(HypersparseMatrix && other) = default;
+    HypersparseMatrix & operator=(HypersparseMatrix && other) = default;
+    HypersparseMatrix(const HypersparseMatrix &) = delete;
+    HypersparseMatrix & operator=(const HypersparseMatrix &) = delete;
+
+    Index rowLength() const { return numRow; }  ///< The number of rows.
+    Index colLength() const { return numCol; }  ///< The number of columns.
+    std::size_t nonEmptyRows() const { return rowHeaders.size(); }  ///< The number of rows holding an element.
+    std::size_t nonEmptyCols() const { return colHeaders.size(); }  ///< The number of columns holding an element.
+    std::size_t nonZeros() const { return pool.liveNodes() - rowHeaders.size() - colHeaders.size(); }  ///< The number of stored elements.
+    const NodePool & nodePool() const { return pool; }  ///< The pool that owns the nodes of the matrix.
+
+    /**
+     * @brief Returns the element at the specified row and column, 0 if it is not stored.
+     *
+     * @throws std::out_of_range if the rowIndex or colIndex is outside the matrix bounds.
+     */
+    T access(Index rowIndex, Index colIndex) const;
+
+    /**
+     * @brief Stores `data` at the specified row and column, creating the row and column placeholders if
+     * needed. Inserting a zero removes the element, as with SparseMatrix::insert.
+     *
+     * @throws std::out_of_range if the rowIndex or colIndex is outside the matrix bounds.
+     */
+    void insert(T data, Index rowIndex, Index colIndex);
+
+    /**
+     * @brief Removes the element at the specified row and column, if there is one, and the placeholders of
+     * its row and column if they become empty.
+     *
+     * @throws std::out_of_range if the rowIndex or colIndex is outside the matrix bounds.
+     */
+    void remove(Index rowIndex, Index colIndex);
+
+    /**
+     * @brief Builds a matrix from a batch of (row, column, value) entries, sorted and linked in one pass.
+     *
+     * As with SparseMatrix::fromTriplets, the last entry at a position wins and a zero leaves it empty. The
+     * sort is a comparison sort, since a counting sort over the dimensions is what this class avoids.
+     *
+     * @throws std::out_of_range if an entry is outside the matrix bounds.
+     */
+    static HypersparseMatrix fromTriplets(Index numRow, Index numCol, const std::vector<Triplet> & triplets);
+
+    /**
+     * @brief Returns `a` + `b`, merging the rows present in either matrix.
+     *
+     * @throws std::invalid_argument If the dimensions of the matrices do not match.
+     * @throws std::overflow_error If a sum of integers does not fit in T.
+     */
+    static HypersparseMatrix matrixAddition(const HypersparseMatrix & a, const HypersparseMatrix & b);
+    static HypersparseMatrix matrixAddition(const HypersparseMatrix & a, const HypersparseMatrix & b, ThreadPool & threads);
+
+    /**
+     * @brief Returns `a` * `b`. Every non-empty row of `a` gathers the products with the rows of `b` named by
+     * its columns, then sorts and sums them by column, so no dense accumulator of `b`'s width is needed.
+     *
+     * @throws std::invalid_argument If the number of columns of `a` is not the number of rows of `b`.
+     * @throws std::overflow_error If an integer product or sum does not fit in T.
+     */
+    static HypersparseMatrix matrixMultiplication(const HypersparseMatrix & a, const HypersparseMatrix & b);
+    static HypersparseMatrix matrixMultiplication(const HypersparseMatrix & a, const HypersparseMatrix & b, ThreadPool & threads);
+
+    /**
+     * @brief Returns `a` * `k`.
+     *
+     * @throws std::overflow_error If an integer product does not fit in T.
+     */
+    static HypersparseMatrix matrixScalarMultiplication(const HypersparseMatrix & a, T k);
+    static HypersparseMatrix matrixScalarMultiplication(const HypersparseMatrix & a, T k, ThreadPool & threads);
+
+    /**
+     * @brief Returns the transpose of `a`, whose rows are read off the column lists of `a`.
+     */
+    static HypersparseMatrix matrixTransposition(const HypersparseMatrix & a);
+
+    /**
+     * @brief Prints the matrix, as SparseMatrix::display does.
+     */
+    void display(DisplayMode mode = DisplayMode::Auto, std::ostream & out = std::cout) const;
+
+    /**
+     * @brief Exports the stored elements as `row,col,value` lines to `<name>_output.csv` next to `filePath`,
+     * and prints a confirmation to `out`.
+     */
+    void exportToCSV(const std::string & filePath, std::ostream & out = std::cout) const;
+};
+
+/**
+ * @class MappedFile
+ * @brief Read-only view of a whole file, memory-mapped where the platform allows it.
+ *
+ * The contents stay mapped for the lifetime of the object, so parsers can scan them in place without
+ * copying lines into strings. On platforms without mmap the file is read into one buffer instead.
+ */
+class MappedFile {
+    private:
+    const char* contents;  ///< Start of the file contents (nullptr for an empty file).
+    std::size_t length;    ///< Size of the file in bytes.
+    std::vector<char> buffer;  ///< Fallback storage when the file is not memory-mapped.
+
+    public:
+    /**
+     * @brief Maps the file at `filePath`.
+     *
+     * @param const std::string & filePath Path of the file to map.
+     *
+     * @throws std::runtime_error if the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string & filePath);
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    /**
+     * @brief Unmaps the file.
+     */
+    ~MappedFile();
+
+    const char* begin() const { return contents; }           ///< First byte of the file.
+    const char* end() const { return contents + length; }    ///< One past the last byte of the file.
+    std::size_t size() const { return length; }              ///< Size of the file in bytes.
+};
+
+/**
+ * @struct JobHeader
+ * @brief The `op,rows[,cols[,colsB]]` first line of a CSV job file.
+ */
+struct JobHeader {
+    char operation = 0;         ///< The operation letter.
+    std::uint64_t numRow = 0;   ///< Rows of matrix A, and of B for an addition.
+    std::uint64_t numCol = 0;   ///< Columns of A (`numRow` when omitted), and rows of B for a multiplication.
+    std::uint64_t numColB = 0;  ///< Columns of B for a multiplication, `numCol` when omitted.
+};
+
+/**
+ * @class MatrixFileParser
+ * @brief Allocation-free reader for the CSV job files of the program.
+ *
+ * The expected layout is an `op,size` (or `op,rows,cols`) header line, a `,,` separator line, the
+ * `row,col,value` lines of matrix A, then either a `,,` line followed by the lines of matrix B, or a single
+ * scalar line. An `E` job has its expression in place of the separator line, followed by any number of
+ * matrices separated by `,,` lines. The file is memory-mapped and scanned in place with `std::from_chars`, so
+ * reading a line allocates nothing; `\r\n` line endings and blank lines are accepted.
+ */
+class MatrixFileParser {
+    private:
+    MappedFile file;      ///< The mapped input file.
+    const char* cursor;   ///< Start of the next unread line.
+
+    /**
+     * @brief Returns the next line without its line ending, and advances past it.
+     *
+     * @param const char*& lineBegin Set to the first character of the line.
+     * @param const char*& lineEnd Set to one past the last character of the line.
+     *
+     * @return bool false if the end of the file was reached.
+     */
+    bool nextLine(const char*& lineBegin, const char*& lineEnd);
+
+    /**
+     * @brief Parses the `row,col,value` lines of [begin, end), which must start at a line, up to the first
+     * `,,` separator line.
+     *
+     * @param std::vector<Triplet<T, Index>> & triplets The entries are appended to this vector.
+     *
+     * @return const char* One past the separator line, or nullptr if there is none before `end`.
+     *
+     * @throws std::invalid_argument or std::out_of_range as readSection.
+     */
+    template <typename T, typename Index>
+    static const char* parseLines(const char* begin, const char* end, std::vector<Triplet<T, Index>> & triplets);
+
+    public:
+    static constexpr std::size_t MAX_CHUNK_BYTES = std::size_t(4) << 20;  ///< Largest chunk of a parallel read.
+    static constexpr std::size_t MIN_CHUNK_BYTES = std::size_t(64) << 10; ///< Smallest chunk of a parallel read.
+
+    /**
+     * @brief Maps the file at `filePath` and positions the parser on its first line.
+     *
+     * @throws std::runtime_error if the file cannot be opened or mapped.
+     */
+    explicit MatrixFileParser(const std::string & filePath);
+
+    /**
+     * @brief Parses one numeric field and moves `p` past the comma that ends it.
+     *
+     * Surrounding spaces are skipped, and like `std::stoi` anything after the number up to the next
+     * comma is ignored.
+     *
+     * @param const char*& p The start of the field, advanced to the start of the next field.
+     * @param const char* end The end of the line.
+     * @param Number & value Set to the parsed value, an integer or floating-point type.
+     *
+     * @throws std::invalid_argument if the field does not start with a number of that type.
+     */
+    template <typename Number>
+    static void parseField(const char*& p, const char* end, Number & value);
+
+    /**
+     * @brief Reads the `op,rows[,cols[,colsB]]` header line. A single size is a square matrix, as in
+     * `A,3`; the sizes may go up to 2^64 - 1.
+     *
+     * @param JobHeader & header Set to the operation and the dimensions.
+     *
+     * @return bool false if the file is empty.
+     *
+     * @throws std::invalid_argument if a size is not a non-negative integer.
+     */
+    bool readHeader(JobHeader & header);
+
+    /**
+     * @brief Skips one line, such as the separator that follows the header.
+     */
+    void skipLine();
+
+    /**
+     * @brief Reads one whole line, such as the expression of an `E` job, without its line ending.
+     *
+     * @return bool false if there is no line left.
+     */
+    bool readLine(std::string & line);
+
+    /**
+     * @brief Returns whether every line has been read.
+     */
+    bool atEnd() const { return cursor == nullptr || cursor >= file.end(); }
+
+    /**
+     * @brief Reads `row,col,value` lines up to the next `,,` separator line (consumed) or the end of the file.
+     *
+     * @param std::vector<Triplet<T, Index>> & triplets The entries are appended to this vector.
+     *
+     * @return std::size_t The number of entries read.
+     *
+     * @throws std::invalid_argument if a line is not made of two integers and a value of type T.
+     */
+    template <typename T, typename Index>
+    std::size_t readSection(std::vector<Triplet<T, Index>> & triplets);
+
+    /**
+     * @brief Reads the same lines as readSection, parsing them on the threads of `threads`.
+     *
+     * The rest of the file is cut at line boundaries into chunks of MIN_CHUNK_BYTES to MAX_CHUNK_BYTES, one
+     * per thread at a time, and every chunk is parsed into a buffer of its own. A chunk stops at the first
+     * separator line it holds, and the section ends with the first chunk that found one; the chunks after it
+     * are dropped, errors included, and read again with the next section. The buffers are meant for the
+     * parallel SparseMatrix::fromTriplets, which merges them without concatenating them first.
+     *
+     * @param std::vector<std::vector<Triplet<T, Index>>> & buffers The buffers of the chunks, in file order, are
+     *        appended to this vector.
+     * @param ThreadPool & threads The threads parsing the chunks.
+     *
+     * @return std::size_t The number of entries read.
+     *
+     * @throws std::invalid_argument or std::out_of_range as readSection, for the first bad line of the section.
+     */
+    template <typename T, typename Index>
+    std::size_t readSection(std::vector<std::vector<Triplet<T, Index>>> & buffers, ThreadPool & threads);
+
+    /**
+     * @brief Reads the scalar line that follows matrix A in a scalar multiplication file.
+     *
+     * @param T & scalar Set to the first field of the line.
+     *
+     * @return bool false if there is no line left.
+     *
+     * @throws std::invalid_argument if the field is not a value of type T.
+     */
+    template <typename T>
+    bool readScalar(T & scalar);
+};
+
+/**
+ * @class BinaryMatrixFile
+ * @brief Versioned binary on-disk format for a matrix in compressed sparse row form.
+ *
+ * The file starts with a fixed Header (magic "SPMB", version, value type, dimensions and number of
+ * non-zeros), followed by three arrays, each padded to a multiple of 8 bytes: the `numRow + 1` row
+ * pointers (uint64), the `nnz` 1-based column indices (uint32) and the `nnz` values, whose type is given
+ * by the value type code of the header (see ValueTraits::BINARY_TYPE). Numbers are stored in the byte
+ * order of the host.
+ *
+ * Opening a file maps it and points straight into the mapping, so loading costs no parsing and no copy
+ * until the matrix is converted with toCSR() or toSparseMatrix(). Files are written by
+ * SparseMatrix::exportToBinary and CSRMatrix::exportToBinary.
+ */
+class BinaryMatrixFile {
+    public:
+    static constexpr std::uint32_t VERSION = 1;      ///< Current version of the format.
+
+    /**
+     * @struct Header
+     * @brief Fixed-size header at the start of every file.
+     */
+    struct Header {
+        char magic[4];              ///< Always "SPMB".
+        std::uint32_t version;      ///< Format version, see VERSION.
+        std::uint32_t valueType;    ///< Type of the values, see ValueTraits::BINARY_TYPE.
+        std::uint32_t reserved;     ///< Zero, keeps the dimensions 8-byte aligned.
+        std::uint64_t numRow;       ///< Number of rows.
+        std::uint64_t numCol;       ///< Number of columns.
+        std::uint64_t nonZeros;     ///< Number of stored entries.
+    };
+
+    /**
+     * @brief Returns `bytes` rounded up to the padding of the arrays.
+     */
+    static std::uint64_t padded(std::uint64_t bytes) { return (bytes + 7) & ~std::uint64_t(7); }
+
+    /**
+     * @brief Returns the size in bytes of one value of the given type code, or 0 for an unknown code.
+     */
+    static std::size_t valueSize(std::uint32_t valueType);
+
+    /**
+     * @brief Builds the header of a file holding a `numRow` x `numCol` matrix of T with `nonZeros` entries.
+     *
+     * @throws std::invalid_argument if the matrix has more columns than the uint32 column indices can hold.
+     */
+    template <typename T>
+    static Header makeHeader(std::uint64_t numRow, std::uint64_t numCol, std::uint64_t nonZeros);
+
+    /**
+     * @brief Maps the file at `filePath` and checks its header, its size and, in one pass over the entries, that
+     * the row pointers never decrease and the column indices of every row increase within 1..numCol.
+     *
+     * @param const std::string & filePath Path of the file to load.
+     *
+     * @throws std::runtime_error if the file cannot be opened or is not a valid matrix file of this version.
+     */
+    explicit BinaryMatrixFile(const std::string & filePath);
+
+    std::uint64_t rowLength() const { return header->numRow; }  ///< The number of rows.
+    std::uint64_t colLength() const { return header->numCol; }  ///< The number of columns.
+    std::size_t nonZeros() const { return header->nonZeros; }   ///< The number of stored elements.
+    std::uint32_t valueType() const { return header->valueType; } ///< The value type code of the file.
+
+    const std::uint64_t* rowPointers() const { return rowPtr; }  ///< The mapped row pointers.
+    const std::uint32_t* colIndices() const { return colIndex; } ///< The mapped column indices.
+
+    /**
+     * @brief Returns the mapped values.
+     *
+     * @throws std::runtime_error if the file does not hold values of type T.
+     */
+    template <typename T>
+    const T* values() const;
+
+    /**
+     * @brief Accesses the value at the specified row and column, by binary search in the mapped row.
+     *
+     * @return T The value at the specified row and column. Returns 0 if the element is not stored.
+     *
+     * @throws std::out_of_range if the rowIndex or colIndex is outside the matrix bounds.
+     * @throws std::runtime_error if the file does not hold values of type T.
+     */
+    template <typename T>
+    T access(std::uint64_t rowIndex, std::uint64_t colIndex) const;
+
+    /**
+     * @brief Copies the mapped arrays into a CSRMatrix, one bulk copy per array.
+     *
+     * @return CSRMatrix<T, Index> The matrix in compressed sparse row form.
+     *
+     * @throws std::runtime_error if the file does not hold values of type T or its dimensions do not fit in Index.
+     */
+    template <typename T = std::int32_t, typename Index = std::uint32_t>
+    CSRMatrix<T, Index> toCSR() const;
+
+    /**
+     * @brief Builds a linked SparseMatrix directly from the mapped arrays.
+     *
+     * @return SparseMatrix<T, Index> The matrix as circularly-linked lists.
+     *
+     * @throws std::runtime_error if the file does not hold values of type T or its dimensions do not fit in Index.
+     */
+    template <typename T = std::int32_t, typename Index = std::uint32_t>
+    SparseMatrix<T, Index> toSparseMatrix() const;
+
+    private:
+    MappedFile file;                ///< The mapped file, kept alive while the arrays are used.
+    const Header* header;           ///< The header at the start of the mapping.
+    const std::uint64_t* rowPtr;    ///< The row pointers inside the mapping.
+    const std::uint32_t* colIndex;  ///< The column indices inside the mapping.
+    const char* value;              ///< The values inside the mapping, of the type given by the header.
+
+    /**
+     * @brief Checks that the values are of type T and the dimensions fit in Index.
+     *
+     * @throws std::runtime_error if they do not.
+     */
+    template <typename T, typename Index>
+    void checkType() const;
+};
+
+/**
+ * @class OutOfCoreMultiplier
+ * @brief Multiplies two binary matrix files whose product does not fit in memory, within a memory budget.
+ *
+ * The columns of B are cut into blocks, and the product is computed one block at a time: the block of B is
+ * copied from the mapped file into memory, then the rows of A are streamed in tiles, each tile computed with
+ * a sparse accumulator as in SparseMatrix::multiplyRow. The rows of every tile are spilled to three files per
+ * block (the count of every row, then the column indices and the values), and once all blocks are done the
+ * spill files are merged row by row into the `.smb` result, one array of the format at a time.
+ *
+ * The blocks are as wide as the budget allows (or Options::tileCols), and a tile takes rows of A until the
+ * most entries it could produce reach its share of the budget (or Options::tileRows), so the block, the
+ * accumulators and the tiles in flight stay under Options::memoryLimit. The operands are read through their
+ * mappings, whose pages the system can drop at any time, and are not counted.
+ */
+class OutOfCoreMultiplier {
+    public:
+    static constexpr std::uint64_t MIN_MEMORY_LIMIT = std::uint64_t(16) << 20;  ///< The smallest budget accepted.
+
+    /**
+     * @struct Options
+     * @brief The memory budget and the tile sizes of a product.
+     */
+    struct Options {
+        std::uint64_t memoryLimit = std::uint64_t(256) << 20;  ///< Bytes of memory the product may use.
+        std::uint64_t tileRows = 0;   ///< Most rows of A in a tile, 0 to only bound tiles by the budget.
+        std::uint32_t tileCols = 0;   ///< Most columns of B in a block, 0 to only bound blocks by the budget.
+    };
+
+    /**
+     * @brief Computes the product of two binary matrix files into a third one.
+     *
+     * @param const BinaryMatrixFile & a The left operand.
+     * @param const BinaryMatrixFile & b The right operand.
+     * @param const std::string & outputPath The `.smb` file of the result; the spill files are written next
+     *        to it, as `<outputPath>.<block>.rows`, `.cols` and `.values`, and removed at the end.
+     * @param const Options & options The memory budget and the tile sizes.
+     * @param ThreadPool * threads Computes the tiles of a block in parallel, one per worker, or nullptr.
+     * @param std::ostream * progress Receives a line whenever another PROGRESS_PERCENT of the product is
+     *        done, and at the start of every merge pass, or nullptr.
+     *
+     * @return std::uint64_t The number of non-zeros of the product.
+     *
+     * @throws std::invalid_argument If the dimensions do not match or the budget is below MIN_MEMORY_LIMIT.
+     * @throws std::runtime_error If a file does not hold values of type T, cannot be written, a single
+     *         column of B does not fit in the budget, or the merge would need more open files than allowed.
+     * @throws std::out_of_range If a column index of an operand is outside its matrix.
+     * @throws std::overflow_error If an integer sum or product does not fit in T.
+     */
+    template <typename T>
+    static std::uint64_t multiply(const BinaryMatrixFile & a, const BinaryMatrixFile & b, const std::string & outputPath,
+                                  const Options & options, ThreadPool * threads = nullptr, std::ostream * progress = nullptr);
+
+    private:
+    static constexpr unsigned int PROGRESS_PERCENT = 5;                   ///< Step between two progress lines.
+    static constexpr std::uint64_t SPILL_BUFFER = std::uint64_t(1) << 20; ///< Bytes buffered per spill file.
+
+    /**
+     * @struct ColumnBlock
+     * @brief The columns `first` to `last` (1-based, inclusive) of B and their number of entries.
+     */
+    struct ColumnBlock {
+        std::uint32_t first;
+        std::uint32_t last;
+        std::uint64_t nonZeros;
+    };
+
+    /**
+     * @brief Cuts the columns of B into blocks whose copy, with the accumulator of every worker, takes at
+     * most `budget` bytes.
+     */
+    static std::vector<ColumnBlock> planColumnBlocks(const BinaryMatrixFile & b, std::size_t valueBytes, std::uint64_t budget,
+                                                     std::uint32_t maxWidth, std::size_t workers);
+
+    /**
+     * @brief Makes sure `files` files can be open at once, raising the soft limit of the process up to its hard
+     * limit if needed.
+     *
+     * @throws std::runtime_error If the hard limit is lower.
+     */
+    static void reserveOpenFiles(std::uint64_t files);
+
+    /**
+     * @class SpillReader
+     * @brief Reads a spill file back in order through a buffer of fixed size.
+     */
+    class SpillReader {
+        private:
+        std::ifstream file;
+        std::vector<char> buffer;
+        std::size_t position = 0;
+        std::size_t filled = 0;
+
+        public:
+        /**
+         * @brief Opens a spill file.
+         *
+         * @throws std::runtime_error If the file cannot be opened.
+         */
+        SpillReader(const std::string & filePath, std::size_t bufferSize);
+
+        /**
+         * @brief Copies the next `bytes` bytes of the file to `destination`.
+         *
+         * @throws std::runtime_error If the file ends first.
+         */
+        void read(void* destination, std::size_t bytes);
+
+        /**
+         * @brief Appends the next `bytes` bytes of the file to `writer`.
+         *
+         * @throws std::runtime_error If the file ends first.
+         */
+        void copyTo(BufferedWriter & writer, std::uint64_t bytes);
+
+        private:
+        /**
+         * @brief Reads the next part of the file into the buffer once it is used up.
+         *
+         * @throws std::runtime_error If the file has ended.
+         */
+        void refill();
+    };
+};
+
+/*==============================================================================================================*/
+// Implementation of MatrixStats report method
+void MatrixStats::report(std::ostream & out) const {
+    if (!ENABLED) {
+        out << "counters  compiled out (build with -DSPARSE_MATRIX_STATS)" << std::endl;
+        return;
+    }
+    auto traversal = [&](const char* name, const std::atomic<std::uint64_t> & calls, const std::atomic<std::uint64_t> & hops) {
+        std::uint64_t callCount = calls.load(std::memory_order_relaxed);
+        std::uint64_t hopCount = hops.load(std::memory_order_relaxed);
+        out << name << callCount << " calls, " << hopCount << " hops";
+        if (callCount != 0) {
+            out << " (" << double(hopCount) / callCount << " per call)";
+        }
+        out << std::endl;
+    };
+    traversal("access    ", accessCalls, accessHops);
+    traversal("insert    ", insertCalls, insertHops);
+    traversal("remove    ", removeCalls, removeHops);
+    out << "nodes     " << nodeAllocations.load(std::memory_order_relaxed) << " allocated, "
+        << nodeFrees.load(std::memory_order_relaxed) << " freed" << std::endl;
+    out << "slabs     " << bytesHeld.load(std::memory_order_relaxed) << " bytes held, "
+        << peakBytesHeld.load(std::memory_order_relaxed) << " bytes at peak" << std::endl;
+}
+
+/*==============================================================================================================*/
+// Implementation of NodePool move constructor
+template <typename T, typename Index>
+NodePool<T, Index>::NodePool(NodePool && other) noexcept
+    : slabs(std::move(other.slabs)), currentSlab(other.currentSlab), slabUsed(other.slabUsed),
+      nextSlabNodes(other.nextSlabNodes), freeList(other.freeList), allocations(other.allocations), frees(other.frees) {
+    other.slabs.clear();
+    other.currentSlab = 0;
+    other.slabUsed = 0;
+    other.nextSlabNodes = MIN_SLAB_NODES;
+    other.freeList = nullptr;
+    other.allocations = 0;
+    other.frees = 0;
+}
+
+// Implementation of NodePool move assignment operator
+template <typename T, typename Index>
+NodePool<T, Index> & NodePool<T, Index>::operator=(NodePool && other) noexcept {
+    if (this != &other) {
+        releaseSlabs();
+        slabs = std::move(other.slabs);
+        currentSlab = other.currentSlab;
+        slabUsed = other.slabUsed;
+        nextSlabNodes = other.nextSlabNodes;
+        freeList = other.freeList;
+        allocations = other.allocations;
+        frees = other.frees;
+
+        other.slabs.clear();
+        other.currentSlab = 0;
+        other.slabUsed = 0;
+        other.nextSlabNodes = MIN_SLAB_NODES;
+        other.freeList = nullptr;
+        other.allocations = 0;
+        other.frees = 0;
+    }
+    return *this;
+}
+
+// Implementation of NodePool destructor
+template <typename T, typename Index>
+NodePool<T, Index>::~NodePool() {
+    releaseSlabs();
+}
+
+// Implementation of NodePool releaseSlabs method
+template <typename T, typename Index>
+void NodePool<T, Index>::releaseSlabs() {
+#ifdef SPARSE_MATRIX_STATS
+    matrixStats().nodeAllocations.fetch_add(allocations, std::memory_order_relaxed);
+    matrixStats().nodeFrees.fetch_add(frees, std::memory_order_relaxed);
+    matrixStats().bytesHeld.fetch_sub(bytesReserved(), std::memory_order_relaxed);
+#endif
+    for (const Slab & slab : slabs) {
+        SlabCache::release(slab.nodes, slab.capacity * sizeof(Node));
+    }
+}
+
+// Implementation of NodePool addSlab method
+template <typename T, typename Index>
+void NodePool<T, Index>::addSlab(std::size_t minNodes) {
+    std::size_t next = slabs.empty() ? 0 : currentSlab + 1;
+    if (next == slabs.size() || slabs[next].capacity < minNodes) { // No spare slab left by reset() fits
+        std::size_t capacity = std::max(minNodes, nextSlabNodes);
+        slabs.insert(slabs.begin() + next, Slab{static_cast<Node*>(SlabCache::allocate(capacity * sizeof(Node))), capacity});
+#ifdef SPARSE_MATRIX_STATS
+        matrixStats().addBytes(capacity * sizeof(Node));
+#endif
+        nextSlabNodes = std::min(nextSlabNodes * 2, MAX_SLAB_NODES); // Grow geometrically up to the cap
+    }
+    currentSlab = next;
+    slabUsed = 0;
+}
+
+// Implementation of NodePool reserve method
+template <typename T, typename Index>
+void NodePool<T, Index>::reserve(std::size_t count) {
+    std::size_t available = slabs.empty() ? 0 : slabs[currentSlab].capacity - slabUsed;
+    if (available < count) {
+        addSlab(count);
+    }
+}
+
+// Implementation of NodePool allocate method
+template <typename T, typename Index>
+Node<T, Index>* NodePool<T, Index>::allocate(T data, Index rowIndex, Index colIndex) {
+    Node* place;
+    if (freeList != nullptr) { // Reuse a released node first
+        place = freeList;
+        freeList = freeList->nextCol;
+    } else {
+        if (slabs.empty() || slabUsed == slabs[currentSlab].capacity) {
+            addSlab(0);
+        }
+        place = slabs[currentSlab].nodes + slabUsed++;
+    }
+    allocations++;
+    return new (place) Node(data, rowIndex, colIndex);
+}
+
+// Implementation of NodePool release method
+template <typename T, typename Index>
+void NodePool<T, Index>::release(Node* node) {
+    node->nextCol = freeList;
+    freeList = node;
+    frees++;
+}
+
+// Implementation of NodePool adopt method
+template <typename T, typename Index>
+void NodePool<T, Index>::adopt(NodePool && other) {
+    if (slabs.empty()) { // Nothing to keep, carry on filling the slab of the other pool
+        slabs = std::move(other.slabs);
+        currentSlab = other.currentSlab;
+        slabUsed = other.slabUsed;
+    } else { // Keep the slab being filled current, so that bump allocation carries on in it
+        slabs.insert(slabs.begin() + currentSlab, other.slabs.begin(), other.slabs.end());
+        currentSlab += other.slabs.size();
+    }
+    if (other.freeList != nullptr) {
+        Node* last = other.freeList;
+        while (last->nextCol != nullptr) {
+            last = last->nextCol;
+        }
+        last->nextCol = freeList;
+        freeList = other.freeList;
+    }
+    allocations += other.allocations;
+    frees += other.frees;
+
+    other.slabs.clear();
+    other.currentSlab = 0;
+    other.slabUsed = 0;
+    other.freeList = nullptr;
+    other.allocations = 0;
+    other.frees = 0;
+}
+
+// Implementation of NodePool reset method
+template <typename T, typename Index>
+void NodePool<T, Index>::reset() {
+    currentSlab = 0;
+    slabUsed = 0;
+    freeList = nullptr; // The free nodes are part of the slabs being recycled
+    frees = allocations;
+}
+
+// Implementation of NodePool bytesReserved method
+template <typename T, typename Index>
+std::size_t NodePool<T, Index>::bytesReserved() const {
+    std::size_t bytes = 0;
+    for (const Slab & slab : slabs) {
+        bytes += slab.capacity * sizeof(Node);
+    }
+    return bytes;
+}
+
+/*==============================================================================================================*/
+// The pool and worker index of the current thread, if it is a pool worker
+static thread_local ThreadPool* currentPool = nullptr;
+static thread_local std::size_t currentWorker = 0;
+
+// Implementation of ThreadPool constructor
+ThreadPool::ThreadPool(unsigned int threads, SlabCache * slabs) : queued(0), pending(0), nextQueue(0), stopping(false) {
+    threads = std::max(1u, threads);
+    for (unsigned int t = 0; t < threads; t++) {
+        queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (unsigned int t = 0; t < threads; t++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, t, slabs);
+    }
+}
+
+// Implementation of ThreadPool destructor
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread & worker : workers) {
+        worker.join();
+    }
+}
+
+// Implementation of ThreadPool submit method
+void ThreadPool::submit(std::function<void()> task) {
+    std::size_t target;
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        queued++;  // Counted before the push, so a worker never takes a task that is not counted yet
+        pending++;
+        target = currentPool == this ? currentWorker : nextQueue++ % queues.size();
+    }
+    {
+        std::lock_guard<std::mutex> guard(queues[target]->lock);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    wakeUp.notify_one();
+}
+
+// Implementation of ThreadPool takeTask method
+bool ThreadPool::takeTask(std::size_t index, std::function<void()> & task) {
+    for (std::size_t offset = 0; offset < queues.size(); offset++) {
+        WorkerQueue & queue = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (offset == 0) { // Own deque: newest task first
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {           // Steal the oldest task of another worker
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        std::lock_guard<std::mutex> state(stateLock);
+        queued--;
+        return true;
+    }
+    return false;
+}
+
+// Implementation of ThreadPool workerLoop method
+void ThreadPool::workerLoop(std::size_t index, SlabCache * slabs) {
+    currentPool = this;
+    currentWorker = index;
+    SlabCache::share(slabs);
+    while (true) {
+        std::function<void()> task;
+        if (takeTask(index, task)) {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(stateLock);
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+            }
+            std::lock_guard<std::mutex> guard(stateLock);
+            if (--pending == 0) {
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(stateLock);
+        wakeUp.wait(lock, [this]() { return stopping || queued > 0; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
+
+// Implementation of ThreadPool wait method
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(stateLock);
+    allDone.wait(lock, [this]() { return pending == 0; });
+    if (firstError) {
+        std::exception_ptr error = firstError;
+        firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+// Implementation of ThreadPool parallelFor method
+template <typename Function>
+void ThreadPool::parallelFor(std::size_t begin, std::size_t end, std::size_t parts, Function body) {
+    if (end <= begin) {
+        return;
+    }
+    parts = std::max<std::size_t>(1, std::min(parts, end - begin));
+    std::size_t step = (end - begin + parts - 1) / parts;
+    for (std::size_t first = begin; first < end; first += step) {
+        std::size_t last = std::min(end, first + step);
+        submit([&body, first, last]() { body(first, last); });
+    }
+    wait();
+}
+
+/*==============================================================================================================*/
+// Implementation of rowLength method
+template <typename T, typename Index>
+Index SparseMatrix<T, Index>::rowLength() const {
+    return this->numRow;
+}
+
+// Implementation of colLength method
+template <typename T, typename Index>
+Index SparseMatrix<T, Index>::colLength() const {
+    return this->numCol;
+}
+
+// Implementation of appendNode method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::appendNode(T data, Index rowIndex, Index colIndex, Node*& rowTail, std::vector<Node*> & colTails) {
+    Node* newNode = this->pool.allocate(data, rowIndex, colIndex);
+
+    // Link at the end of the row, closing the circle back to the row placeholder
+    newNode->nextCol = this->rowHeaders[rowIndex];
+    rowTail->nextCol = newNode;
+    rowTail = newNode;
+
+    // Link at the end of the column, closing the circle back to the column placeholder
+    newNode->nextRow = this->colHeaders[colIndex];
+    colTails[colIndex]->nextRow = newNode;
+    colTails[colIndex] = newNode;
+}
+
+// Implementation of rowPredecessor method
+template <typename T, typename Index>
+Node<T, Index>* SparseMatrix<T, Index>::rowPredecessor(Index rowIndex, Index colIndex, std::uint64_t & hops) const {
+    if (this->index && this->index->rows[rowIndex]) { // Long row, look the position up in its index
+        const std::map<Index, Node*> & row = *this->index->rows[rowIndex];
+        typename std::map<Index, Node*>::const_iterator next = row.lower_bound(colIndex);
+        return next == row.begin() ? this->rowHeaders[rowIndex] : std::prev(next)->second;
+    }
+
+    // Start at the row placeholder
+    Node* rowNode = this->rowHeaders[rowIndex];
+
+    // Traverse and find the correct position in the row based on the column index
+    while (rowNode->nextCol != this->rowHeaders[rowIndex] && rowNode->nextCol->colIndex < colIndex) {
+        rowNode = rowNode->nextCol;
+        hops++;
+    }
+    return rowNode;
+}
+
+// Implementation of colPredecessor method
+template <typename T, typename Index>
+Node<T, Index>* SparseMatrix<T, Index>::colPredecessor(Index colIndex, Index rowIndex, std::uint64_t & hops) const {
+    if (this->index && this->index->cols[colIndex]) { // Long column, look the position up in its index
+        const std::map<Index, Node*> & col = *this->index->cols[colIndex];
+        typename std::map<Index, Node*>::const_iterator next = col.lower_bound(rowIndex);
+        return next == col.begin() ? this->colHeaders[colIndex] : std::prev(next)->second;
+    }
+
+    // Start at the column placeholder
+    Node* colNode = this->colHeaders[colIndex];
+
+    // Traverse and find the correct position in the column based on the row index
+    while (colNode->nextRow != this->colHeaders[colIndex] && colNode->nextRow->rowIndex < rowIndex) {
+        colNode = colNode->nextRow;
+        hops++;
+    }
+    return colNode;
+}
+
+// Implementation of access method
+template <typename T, typename Index>
+T SparseMatrix<T, Index>::access(Index rowIndex, Index colIndex) const {
+    // Check for out-of-bounds indices
+    if (rowIndex == 0 || rowIndex > this->numRow || colIndex == 0 || colIndex > this->numCol) {
+        throw std::out_of_range("Row or column index is out of bounds");
+    }
+
+    // Find the node just before the position in the row
+    std::uint64_t hops = 0;
+    Node* rowNode = rowPredecessor(rowIndex, colIndex, hops);
+    SPARSE_MATRIX_COUNT(accessCalls, 1);
+    SPARSE_MATRIX_COUNT(accessHops, hops);
+
+    // If no node exists, return 0
+    if (rowNode->nextCol == this->rowHeaders[rowIndex] || rowNode->nextCol->colIndex != colIndex) {
+        return 0;
+    }
+
+    // Return the data
+    return rowNode->nextCol->data;
+}
+
+// Implementation of insert method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::insert(T data, Index rowIndex, Index colIndex) {
+    // Check for out-of-bounds indices
+    if (rowIndex == 0 || rowIndex > this->numRow || colIndex == 0 || colIndex > this->numCol) {
+        throw std::out_of_range("Row or column index is out of bounds");
+    }
+
+    // A zero value is not stored, so inserting one deletes the element
+    if (data == 0) {
+        remove(rowIndex, colIndex);
+        return;
+    }
+
+    // ===== Insert into the row ===== //
+    // Find the correct position in the row based on the column index
+    std::uint64_t rowHops = 0;
+    Node* rowNode = rowPredecessor(rowIndex, colIndex, rowHops);
+    SPARSE_MATRIX_COUNT(insertCalls, 1);
+
+    // If the node already exists at the position (rowIndex, colIndex), update its data
+    if (rowNode->nextCol != this->rowHeaders[rowIndex] && rowNode->nextCol->colIndex == colIndex) {
+        rowNode->nextCol->data = data;  // Update the existing node's data
+        SPARSE_MATRIX_COUNT(insertHops, rowHops);
+        if (this->index) {
+            indexAdd(rowNode->nextCol, rowHops, 0);
+        }
+        return;
+    }
+
+    // If no node existed, create a new node for the matrix
+    Node* newNode = this->pool.allocate(data, rowIndex, colIndex);
+
+    // Insert the new node into the row
+    newNode->nextCol = rowNode->nextCol;  // Link to the next node in the row
+    rowNode->nextCol = newNode;  // Link the previous node to the new node
+
+    //=============================================================================================//
+
+    // ===== Insert into the column ===== //
+    // Find the correct position in the column based on the row index
+    std::uint64_t colHops = 0;
+    Node* colNode = colPredecessor(colIndex, rowIndex, colHops);
+    SPARSE_MATRIX_COUNT(insertHops, rowHops + colHops);
+
+    // Insert the new node into the column
+    newNode->nextRow = colNode->nextRow;  // Link to the next node in the column
+    colNode->nextRow = newNode;  // Link the previous node to the new node
+
+    if (this->index) {
+        indexAdd(newNode, rowHops, colHops);
+    }
+}
+
+// Implementation of remove method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::remove(Index rowIndex, Index colIndex) {
+    // Check for out-of-bounds indices
+    if (rowIndex == 0 || rowIndex > this->numRow || colIndex == 0 || colIndex > this->numCol) {
+        throw std::out_of_range("Row or column index is out of bounds");
+    }
+
+    // ===== Remove from the row =====
+    // Find the node to remove in the row
+    std::uint64_t rowHops = 0;
+    Node* prevRowNode = rowPredecessor(rowIndex, colIndex, rowHops);
+    Node* toRemoveRowNode = prevRowNode->nextCol;
+    SPARSE_MATRIX_COUNT(removeCalls, 1);
+
+    // If the node is found in the row list
+    if (toRemoveRowNode != this->rowHeaders[rowIndex] && toRemoveRowNode->colIndex == colIndex) {
+        prevRowNode->nextCol = toRemoveRowNode->nextCol;  // Remove node from row
+    } else {
+        SPARSE_MATRIX_COUNT(removeHops, rowHops);
+        return;  // Node not found
+    }
+
+    // ===== Remove from the column =====
+    // Find the node to remove in the column
+    std::uint64_t colHops = 0;
+    Node* prevColNode = colPredecessor(colIndex, rowIndex, colHops);
+    Node* toRemoveColNode = prevColNode->nextRow;
+    SPARSE_MATRIX_COUNT(removeHops, rowHops + colHops);
+
+    // If the node is found in the column list
+    if (toRemoveColNode != this->colHeaders[colIndex] && toRemoveColNode->rowIndex == rowIndex) {
+        prevColNode->nextRow = toRemoveColNode->nextRow;  // Remove node from column
+    }
+
+    if (this->index) {
+        indexRemove(toRemoveRowNode, rowHops, colHops);
+    }
+
+    // Give the node back to the pool
+    this->pool.release(toRemoveRowNode);  // Only need to release once since row and column point to the same node
+}
+
+// Implementation of applyUpdates method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::applyUpdates(const std::vector<Triplet> & batch) {
+    // Check the bounds first, so that a bad entry leaves the matrix untouched
+    for (const Triplet & t : batch) {
+        if (t.rowIndex == 0 || t.rowIndex > this->numRow || t.colIndex == 0 || t.colIndex > this->numCol) {
+            throw std::out_of_range("Row or column index is out of bounds");
+        }
+    }
+
+    // Sort by (row, column). Both sorts are stable, so duplicates stay in input order and the last one wins.
+    // Counting sort costs O(rows + cols) on top, so small batches are sorted by comparison instead
+    std::vector<Triplet> sorted;
+    if (batch.size() >= std::size_t(this->numRow) + this->numCol) {
+        sorted = sortTriplets(this->numRow, this->numCol, batch);
+    } else {
+        sorted = batch;
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Triplet & x, const Triplet & y) {
+            return x.rowIndex != y.rowIndex ? x.rowIndex < y.rowIndex : x.colIndex < y.colIndex;
+        });
+    }
+
+    // ===== Merge into the rows ===== //
+    // Nodes linked into or unlinked from their rows, which still have to be linked into or unlinked from their columns
+    std::vector<std::pair<Node*, bool>> changes;
+    std::size_t p = 0;
+    while (p < sorted.size()) {
+        Index i = sorted[p].rowIndex;
+        Node* rowPrev = this->rowHeaders[i];
+        std::map<Index, Node*>* row = this->index ? this->index->rows[i].get() : nullptr;
+        std::uint64_t hops = 0;
+        for (; p < sorted.size() && sorted[p].rowIndex == i; p++) {
+            const Triplet & t = sorted[p];
+            if (p + 1 < sorted.size() && sorted[p + 1].rowIndex == i && sorted[p + 1].colIndex == t.colIndex) {
+                continue;
+            }
+
+            // Find the node just before the column, from the index or by walking on from the previous update
+            if (row) {
+                rowPrev = rowPredecessor(i, t.colIndex, hops);
+            } else {
+                while (rowPrev->nextCol != this->rowHeaders[i] && rowPrev->nextCol->colIndex < t.colIndex) {
+                    rowPrev = rowPrev->nextCol;
+                    hops++;
+                }
+            }
+            Node* current = rowPrev->nextCol;
+            bool found = current != this->rowHeaders[i] && current->colIndex == t.colIndex;
+
+            if (found && t.data != 0) { // Overwrite
+                current->data = t.data;
+            } else if (found) { // Delete
+                rowPrev->nextCol = current->nextCol;
+                changes.push_back(std::make_pair(current, false));
+                if (row) {
+                    row->erase(t.colIndex);
+                }
+            } else if (t.data != 0) { // Insert
+                Node* newNode = this->pool.allocate(t.data, i, t.colIndex);
+                newNode->nextCol = current;
+                rowPrev->nextCol = newNode;
+                rowPrev = newNode;
+                changes.push_back(std::make_pair(newNode, true));
+                if (row) {
+                    row->emplace(t.colIndex, newNode);
+                }
+            }
+        }
+        if (this->index && !row && hops >= this->index->minLength) {
+            indexRow(i);
+        }
+    }
+
+    // ===== Merge into the columns ===== //
+    // The changes were made row by row, so a stable sort by column leaves every column sorted by row
+    std::stable_sort(changes.begin(), changes.end(), [](const std::pair<Node*, bool> & x, const std::pair<Node*, bool> & y) {
+        return x.first->colIndex < y.first->colIndex;
+    });
+    p = 0;
+    while (p < changes.size()) {
+        Index j = changes[p].first->colIndex;
+        Node* colPrev = this->colHeaders[j];
+        std::map<Index, Node*>* col = this->index ? this->index->cols[j].get() : nullptr;
+        std::uint64_t hops = 0;
+        for (; p < changes.size() && changes[p].first->colIndex == j; p++) {
+            Node* node = changes[p].first;
+            if (col) {
+                colPrev = colPredecessor(j, node->rowIndex, hops);
+            } else {
+                while (colPrev->nextRow != this->colHeaders[j] && colPrev->nextRow->rowIndex < node->rowIndex) {
+                    colPrev = colPrev->nextRow;
+                    hops++;
+                }
+            }
+
+            if (changes[p].second) { // Link the new node
+                node->nextRow = colPrev->nextRow;
+                colPrev->nextRow = node;
+                colPrev = node;
+                if (col) {
+                    col->emplace(node->rowIndex, node);
+                }
+            } else { // Unlink the deleted node, which is the next one in the column
+                colPrev->nextRow = node->nextRow;
+                if (col) {
+                    col->erase(node->rowIndex);
+                }
+            }
+        }
+        if (this->index && !col && hops >= this->index->minLength) {
+            indexCol(j);
+        }
+    }
+
+    // Deleted nodes are out of both lists now, give them back to the pool
+    for (const std::pair<Node*, bool> & change : changes) {
+        if (!change.second) {
+            this->pool.release(change.first);
+        }
+    }
+}
+
+// Implementation of buildIndex method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::buildIndex(std::size_t minLength) {
+    this->index.reset(new LineIndex{minLength, {}, {}});
+    this->index->rows.resize(std::size_t(this->numRow) + 1);
+    this->index->cols.resize(std::size_t(this->numCol) + 1);
+
+    // Count the length of every line in one pass over the rows
+    std::vector<std::size_t> colLengths(std::size_t(this->numCol) + 1, 0);
+    for (std::size_t i = 1; i <= this->numRow; i++) {
+        std::size_t length = 0;
+        for (Node* current = this->rowHeaders[i]->nextCol; current != this->rowHeaders[i]; current = current->nextCol) {
+            length++;
+            colLengths[current->colIndex]++;
+        }
+        if (length > 0 && length >= minLength) {
+            indexRow(i);
+        }
+    }
+    for (std::size_t j = 1; j <= this->numCol; j++) {
+        if (colLengths[j] > 0 && colLengths[j] >= minLength) {
+            indexCol(j);
+        }
+    }
+}
+
+// Implementation of indexRow method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::indexRow(Index rowIndex) {
+    std::unique_ptr<std::map<Index, Node*>> & row = this->index->rows[rowIndex];
+    row.reset(new std::map<Index, Node*>());
+    for (Node* current = this->rowHeaders[rowIndex]->nextCol; current != this->rowHeaders[rowIndex]; current = current->nextCol) {
+        row->emplace_hint(row->end(), current->colIndex, current); // In order, so every insertion is at the end
+    }
+}
+
+// Implementation of indexCol method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::indexCol(Index colIndex) {
+    std::unique_ptr<std::map<Index, Node*>> & col = this->index->cols[colIndex];
+    col.reset(new std::map<Index, Node*>());
+    for (Node* current = this->colHeaders[colIndex]->nextRow; current != this->colHeaders[colIndex]; current = current->nextRow) {
+        col->emplace_hint(col->end(), current->rowIndex, current);
+    }
+}
+
+// Implementation of indexAdd method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::indexAdd(Node* node, std::uint64_t rowHops, std::uint64_t colHops) {
+    if (this->index->rows[node->rowIndex]) {
+        this->index->rows[node->rowIndex]->emplace(node->colIndex, node); // No-op if the node was already there
+    } else if (rowHops >= this->index->minLength) {
+        indexRow(node->rowIndex);
+    }
+    if (this->index->cols[node->colIndex]) {
+        this->index->cols[node->colIndex]->emplace(node->rowIndex, node);
+    } else if (colHops >= this->index->minLength) {
+        indexCol(node->colIndex);
+    }
+}
+
+// Implementation of indexRemove method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::indexRemove(Node* node, std::uint64_t rowHops, std::uint64_t colHops) {
+    if (this->index->rows[node->rowIndex]) {
+        this->index->rows[node->rowIndex]->erase(node->colIndex);
+    } else if (rowHops >= this->index->minLength) {
+        indexRow(node->rowIndex);
+    }
+    if (this->index->cols[node->colIndex]) {
+        this->index->cols[node->colIndex]->erase(node->rowIndex);
+    } else if (colHops >= this->index->minLength) {
+        indexCol(node->colIndex);
+    }
+}
+
+// Implementation of display method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::display(DisplayMode mode, std::ostream & out) const {
+    mode = displayModeFor(mode, numRow, numCol);
+    if (mode == DisplayMode::None) {
+        return;
+    }
+    BufferedWriter writer(out);
+
+    // Iterate over each row
+    for (std::size_t i = 1; i <= numRow; ++i) {
+        Node* current = rowHeaders[i]->nextCol;  // Skip the placeholder and start with the first actual node
+
+        if (mode == DisplayMode::Sparse) { // Only the stored elements of the row
+            for (; current != rowHeaders[i]; current = current->nextCol) {
+                writer.writeNumber(i);
+                writer.put(',');
+                writer.writeNumber(current->colIndex);
+                writer.put(',');
+                writer.writeDisplayNumber(current->data);
+                writer.put('\n');
+            }
+            continue;
+        }
+
+        // Iterate over each column in this row
+        for (std::size_t j = 1; j <= numCol; ++j) {
+            // If current is not header and it's the correct column, print the data
+            if (current != rowHeaders[i] && current->colIndex == j) { 
+                writer.writeDisplayNumber(current->data);
+                writer.put(' ');
+                current = current->nextCol;  // Move to the next node in the row
+            } else {
+                // Otherwise, print 0 (sparse matrix)
+                writer.write("0 ", 2);
+            }
+        }
+        // Move to the next row after printing all columns in this row
+        writer.put('\n');
+    }
+    writer.flush();
+    out.flush();
+}
+
+// Implementation of addRow method
+template <typename T, typename Index>
+template <typename Emit>
+void SparseMatrix<T, Index>::addRow(const SparseMatrix & a, const SparseMatrix & b, Index i, Emit emit) {
+    Node* aNode = a.rowHeaders[i]->nextCol;
+    Node* bNode = b.rowHeaders[i]->nextCol;
+
+    while (aNode != a.rowHeaders[i] || bNode != b.rowHeaders[i]) {
+        if (bNode == b.rowHeaders[i] || (aNode != a.rowHeaders[i] && aNode->colIndex < bNode->colIndex)) {
+            emit(aNode->data, aNode->colIndex); // Only in a
+            aNode = aNode->nextCol;
+        } else if (aNode == a.rowHeaders[i] || bNode->colIndex < aNode->colIndex) {
+            emit(bNode->data, bNode->colIndex); // Only in b
+            bNode = bNode->nextCol;
+        } else {
+            T sum = checkedAdd(aNode->data, bNode->data); // In both, skip if they cancel out
+            if (sum != 0) {
+                emit(sum, aNode->colIndex);
+            }
+            aNode = aNode->nextCol;
+            bNode = bNode->nextCol;
+        }
+    }
+}
+
+// Implementation of scaleRow method
+template <typename T, typename Index>
+template <typename Emit>
+void SparseMatrix<T, Index>::scaleRow(const SparseMatrix & a, T k, Index i, Emit emit) {
+    for (Node* current = a.rowHeaders[i]->nextCol; current != a.rowHeaders[i]; current = current->nextCol) {
+        T product = checkedMultiply(current->data, k);
+        if (product != 0) {
+            emit(product, current->colIndex);
+        }
+    }
+}
+
+// Implementation of multiplyRow method
+template <typename T, typename Index>
+template <bool TransposeB, typename Emit>
+void SparseMatrix<T, Index>::multiplyRow(const SparseMatrix & a, const SparseMatrix & b, Index i, Accumulator & accumulator, Emit emit) {
+    std::vector<Index> & touchedCols = accumulator.touched;
+    touchedCols.clear();
+
+    // c(i,:) = sum over the non-zeros a(i,k) of a(i,k) * b(k,:)
+    for (Node* aNode = a.rowHeaders[i]->nextCol; aNode != a.rowHeaders[i]; aNode = aNode->nextCol) {
+        // Row k of the operand is either row k of b or, transposed, column k of b
+        Node* bHead = TransposeB ? b.colHeaders[aNode->colIndex] : b.rowHeaders[aNode->colIndex];
+        for (Node* bNode = TransposeB ? bHead->nextRow : bHead->nextCol; bNode != bHead;
+             bNode = TransposeB ? bNode->nextRow : bNode->nextCol) {
+            Index j = TransposeB ? bNode->rowIndex : bNode->colIndex;
+            if (accumulator.lastTouched[j] != i) { // First contribution to column j in this row
+                accumulator.lastTouched[j] = i;
+                accumulator.values[j] = 0;
+                touchedCols.push_back(j);
+            }
+            accumulator.values[j] = checkedAdd(accumulator.values[j], checkedMultiply(aNode->data, bNode->data));
+        }
+    }
+
+    // Emit the row in column order, skipping entries that cancelled out to zero
+    std::sort(touchedCols.begin(), touchedCols.end());
+    for (Index j : touchedCols) {
+        if (accumulator.values[j] != 0) {
+            emit(accumulator.values[j], j);
+        }
+    }
+}
+
+// Implementation of matrixAddition method
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::matrixAddition(const SparseMatrix & a, const SparseMatrix & b) {
+    // Check the size
+    if (a.colLength() != b.colLength() || a.rowLength() != b.rowLength()) {
+        throw std::invalid_argument("Matrices must be equal in size");
+    }
+    SparseMatrix c(a.rowLength(),a.colLength());
+    std::vector<Node*> colTails(c.colHeaders, c.colHeaders + c.numCol + 1);
+
+    // Merge the two sorted row lists of every row
+    for (std::size_t i = 1; i <= c.numRow; i++) {
+        Node* rowTail = c.rowHeaders[i];
+        addRow(a, b, i, [&](T data, Index j) { c.appendNode(data, i, j, rowTail, colTails); });
+    }
+    return c;
+}
+
+// Implementation of multiplyRows method
+template <typename T, typename Index>
+template <bool TransposeB>
+void SparseMatrix<T, Index>::multiplyRows(const SparseMatrix & a, const SparseMatrix & b, SparseMatrix & c) {
+    // Dimensions of the right operand as seen by the product
+    Index bRows = TransposeB ? b.numCol : b.numRow;
+    Index bCols = TransposeB ? b.numRow : b.numCol;
+
+    // Check the size of both matrices
+    if (a.numCol != bRows) {
+        throw std::invalid_argument("Number of col in matrix 'a' must be equal to number of row in matrix 'b'");
+    }
+    // Empty the result matrix, its nodes are recycled for the product
+    c.reshape(a.numRow, bCols);
+    Accumulator accumulator(bCols);
+
+    // Tails of the column lists of c, so results can be appended without searching
+    std::vector<Node*> colTails(c.colHeaders, c.colHeaders + c.numCol + 1);
+
+    for (std::size_t i = 1; i <= a.numRow; i++) {
+        Node* rowTail = c.rowHeaders[i];
+        multiplyRow<TransposeB>(a, b, i, accumulator, [&](T data, Index j) { c.appendNode(data, i, j, rowTail, colTails); });
+    }
+}
+
+// Implementation of matrixMultiplication method
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::matrixMultiplication(const SparseMatrix & a, const SparseMatrix & b){
+    SparseMatrix c;
+    multiplyRows<false>(a, b, c);
+    return c;
+}
+
+// Implementation of matrixMultiplication method with a transposed right operand
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::matrixMultiplication(const SparseMatrix & a, const TransposedView & b){
+    SparseMatrix c;
+    multiplyRows<true>(a, b.base(), c);
+    return c;
+}
+
+// Implementation of multiplyInto method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::multiplyInto(const SparseMatrix & a, const SparseMatrix & b, SparseMatrix & result) {
+    if (&result == &a || &result == &b) {
+        throw std::invalid_argument("The result matrix must not be one of the operands");
+    }
+    multiplyRows<false>(a, b, result);
+}
+
+// Implementation of multiplyInto method with a transposed right operand
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::multiplyInto(const SparseMatrix & a, const TransposedView & b, SparseMatrix & result) {
+    if (&result == &a || &result == &b.base()) {
+        throw std::invalid_argument("The result matrix must not be one of the operands");
+    }
+    multiplyRows<true>(a, b.base(), result);
+}
+
+// Implementation of operator+=
+template <typename T, typename Index>
+SparseMatrix<T, Index> & SparseMatrix<T, Index>::operator+=(const SparseMatrix & b) {
+    // Check the size
+    if (this->numCol != b.numCol || this->numRow != b.numRow) {
+        throw std::invalid_argument("Matrices must be equal in size");
+    }
+    if (&b == this) {
+        return *this *= T(2);
+    }
+
+    // Last node of every column above the current row, after which new nodes of that column are linked
+    std::vector<Node*> colPrev(this->colHeaders, this->colHeaders + this->numCol + 1);
+
+    for (std::size_t i = 1; i <= this->numRow; i++) {
+        Node* rowPrev = this->rowHeaders[i];
+        Node* bNode = b.rowHeaders[i]->nextCol;
+
+        while (bNode != b.rowHeaders[i]) {
+            Node* aNode = rowPrev->nextCol;
+            Index j = bNode->colIndex;
+            if (aNode != this->rowHeaders[i] && aNode->colIndex < j) { // Only in this matrix, keep it
+                colPrev[aNode->colIndex] = aNode;
+                rowPrev = aNode;
+                continue;
+            }
+            if (aNode != this->rowHeaders[i] && aNode->colIndex == j) { // In both, update in place
+                T sum = checkedAdd(aNode->data, bNode->data);
+                if (sum != 0) {
+                    aNode->data = sum;
+                    colPrev[j] = aNode;
+                    rowPrev = aNode;
+                } else { // Cancelled out, unlink from the row and the column
+                    rowPrev->nextCol = aNode->nextCol;
+                    colPrev[j]->nextRow = aNode->nextRow;
+                    this->pool.release(aNode);
+                }
+            } else { // Only in b, link a new node before aNode
+                Node* newNode = this->pool.allocate(bNode->data, i, j);
+                newNode->nextCol = aNode;
+                rowPrev->nextCol = newNode;
+                rowPrev = newNode;
+                newNode->nextRow = colPrev[j]->nextRow;
+                colPrev[j]->nextRow = newNode;
+                colPrev[j] = newNode;
+            }
+            bNode = bNode->nextCol;
+        }
+
+        // The rest of the row is only in this matrix
+        for (Node* aNode = rowPrev->nextCol; aNode != this->rowHeaders[i]; aNode = aNode->nextCol) {
+            colPrev[aNode->colIndex] = aNode;
+        }
+    }
+    if (this->index) {
+        buildIndex(this->index->minLength); // Nodes were linked and unlinked behind the index
+    }
+    return *this;
+}
+
+// Implementation of operator*=
+template <typename T, typename Index>
+SparseMatrix<T, Index> & SparseMatrix<T, Index>::operator*=(T k) {
+    if (k == 0) {
+        reshape(this->numRow, this->numCol); // Every element becomes zero
+        return *this;
+    }
+
+    bool underflow = false;
+    for (std::size_t i = 1; i <= this->numRow; i++) {
+        for (Node* current = this->rowHeaders[i]->nextCol; current != this->rowHeaders[i]; current = current->nextCol) {
+            current->data = checkedMultiply(current->data, k);
+            underflow = underflow || current->data == 0; // Only possible for floating-point values
+        }
+    }
+    if (underflow) {
+        removeZeros();
+    }
+    return *this;
+}
+
+// Implementaion of matrixTransposition method
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::matrixTransposition(const SparseMatrix & a) {
+    //Initialize new matrix
+    SparseMatrix b(a.colLength(), a.rowLength());
+    std::vector<Node*> colTails(b.colHeaders, b.colHeaders + b.numCol + 1);
+
+    // Column j of a, walked top to bottom, is row j of b in column order
+    for (std::size_t j = 1; j <= a.numCol; j++) {
+        Node* rowTail = b.rowHeaders[j];
+        for (Node* current = a.colHeaders[j]->nextRow; current != a.colHeaders[j]; current = current->nextRow) {
+            b.appendNode(current->data, j, current->rowIndex, rowTail, colTails);
+        }
+    }
+
+    return b;
+}
+
+// Implementation of transposedView method
+template <typename T, typename Index>
+TransposedView<T, Index> SparseMatrix<T, Index>::transposedView() const {
+    return TransposedView(*this);
+}
+
+// Implementation of the compressed overloads of the static operations
+template <typename T, typename Index>
+CSRMatrix<T, Index> SparseMatrix<T, Index>::matrixAddition(const CSRMatrix & a, const CSRMatrix & b) {
+    return CSRMatrix(CompressedStorage::add(a.storage, b.storage));
+}
+
+template <typename T, typename Index>
+CSCMatrix<T, Index> SparseMatrix<T, Index>::matrixAddition(const CSCMatrix & a, const CSCMatrix & b) {
+    return CSCMatrix(CompressedStorage::add(a.storage, b.storage));
+}
+
+template <typename T, typename Index>
+CSRMatrix<T, Index> SparseMatrix<T, Index>::matrixMultiplication(const CSRMatrix & a, const CSRMatrix & b) {
+    return CSRMatrix(CompressedStorage::multiply(a.storage, b.storage));
+}
+
+template <typename T, typename Index>
+CSCMatrix<T, Index> SparseMatrix<T, Index>::matrixMultiplication(const CSCMatrix & a, const CSCMatrix & b) {
+    // Column j of a*b is the sum, over the entries b(k,j), of b(k,j) times column k of a
+    if (a.colLength() != b.rowLength()) {
+        throw std::invalid_argument("Number of col in matrix 'a' must be equal to number of row in matrix 'b'");
+    }
+    return CSCMatrix(CompressedStorage::multiply(b.storage, a.storage));
+}
+
+template <typename T, typename Index>
+CSRMatrix<T, Index> SparseMatrix<T, Index>::matrixTransposition(const CSRMatrix & a) {
+    return CSRMatrix(CompressedStorage::transpose(a.storage));
+}
+
+template <typename T, typename Index>
+CSCMatrix<T, Index> SparseMatrix<T, Index>::matrixTransposition(const CSCMatrix & a) {
+    return CSCMatrix(CompressedStorage::transpose(a.storage));
+}
+
+template <typename T, typename Index>
+CSRMatrix<T, Index> SparseMatrix<T, Index>::matrixScalarMultiplication(const CSRMatrix & a, T k) {
+    return CSRMatrix(CompressedStorage::scale(a.storage, k));
+}
+
+template <typename T, typename Index>
+CSCMatrix<T, Index> SparseMatrix<T, Index>::matrixScalarMultiplication(const CSCMatrix & a, T k) {
+    return CSCMatrix(CompressedStorage::scale(a.storage, k));
+}
+
+// Implementation of toCSR method
+template <typename T, typename Index>
+CSRMatrix<T, Index> SparseMatrix<T, Index>::toCSR() const {
+    CSRMatrix csr(this->numRow, this->numCol);
+    CompressedStorage & storage = csr.storage;
+
+    for (std::size_t i = 1; i <= this->numRow; i++) {
+        for (Node* current = this->rowHeaders[i]->nextCol; current != this->rowHeaders[i]; current = current->nextCol) {
+            storage.minorIndex.push_back(current->colIndex);
+            storage.values.push_back(current->data);
+        }
+        storage.majorPtr[i] = storage.values.size();
+    }
+    return csr;
+}
+
+// Implementation of toCSC method
+template <typename T, typename Index>
+CSCMatrix<T, Index> SparseMatrix<T, Index>::toCSC() const {
+    CSCMatrix csc(this->numRow, this->numCol);
+    CompressedStorage & storage = csc.storage;
+
+    for (std::size_t j = 1; j <= this->numCol; j++) {
+        for (Node* current = this->colHeaders[j]->nextRow; current != this->colHeaders[j]; current = current->nextRow) {
+            storage.minorIndex.push_back(current->rowIndex);
+            storage.values.push_back(current->data);
+        }
+        storage.majorPtr[j] = storage.values.size();
+    }
+    return csc;
+}
+
+// Implementation of sortTriplets method
+template <typename T, typename Index>
+std::vector<typename SparseMatrix<T, Index>::Triplet> SparseMatrix<T, Index>::sortTriplets(Index numRow, Index numCol, const std::vector<Triplet> & triplets) {
+    // Count the entries of every column
+    std::vector<std::size_t> colStart(std::size_t(numCol) + 2, 0);
+    for (const Triplet & t : triplets) {
+        colStart[t.colIndex + 1]++;
+    }
+    for (std::size_t j = 1; j <= std::size_t(numCol) + 1; j++) {
+        colStart[j] += colStart[j - 1];
+    }
+
+    // First pass: stable counting sort by column
+    std::vector<Triplet> byCol(triplets.size());
+    for (const Triplet & t : triplets) {
+        byCol[colStart[t.colIndex]++] = t;
+    }
+
+    // Second pass: stable counting sort by row, which leaves every row sorted by column
+    std::vector<std::size_t> rowStart(std::size_t(numRow) + 2, 0);
+    for (const Triplet & t : byCol) {
+        rowStart[t.rowIndex + 1]++;
+    }
+    for (std::size_t i = 1; i <= std::size_t(numRow) + 1; i++) {
+        rowStart[i] += rowStart[i - 1];
+    }
+    std::vector<Triplet> sorted(triplets.size());
+    for (const Triplet & t : byCol) {
+        sorted[rowStart[t.rowIndex]++] = t;
+    }
+    return sorted;
+}
+
+// Implementation of fromTriplets method
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::fromTriplets(Index numRow, Index numCol, const std::vector<Triplet> & triplets) {
+    SparseMatrix m(numRow, numCol);
+
+    // Check the bounds. Zeros are kept, since they delete the entries before them at the same position
+    for (const Triplet & t : triplets) {
+        if (t.rowIndex == 0 || t.rowIndex > numRow || t.colIndex == 0 || t.colIndex > numCol) {
+            throw std::out_of_range("Row or column index is out of bounds");
+        }
+    }
+    std::vector<Triplet> sorted = sortTriplets(numRow, numCol, triplets);
+    std::size_t count = sorted.size();
+
+    // Link the nodes at the tails. Duplicates are adjacent and still in input order, so keep the last one
+    m.pool.reserve(count);
+    std::vector<Node*> colTails(m.colHeaders, m.colHeaders + m.numCol + 1);
+    Node* rowTail = nullptr;
+    Index currentRow = 0;
+    for (std::size_t p = 0; p < count; p++) {
+        const Triplet & t = sorted[p];
+        if (p + 1 < count && sorted[p + 1].rowIndex == t.rowIndex && sorted[p + 1].colIndex == t.colIndex) {
+            continue;
+        }
+        if (t.data == 0) {
+            continue;
+        }
+        if (t.rowIndex != currentRow) {
+            currentRow = t.rowIndex;
+            rowTail = m.rowHeaders[currentRow];
+        }
+        m.appendNode(t.data, t.rowIndex, t.colIndex, rowTail, colTails);
+    }
+    return m;
+}
+
+// Implementation of fromTriplets method for several threads
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::fromTriplets(Index numRow, Index numCol, const std::vector<Triplet> & triplets, ThreadPool & threads) {
+    std::vector<std::pair<const Triplet*, const Triplet*>> parts;
+    std::size_t step = (triplets.size() + threads.size() - 1) / threads.size();
+    for (std::size_t first = 0; first < triplets.size(); first += step) {
+        parts.emplace_back(triplets.data() + first, triplets.data() + std::min(triplets.size(), first + step));
+    }
+    return buildFromTriplets(numRow, numCol, parts, threads);
+}
+
+// Implementation of fromTriplets method for several buffers
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::fromTriplets(Index numRow, Index numCol, const std::vector<std::vector<Triplet>> & buffers, ThreadPool & threads) {
+    std::vector<std::pair<const Triplet*, const Triplet*>> parts;
+    for (const std::vector<Triplet> & buffer : buffers) {
+        if (!buffer.empty()) {
+            parts.emplace_back(buffer.data(), buffer.data() + buffer.size());
+        }
+    }
+    return buildFromTriplets(numRow, numCol, parts, threads);
+}
+
+// Implementation of buildFromTriplets method
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::buildFromTriplets(Index numRow, Index numCol, const std::vector<std::pair<const Triplet*, const Triplet*>> & parts,
+                                                                 ThreadPool & threads) {
+    std::size_t rangeCount = std::max<std::size_t>(1, std::min<std::size_t>(threads.size() * 8, numRow));
+    std::size_t rangeRows = std::max<std::size_t>(1, (std::size_t(numRow) + rangeCount - 1) / rangeCount);
+
+    // Check the bounds and count the entries of every part in every row range
+    std::vector<std::size_t> counts(parts.size() * rangeCount, 0);
+    threads.parallelFor(0, parts.size(), parts.size(), [&](std::size_t first, std::size_t last) {
+        for (std::size_t p = first; p < last; p++) {
+            std::size_t* partCounts = counts.data() + p * rangeCount;
+            for (const Triplet* t = parts[p].first; t != parts[p].second; t++) {
+                if (t->rowIndex == 0 || t->rowIndex > numRow || t->colIndex == 0 || t->colIndex > numCol) {
+                    throw std::out_of_range("Row or column index is out of bounds");
+                }
+                partCounts[(t->rowIndex - 1) / rangeRows]++;
+            }
+        }
+    });
+
+    // Each range takes the entries of the parts in order, so that duplicates keep their input order
+    std::vector<std::size_t> rangeStart(rangeCount + 1, 0);
+    std::vector<std::size_t> offsets(counts.size());
+    std::size_t total = 0;
+    for (std::size_t r = 0; r < rangeCount; r++) {
+        rangeStart[r] = total;
+        for (std::size_t p = 0; p < parts.size(); p++) {
+            offsets[p * rangeCount + r] = total;
+            total += counts[p * rangeCount + r];
+        }
+    }
+    rangeStart[rangeCount] = total;
+
+    // Scatter into uninitialized storage, every slot is written exactly once
+    struct RawDelete {
+        void operator()(Triplet* triplets) const { ::operator delete(triplets); }
+    };
+    std::unique_ptr<Triplet, RawDelete> sorted(static_cast<Triplet*>(::operator new(std::max<std::size_t>(total, 1) * sizeof(Triplet))));
+    threads.parallelFor(0, parts.size(), parts.size(), [&](std::size_t first, std::size_t last) {
+        for (std::size_t p = first; p < last; p++) {
+            std::size_t* partOffsets = offsets.data() + p * rangeCount;
+            for (const Triplet* t = parts[p].first; t != parts[p].second; t++) {
+                new (sorted.get() + partOffsets[(t->rowIndex - 1) / rangeRows]++) Triplet(*t);
+            }
+        }
+    });
+
+    // Sort every range by (row, column) and count the entries of its rows
+    std::vector<std::size_t> rowWork(std::size_t(numRow) + 1, 0);
+    threads.parallelFor(0, rangeCount, rangeCount, [&](std::size_t first, std::size_t last) {
+        for (std::size_t r = first; r < last; r++) {
+            Triplet* begin = sorted.get() + rangeStart[r];
+            Triplet* end = sorted.get() + rangeStart[r + 1];
+            std::stable_sort(begin, end, [](const Triplet & x, const Triplet & y) {
+                return x.rowIndex != y.rowIndex ? x.rowIndex < y.rowIndex : x.colIndex < y.colIndex;
+            });
+            for (const Triplet* t = begin; t != end; t++) {
+                rowWork[t->rowIndex]++;
+            }
+        }
+    });
+
+    // Build the rows; duplicates are adjacent and still in input order, so keep the last one
+    const Triplet* entries = sorted.get();
+    return buildRowsInParallel(numRow, numCol, rowWork, threads, [&](std::size_t first, std::size_t last, RowWriter & writer) {
+        const Triplet* t = std::lower_bound(entries, entries + total, first, [](const Triplet & entry, std::size_t row) {
+            return entry.rowIndex < row;
+        });
+        const Triplet* end = entries + total;
+        Index currentRow = 0;
+        for (; t != end && t->rowIndex < last; t++) {
+            if (t + 1 != end && t[1].rowIndex == t->rowIndex && t[1].colIndex == t->colIndex) {
+                continue;
+            }
+            if (t->data == 0) {
+                continue;
+            }
+            if (t->rowIndex != currentRow) {
+                currentRow = t->rowIndex;
+                writer.beginRow(currentRow);
+            }
+            writer.append(t->data, t->colIndex);
+        }
+    });
+}
+
+// Implementation of fromCSR method
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::fromCSR(const CSRMatrix & csr) {
+    const CompressedStorage & storage = csr.storage;
+    SparseMatrix m(storage.numMajor, storage.numMinor);
+    std::vector<Node*> colTails(m.colHeaders, m.colHeaders + m.numCol + 1);
+
+    // Rows are stored in order, so every node is appended at the tails
+    for (std::size_t i = 1; i <= storage.numMajor; i++) {
+        Node* rowTail = m.rowHeaders[i];
+        for (std::size_t p = storage.majorPtr[i - 1]; p < storage.majorPtr[i]; p++) {
+            m.appendNode(storage.values[p], i, storage.minorIndex[p], rowTail, colTails);
+        }
+    }
+    return m;
+}
+
+// Implementation of fromCSC method
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::fromCSC(const CSCMatrix & csc) {
+    return fromCSR(csc.toCSR());
+}
+
+// Implementation of outputFilePath method
+template <typename T, typename Index>
+std::string SparseMatrix<T, Index>::outputFilePath(const std::string & filePath) {
+     // Find the last '/' or '\' to separate the path from the file name
+    size_t sepPosition = filePath.find_last_of("/\\");
+    std::string path = "";
+    std::string fileName = filePath; //initialize the filename var
+
+    if (sepPosition != std::string::npos) { // If the sepPosition exist
+        path = filePath.substr(0, sepPosition + 1);  // Directory path with trailing separator
+        fileName = filePath.substr(sepPosition + 1); // File name only
+    }
+
+    // Find the position of the file extension (if any)
+    size_t dotPosition = fileName.find_last_of('.');
+    if (dotPosition != std::string::npos) { //if the file has a dot position (extension)
+        fileName.insert(dotPosition, "_output");
+    } else {
+        // If there's no extension, just append _output at the end
+        fileName += "_output";
+    }
+
+    // Combine the path and the modified filename
+    return path + fileName;
+}
+
+// Implementation of matrixScalarMultiplication method
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::matrixScalarMultiplication(const SparseMatrix & a, T k){
+    //Initialize new matrix
+    SparseMatrix b(a.rowLength(),a.colLength());
+    if (k == 0) {
+        return b; // Every element becomes zero
+    }
+    std::vector<Node*> colTails(b.colHeaders, b.colHeaders + b.numCol + 1);
+
+    // Scale the stored nodes in one pass, rows are already in order
+    for (std::size_t i = 1; i <= a.numRow; i++) {
+        Node* rowTail = b.rowHeaders[i];
+        scaleRow(a, k, i, [&](T data, Index j) { b.appendNode(data, i, j, rowTail, colTails); });
+    }
+
+    return b;
+}
+
+// Implementation of rowLengths method
+template <typename T, typename Index>
+std::vector<std::size_t> SparseMatrix<T, Index>::rowLengths(const SparseMatrix & m, ThreadPool & threads) {
+    std::vector<std::size_t> lengths(m.numRow + 1, 0);
+    threads.parallelFor(1, m.numRow + 1, threads.size(), [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            for (Node* current = m.rowHeaders[i]->nextCol; current != m.rowHeaders[i]; current = current->nextCol) {
+                lengths[i]++;
+            }
+        }
+    });
+    return lengths;
+}
+
+// Implementation of buildRowsInParallel method
+template <typename T, typename Index>
+template <typename RowKernel>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::buildRowsInParallel(Index numRow, Index numCol, const std::vector<std::size_t> & rowWork,
+                                               ThreadPool & threads, RowKernel kernel) {
+    SparseMatrix c(numRow, numCol);
+
+    // Cut the rows into ranges of about equal work, counting one extra unit per row for its own overhead
+    std::size_t total = 0;
+    for (std::size_t i = 1; i <= numRow; i++) {
+        total += rowWork[i] + 1;
+    }
+    std::size_t parts = std::max<std::size_t>(1, std::min<std::size_t>(threads.size() * 4, numRow));
+    std::vector<std::size_t> firstRows(1, 1);
+    std::size_t done = 0;
+    for (std::size_t i = 1; i <= numRow && firstRows.size() < parts; i++) {
+        done += rowWork[i] + 1;
+        if (done * parts >= total * firstRows.size()) {
+            firstRows.push_back(i + 1);
+        }
+    }
+    firstRows.push_back(std::size_t(numRow) + 1);
+
+    // Build every range with its own pool
+    std::vector<NodePool> pools(firstRows.size() - 1);
+    for (std::size_t p = 0; p + 1 < firstRows.size(); p++) {
+        threads.submit([&, p]() {
+            RowWriter writer(c, pools[p]);
+            kernel(firstRows[p], firstRows[p + 1], writer);
+        });
+    }
+    threads.wait();
+
+    for (NodePool & pool : pools) {
+        c.pool.adopt(std::move(pool));
+    }
+    c.linkColumns();
+    return c;
+}
+
+// Implementation of linkColumns method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::linkColumns() {
+    std::vector<Node*> colTails(this->colHeaders, this->colHeaders + this->numCol + 1);
+    for (std::size_t i = 1; i <= this->numRow; i++) {
+        for (Node* current = this->rowHeaders[i]->nextCol; current != this->rowHeaders[i]; current = current->nextCol) {
+            colTails[current->colIndex]->nextRow = current;
+            colTails[current->colIndex] = current;
+        }
+    }
+    // Close every circle back to its placeholder
+    for (std::size_t j = 1; j <= this->numCol; j++) {
+        colTails[j]->nextRow = this->colHeaders[j];
+    }
+}
+
+// Implementation of initHeaders method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::initHeaders() {
+    this->pool.reserve(std::size_t(this->numRow) + this->numCol + 1); // All the header and placeholder nodes go in the first slab
+    this->header = this->pool.allocate(0, this->numRow, this->numCol); //Create a Top-Left Header node at 0:0 with row and col numbers stored inside rowIndex, colIndex
+
+    // Assign header to be the first element of rowHeaders and colHeaders arrays
+    this->rowHeaders[0] = this->header;
+    this->colHeaders[0] = this->header;
+
+    // Giving placeholders some dummy values
+    for (std::size_t i = 1; i <= this->numRow; i++) {
+        this->rowHeaders[i] = this->pool.allocate(0, i, 0);  // Placeholder for each row
+        this->rowHeaders[i]->nextCol = this->rowHeaders[i];  // Circular: points back to its placeholder node
+    }
+
+    for (std::size_t j = 1; j <= this->numCol; j++) {
+        this->colHeaders[j] = this->pool.allocate(0, 0, j);  // Placeholder for each column
+        this->colHeaders[j]->nextRow = this->colHeaders[j];  // Circular: points back to itself
+    }
+}
+
+// Implementation of reshape method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::reshape(Index numRow, Index numCol) {
+    // Keep the header arrays when their size does not change
+    if (this->rowHeaders == nullptr || numRow != this->numRow) {
+        Node** rows = new Node*[numRow + 1];
+        delete[] this->rowHeaders;
+        this->rowHeaders = rows;
+    }
+    if (this->colHeaders == nullptr || numCol != this->numCol) {
+        Node** cols = new Node*[numCol + 1];
+        delete[] this->colHeaders;
+        this->colHeaders = cols;
+    }
+    this->numRow = numRow;
+    this->numCol = numCol;
+
+    // The headers are allocated first again, so they land where the previous ones were
+    this->pool.reset();
+    initHeaders();
+    if (this->index) {
+        buildIndex(this->index->minLength); // Every line is empty again
+    }
+}
+
+// Implementation of removeZeros method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::removeZeros() {
+    std::vector<Node*> colPrev(this->colHeaders, this->colHeaders + this->numCol + 1);
+    for (std::size_t i = 1; i <= this->numRow; i++) {
+        Node* rowPrev = this->rowHeaders[i];
+        while (rowPrev->nextCol != this->rowHeaders[i]) {
+            Node* current = rowPrev->nextCol;
+            if (current->data == 0) {
+                rowPrev->nextCol = current->nextCol;
+                colPrev[current->colIndex]->nextRow = current->nextRow;
+                this->pool.release(current);
+            } else {
+                colPrev[current->colIndex] = current;
+                rowPrev = current;
+            }
+        }
+    }
+    if (this->index) {
+        buildIndex(this->index->minLength);
+    }
+}
+
+// Implementation of the parallel matrixAddition method
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::matrixAddition(const SparseMatrix & a, const SparseMatrix & b, ThreadPool & threads) {
+    // Check the size
+    if (a.colLength() != b.colLength() || a.rowLength() != b.rowLength()) {
+        throw std::invalid_argument("Matrices must be equal in size");
+    }
+    std::vector<std::size_t> work = rowLengths(a, threads);
+    std::vector<std::size_t> bLengths = rowLengths(b, threads);
+    for (std::size_t i = 1; i <= a.numRow; i++) {
+        work[i] += bLengths[i];
+    }
+
+    return buildRowsInParallel(a.numRow, a.numCol, work, threads, [&](std::size_t first, std::size_t last, RowWriter & writer) {
+        for (std::size_t i = first; i < last; i++) {
+            writer.beginRow(i);
+            addRow(a, b, i, [&](T data, Index j) { writer.append(data, j); });
+        }
+    });
+}
+
+// Implementation of the parallel matrixMultiplication method
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::matrixMultiplication(const SparseMatrix & a, const SparseMatrix & b, ThreadPool & threads) {
+    // Check the size of both matrices
+    if (a.colLength() != b.rowLength() ) {
+        throw std::invalid_argument("Number of col in matrix 'a' must be equal to number of row in matrix 'b'");
+    }
+
+    // The work of row i is its number of multiply-adds: the lengths of the rows of b it pulls in
+    std::vector<std::size_t> bLengths = rowLengths(b, threads);
+    std::vector<std::size_t> work(a.numRow + 1, 0);
+    threads.parallelFor(1, a.numRow + 1, threads.size(), [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            for (Node* aNode = a.rowHeaders[i]->nextCol; aNode != a.rowHeaders[i]; aNode = aNode->nextCol) {
+                work[i] += bLengths[aNode->colIndex];
+            }
+        }
+    });
+
+    return buildRowsInParallel(a.numRow, b.numCol, work, threads, [&](std::size_t first, std::size_t last, RowWriter & writer) {
+        Accumulator accumulator(b.numCol);
+        for (std::size_t i = first; i < last; i++) {
+            writer.beginRow(i);
+            multiplyRow<false>(a, b, i, accumulator, [&](T data, Index j) { writer.append(data, j); });
+        }
+    });
+}
+
+// Implementation of the parallel matrixScalarMultiplication method
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::matrixScalarMultiplication(const SparseMatrix & a, T k, ThreadPool & threads) {
+    if (k == 0) {
+        return SparseMatrix(a.rowLength(), a.colLength()); // Every element becomes zero
+    }
+    std::vector<std::size_t> work = rowLengths(a, threads);
+
+    return buildRowsInParallel(a.numRow, a.numCol, work, threads, [&](std::size_t first, std::size_t last, RowWriter & writer) {
+        for (std::size_t i = first; i < last; i++) {
+            writer.beginRow(i);
+            scaleRow(a, k, i, [&](T data, Index j) { writer.append(data, j); });
+        }
+    });
+}
+
+// Implementation of multiplyVector method
+template <typename T, typename Index>
+std::vector<T> SparseMatrix<T, Index>::multiplyVector(const std::vector<T> & x) const {
+    if (x.size() != this->numCol) {
+        throw std::invalid_argument("Vector size must be equal to the number of columns");
+    }
+    std::vector<T> y(this->numRow, 0);
+    for (std::size_t i = 1; i <= this->numRow; i++) {
+        T sum = 0;
+        for (Node* current = this->rowHeaders[i]->nextCol; current != this->rowHeaders[i]; current = current->nextCol) {
+            sum = checkedAdd(sum, checkedMultiply(current->data, x[current->colIndex - 1]));
+        }
+        y[i - 1] = sum;
+    }
+    return y;
+}
+
+// Implementation of the parallel multiplyVector method
+template <typename T, typename Index>
+std::vector<T> SparseMatrix<T, Index>::multiplyVector(const std::vector<T> & x, ThreadPool & threads) const {
+    if (x.size() != this->numCol) {
+        throw std::invalid_argument("Vector size must be equal to the number of columns");
+    }
+    std::vector<T> y(this->numRow, 0);
+    threads.parallelFor(1, this->numRow + 1, threads.size() * 4, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            T sum = 0;
+            for (Node* current = this->rowHeaders[i]->nextCol; current != this->rowHeaders[i]; current = current->nextCol) {
+                sum = checkedAdd(sum, checkedMultiply(current->data, x[current->colIndex - 1]));
+            }
+            y[i - 1] = sum;
+        }
+    });
+    return y;
+}
+
+// Implementation of multiplyVectorTransposed method
+template <typename T, typename Index>
+std::vector<T> SparseMatrix<T, Index>::multiplyVectorTransposed(const std::vector<T> & x) const {
+    if (x.size() != this->numRow) {
+        throw std::invalid_argument("Vector size must be equal to the number of rows");
+    }
+    std::vector<T> y(this->numCol, 0);
+    for (std::size_t j = 1; j <= this->numCol; j++) {
+        T sum = 0;
+        for (Node* current = this->colHeaders[j]->nextRow; current != this->colHeaders[j]; current = current->nextRow) {
+            sum = checkedAdd(sum, checkedMultiply(current->data, x[current->rowIndex - 1]));
+        }
+        y[j - 1] = sum;
+    }
+    return y;
+}
+
+// Implementation of the parallel multiplyVectorTransposed method
+template <typename T, typename Index>
+std::vector<T> SparseMatrix<T, Index>::multiplyVectorTransposed(const std::vector<T> & x, ThreadPool & threads) const {
+    if (x.size() != this->numRow) {
+        throw std::invalid_argument("Vector size must be equal to the number of rows");
+    }
+    std::vector<T> y(this->numCol, 0);
+    threads.parallelFor(1, this->numCol + 1, threads.size() * 4, [&](std::size_t first, std::size_t last) {
+        for (std::size_t j = first; j < last; j++) {
+            T sum = 0;
+            for (Node* current = this->colHeaders[j]->nextRow; current != this->colHeaders[j]; current = current->nextRow) {
+                sum = checkedAdd(sum, checkedMultiply(current->data, x[current->rowIndex - 1]));
+            }
+            y[j - 1] = sum;
+        }
+    });
+    return y;
+}
+
+// Implementation of exportToCSV method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::exportToCSV(const std::string & filePath, std::ostream & out) {
+    std::string outputPath = outputFilePath(filePath);
+
+    // Open the file in trunc mode to ensure a new file is created
+    std::ofstream file(outputPath, std::ios::trunc);
+    BufferedWriter writer(file);
+
+    // Walk the stored nodes of each row, never the empty columns
+    for (std::size_t i = 1; i <= numRow; ++i) {
+        for (Node* current = rowHeaders[i]->nextCol; current != rowHeaders[i]; current = current->nextCol) {
+            writer.writeNumber(current->rowIndex);
+            writer.put(',');
+            writer.writeNumber(current->colIndex);
+            writer.put(',');
+            writer.writeNumber(current->data);
+            writer.put('\n');  // New line
+        }
+    }
+    writer.flush();
+    file.close();
+    out << "Data exported successfully to " << "'" << outputPath<< "'" << std::endl;
+}
+
+// Implementation of exportToBinary method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::exportToBinary(const std::string & outputPath) const {
+    std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open the output file!");
+    }
+
+    // Every node of the pool that is not a header or placeholder is an entry of the matrix
+    std::uint64_t nonZeros = this->pool.liveNodes() - (this->numRow + this->numCol + 1);
+    BinaryMatrixFile::Header header = BinaryMatrixFile::makeHeader<T>(this->numRow, this->numCol, nonZeros);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Entries go through a fixed buffer, so the arrays are never held in memory at once
+    const std::size_t BUFFER_BYTES = 1 << 16;
+    std::vector<char> buffer;
+    buffer.reserve(BUFFER_BYTES);
+    auto put = [&](const void* bytes, std::size_t count) {
+        if (buffer.size() + count > BUFFER_BYTES) {
+            file.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+        buffer.insert(buffer.end(), static_cast<const char*>(bytes), static_cast<const char*>(bytes) + count);
+    };
+    auto pad = [&](std::uint64_t bytes) {
+        static const char zeros[8] = {0};
+        put(zeros, BinaryMatrixFile::padded(bytes) - bytes);
+    };
+
+    // Pass 1: row pointers
+    std::uint64_t offset = 0;
+    put(&offset, sizeof(offset));
+    for (std::size_t i = 1; i <= this->numRow; i++) {
+        for (Node* current = this->rowHeaders[i]->nextCol; current != this->rowHeaders[i]; current = current->nextCol) {
+            offset++;
+        }
+        put(&offset, sizeof(offset));
+    }
+
+    // Pass 2: column indices
+    for (std::size_t i = 1; i <= this->numRow; i++) {
+        for (Node* current = this->rowHeaders[i]->nextCol; current != this->rowHeaders[i]; current = current->nextCol) {
+            std::uint32_t colIndex = current->colIndex;
+            put(&colIndex, sizeof(colIndex));
+        }
+    }
+    pad(nonZeros * sizeof(std::uint32_t));
+
+    // Pass 3: values
+    for (std::size_t i = 1; i <= this->numRow; i++) {
+        for (Node* current = this->rowHeaders[i]->nextCol; current != this->rowHeaders[i]; current = current->nextCol) {
+            put(&current->data, sizeof(T));
+        }
+    }
+    pad(nonZeros * sizeof(T));
+
+    file.write(buffer.data(), buffer.size());
+    if (!file) {
+        throw std::runtime_error("Could not write the output file!");
+    }
+}
+
+// Implementation of importMatrixMarket method
+template <typename T, typename Index>
+SparseMatrix<T, Index> SparseMatrix<T, Index>::importMatrixMarket(const std::string & filePath) {
+    MappedFile file(filePath);
+    const char* cursor = file.begin();
+    const char* end = file.end();
+
+    // Returns the next line without its line ending
+    auto nextLine = [&](const char*& lineBegin, const char*& lineEnd) {
+        if (cursor == nullptr || cursor >= end) {
+            return false;
+        }
+        lineBegin = cursor;
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        lineEnd = newline != nullptr ? newline : end;
+        cursor = newline != nullptr ? newline + 1 : end;
+        if (lineEnd > lineBegin && lineEnd[-1] == '\r') {
+            lineEnd--;
+        }
+        return true;
+    };
+    auto skipSpaces = [](const char*& p, const char* lineEnd) {
+        while (p < lineEnd && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+    };
+    auto parseNumber = [&](const char*& p, const char* lineEnd, auto & number) {
+        skipSpaces(p, lineEnd);
+        std::from_chars_result result = std::from_chars(p, lineEnd, number);
+        if (result.ec != std::errc()) {
+            throw std::runtime_error("Malformed Matrix Market entry in " + filePath);
+        }
+        p = result.ptr;
+    };
+
+    // Banner: %%MatrixMarket matrix coordinate <field> <symmetry>, case-insensitive
+    const char* lineBegin;
+    const char* lineEnd;
+    if (!nextLine(lineBegin, lineEnd)) {
+        throw std::runtime_error("Empty Matrix Market file: " + filePath);
+    }
+    std::string banner(lineBegin, lineEnd);
+    std::transform(banner.begin(), banner.end(), banner.begin(), [](unsigned char c) { return std::tolower(c); });
+    std::vector<std::string> words;
+    for (std::size_t p = 0; p < banner.size();) {
+        std::size_t wordEnd = banner.find_first_of(" \t", p);
+        if (wordEnd == std::string::npos) {
+            wordEnd = banner.size();
+        }
+        if (wordEnd > p) {
+            words.push_back(banner.substr(p, wordEnd - p));
+        }
+        p = wordEnd + 1;
+    }
+    if (words.size() != 5 || words[0] != "%%matrixmarket" || words[1] != "matrix" || words[2] != "coordinate") {
+        throw std::runtime_error("Not a Matrix Market coordinate file: " + filePath);
+    }
+    const std::string & field = words[3];
+    const std::string & symmetry = words[4];
+    if (field != "integer" && field != "real" && field != "pattern") {
+        throw std::runtime_error("Unsupported Matrix Market field '" + field + "' in " + filePath);
+    }
+    if (symmetry != "general" && symmetry != "symmetric" && symmetry != "skew-symmetric") {
+        throw std::runtime_error("Unsupported Matrix Market symmetry '" + symmetry + "' in " + filePath);
+    }
+
+    // Size line, after the comments
+    do {
+        if (!nextLine(lineBegin, lineEnd)) {
+            throw std::runtime_error("Missing Matrix Market size line in " + filePath);
+        }
+    } while (lineBegin == lineEnd || *lineBegin == '%');
+    unsigned long long rows = 0, cols = 0, entries = 0;
+    const char* p = lineBegin;
+    parseNumber(p, lineEnd, rows);
+    parseNumber(p, lineEnd, cols);
+    parseNumber(p, lineEnd, entries);
+    if (rows > std::numeric_limits<Index>::max() || cols > std::numeric_limits<Index>::max()) {
+        throw std::runtime_error("Matrix dimensions too large in " + filePath);
+    }
+
+    // Entries, mirrored for the symmetric forms. The buffer is sized from the entry count of the size line, but
+    // never beyond the entry lines the rest of the file can hold ("1 1\n" at least) nor the size of the matrix
+    bool mirrored = symmetry != "general";
+    unsigned long long capacity = std::min<unsigned long long>(entries, static_cast<unsigned long long>(end - cursor) / 4 + 1);
+    capacity = std::min<unsigned long long>(mirrored ? 2 * capacity : capacity, rows * cols);
+    std::vector<Triplet> triplets;
+    triplets.reserve(capacity);
+    unsigned long long read = 0;
+    while (read < entries && nextLine(lineBegin, lineEnd)) {
+        if (lineBegin == lineEnd || *lineBegin == '%') {
+            continue;
+        }
+        unsigned long long rowIndex = 0, colIndex = 0;
+        p = lineBegin;
+        parseNumber(p, lineEnd, rowIndex);
+        parseNumber(p, lineEnd, colIndex);
+        if (rowIndex == 0 || rowIndex > rows || colIndex == 0 || colIndex > cols) {
+            throw std::out_of_range("Row or column index is out of bounds");
+        }
+
+        T data = 1; // pattern matrices only list positions
+        if (field == "integer" || (field == "real" && std::is_floating_point<T>::value)) {
+            parseNumber(p, lineEnd, data);
+        } else if (field == "real") {
+            double number = 0;
+            parseNumber(p, lineEnd, number);
+            if (number != static_cast<double>(static_cast<T>(number))) {
+                throw std::runtime_error("Non-integer value in " + filePath);
+            }
+            data = static_cast<T>(number);
+        }
+
+        if (symmetry == "skew-symmetric" && rowIndex == colIndex) {
+            throw std::runtime_error("Diagonal entry in skew-symmetric Matrix Market file: " + filePath);
+        }
+        triplets.push_back(Triplet(data, rowIndex, colIndex));
+        if (mirrored && rowIndex != colIndex) {
+            triplets.push_back(Triplet(symmetry == "skew-symmetric" ? checkedMultiply(data, T(-1)) : data, colIndex, rowIndex));
+        }
+        read++;
+    }
+    if (read < entries) {
+        throw std::runtime_error("Truncated Matrix Market file: " + filePath);
+    }
+
+    return fromTriplets(rows, cols, triplets);
+}
+
+// Implementation of exportToMatrixMarket method
+template <typename T, typename Index>
+void SparseMatrix<T, Index>::exportToMatrixMarket(const std::string & outputPath, bool symmetric) const {
+    std::size_t entries = 0;
+    if (symmetric) {
+        if (this->numRow != this->numCol) {
+            throw std::invalid_argument("Only square matrices can be symmetric");
+        }
+        // Row i must hold the same entries as column i, and count the lower triangle on the way
+        for (std::size_t i = 1; i <= this->numRow; i++) {
+            Node* rowNode = this->rowHeaders[i]->nextCol;
+            Node* colNode = this->colHeaders[i]->nextRow;
+            while (rowNode != this->rowHeaders[i] && colNode != this->colHeaders[i]) {
+                if (rowNode->colIndex != colNode->rowIndex || rowNode->data != colNode->data) {
+                    throw std::invalid_argument("Matrix is not symmetric");
+                }
+                if (rowNode->colIndex <= i) {
+                    entries++;
+                }
+                rowNode = rowNode->nextCol;
+                colNode = colNode->nextRow;
+            }
+            if (rowNode != this->rowHeaders[i] || colNode != this->colHeaders[i]) {
+                throw std::invalid_argument("Matrix is not symmetric");
+            }
+        }
+    } else {
+        entries = this->pool.liveNodes() - (this->numRow + this->numCol + 1);
+    }
+
+    std::ofstream file(outputPath, std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open the output file!");
+    }
+    file << "%%MatrixMarket matrix coordinate " << ValueTraits<T>::MARKET_FIELD << " " << (symmetric ? "symmetric" : "general") << "\n";
+    file << this->numRow << " " << this->numCol << " " << entries << "\n";
+    BufferedWriter writer(file);
+    for (std::size_t i = 1; i <= this->numRow; i++) {
+        for (Node* current = this->rowHeaders[i]->nextCol; current != this->rowHeaders[i]; current = current->nextCol) {
+            if (symmetric && current->colIndex > i) {
+                break; // Only the lower triangle, and rows are sorted
+            }
+            writer.writeNumber(i);
+            writer.put(' ');
+            writer.writeNumber(current->colIndex);
+            writer.put(' ');
+            writer.writeNumber(current->data);
+            writer.put('\n');
+        }
+    }
+    writer.flush();
+    if (!file) {
+        throw std::runtime_error("Could not write the output file!");
+    }
+}
+
+/*==============================================================================================================*/
+// Implementation of TransposedView rowLength method
+template <typename T, typename Index>
+Index TransposedView<T, Index>::rowLength() const {
+    return this->matrix.colLength();
+}
+
+// Implementation of TransposedView colLength method
+template <typename T, typename Index>
+Index TransposedView<T, Index>::colLength() const {
+    return this->matrix.rowLength();
+}
+
+// Implementation of TransposedView access method
+template <typename T, typename Index>
+T TransposedView<T, Index>::access(Index rowIndex, Index colIndex) const {
+    // Check for out-of-bounds indices
+    if (rowIndex == 0 || rowIndex > this->rowLength() || colIndex == 0 || colIndex > this->colLength()) {
+        throw std::out_of_range("Row or column index is out of bounds");
+    }
+
+    // Row rowIndex of the view is column rowIndex of the matrix
+    Node* head = this->matrix.colHeaders[rowIndex];
+    Node* current = head->nextRow;
+    while (current != head && current->rowIndex < colIndex) {
+        current = current->nextRow;
+    }
+
+    if (current == head || current->rowIndex != colIndex) {
+        return 0;
+    }
+    return current->data;
+}
+
+// Implementation of TransposedView display method
+template <typename T, typename Index>
+void TransposedView<T, Index>::display(DisplayMode mode, std::ostream & out) const {
+    mode = displayModeFor(mode, this->rowLength(), this->colLength());
+    if (mode == DisplayMode::None) {
+        return;
+    }
+    BufferedWriter writer(out);
+
+    for (std::size_t i = 1; i <= this->rowLength(); ++i) {
+        Node* head = this->matrix.colHeaders[i];
+        Node* current = head->nextRow;  // Skip the placeholder and start with the first actual node
+
+        if (mode == DisplayMode::Sparse) {
+            for (; current != head; current = current->nextRow) {
+                writer.writeNumber(i);
+                writer.put(',');
+                writer.writeNumber(current->rowIndex);
+                writer.put(',');
+                writer.writeDisplayNumber(current->data);
+                writer.put('\n');
+            }
+            continue;
+        }
+
+        for (std::size_t j = 1; j <= this->colLength(); ++j) {
+            if (current != head && current->rowIndex == j) {
+                writer.writeDisplayNumber(current->data);
+                writer.put(' ');
+                current = current->nextRow;  // Move down the column of the matrix
+            } else {
+                writer.write("0 ", 2);
+            }
+        }
+        writer.put('\n');
+    }
+    writer.flush();
+    out.flush();
+}
+
+// Implementation of TransposedView materialize method
+template <typename T, typename Index>
+SparseMatrix<T, Index> TransposedView<T, Index>::materialize() const {
+    return SparseMatrix::matrixTransposition(this->matrix);
+}
+
+/*==============================================================================================================*/
+// Implementation of MatrixExpression constructor
+template <typename T, typename Index>
+MatrixExpression<T, Index>::MatrixExpression(const SparseMatrix & matrix) {
+    root = std::make_shared<Term>(Term{Term::OPERAND, matrix.rowLength(), matrix.colLength(), 1, &matrix, false, T(0), nullptr, nullptr});
+}
+
+// Implementation of MatrixExpression makeTerm method
+template <typename T, typename Index>
+std::shared_ptr<const typename MatrixExpression<T, Index>::Term> MatrixExpression<T, Index>::makeTerm(
+    typename Term::Kind kind, Index numRow, Index numCol, T scalar, std::shared_ptr<const Term> left, std::shared_ptr<const Term> right) {
+    std::size_t size = 1 + (left ? left->size : 0) + (right ? right->size : 0);
+    return std::make_shared<Term>(Term{kind, numRow, numCol, size, nullptr, false, scalar, std::move(left), std::move(right)});
+}
+
+// Implementation of MatrixExpression transpose method
+template <typename T, typename Index>
+std::shared_ptr<const typename MatrixExpression<T, Index>::Term> MatrixExpression<T, Index>::transpose(const std::shared_ptr<const Term> & term) {
+    switch (term->kind) {
+        case Term::OPERAND: { // Read the other lists of the matrix
+            Term flipped = *term;
+            flipped.numRow = term->numCol;
+            flipped.numCol = term->numRow;
+            flipped.transposed = !term->transposed;
+            return std::make_shared<Term>(flipped);
+        }
+        case Term::SCALE: // (kX)ᵀ = kXᵀ
+            return makeTerm(Term::SCALE, term->numCol, term->numRow, term->scalar, transpose(term->left), nullptr);
+        case Term::SUM: // (X+Y)ᵀ = Xᵀ+Yᵀ
+            return makeTerm(Term::SUM, term->numCol, term->numRow, T(0), transpose(term->left), transpose(term->right));
+        default: // (XY)ᵀ = YᵀXᵀ
+            return makeTerm(Term::PRODUCT, term->numCol, term->numRow, T(0), transpose(term->right), transpose(term->left));
+    }
+}
+
+// Implementation of MatrixExpression sum method
+template <typename T, typename Index>
+MatrixExpression<T, Index> MatrixExpression<T, Index>::sum(const MatrixExpression & a, const MatrixExpression & b) {
+    if (a.rowLength() != b.rowLength() || a.colLength() != b.colLength()) {
+        throw std::invalid_argument("Matrices must be equal in size");
+    }
+    return MatrixExpression(makeTerm(Term::SUM, a.rowLength(), a.colLength(), T(0), a.root, b.root));
+}
+
+// Implementation of MatrixExpression product method
+template <typename T, typename Index>
+MatrixExpression<T, Index> MatrixExpression<T, Index>::product(const MatrixExpression & a, const MatrixExpression & b) {
+    if (a.colLength() != b.rowLength()) {
+        throw std::invalid_argument("Invalid matrix dimensions for multiplication");
+    }
+    return MatrixExpression(makeTerm(Term::PRODUCT, a.rowLength(), b.colLength(), T(0), a.root, b.root));
+}
+
+// Implementation of MatrixExpression scale method
+template <typename T, typename Index>
+MatrixExpression<T, Index> MatrixExpression<T, Index>::scale(const MatrixExpression & a, T k) {
+    if (a.root->kind == Term::SCALE) { // k(jX) = (kj)X, one pass over the values instead of two
+        return MatrixExpression(makeTerm(Term::SCALE, a.rowLength(), a.colLength(), checkedMultiply(k, a.root->scalar), a.root->left, nullptr));
+    }
+    return MatrixExpression(makeTerm(Term::SCALE, a.rowLength(), a.colLength(), k, a.root, nullptr));
+}
+
+// Implementation of MatrixExpression materializeFactors method
+template <typename T, typename Index>
+std::shared_ptr<const typename MatrixExpression<T, Index>::Term> MatrixExpression<T, Index>::materializeFactors(
+    const std::shared_ptr<const Term> & term, std::deque<SparseMatrix> & factors, ThreadPool * threads) {
+    if (term->kind == Term::OPERAND) {
+        return term;
+    }
+    std::shared_ptr<const Term> left = materializeFactors(term->left, factors, threads);
+    std::shared_ptr<const Term> right = term->right ? materializeFactors(term->right, factors, threads) : nullptr;
+    if (term->kind == Term::PRODUCT && right->kind != Term::OPERAND) { // Evaluate the factor once, read it as an operand
+        MatrixExpression factor(right);
+        factors.push_back(threads != nullptr ? factor.evaluate(*threads) : factor.evaluate());
+        right = MatrixExpression(factors.back()).root;
+    }
+    if (left == term->left && right == term->right) {
+        return term;
+    }
+    return makeTerm(term->kind, term->numRow, term->numCol, term->scalar, std::move(left), std::move(right));
+}
+
+// Implementation of MatrixExpression row method
+template <typename T, typename Index>
+void MatrixExpression<T, Index>::row(const Term & term, std::size_t slot, Index i, Workspace & workspace, std::vector<Entry> & out) {
+    out.clear();
+    switch (term.kind) {
+        case Term::OPERAND: { // Row i of the matrix, or column i when transposed
+            const SparseMatrix & m = *term.matrix;
+            if (!term.transposed) {
+                for (Node* current = m.rowHeaders[i]->nextCol; current != m.rowHeaders[i]; current = current->nextCol) {
+                    out.push_back(Entry(current->colIndex, current->data));
+                }
+            } else {
+                for (Node* current = m.colHeaders[i]->nextRow; current != m.colHeaders[i]; current = current->nextRow) {
+                    out.push_back(Entry(current->rowIndex, current->data));
+                }
+            }
+            return;
+        }
+
+        case Term::SCALE: { // Scale the row of the term in place, dropping floating-point underflows
+            row(*term.left, slot + 1, i, workspace, out);
+            std::size_t kept = 0;
+            for (const Entry & entry : out) {
+                T product = checkedMultiply(entry.second, term.scalar);
+                if (product != 0) {
+                    out[kept++] = Entry(entry.first, product);
+                }
+            }
+            out.resize(kept);
+            return;
+        }
+
+        case Term::SUM: { // Merge the two sorted rows, as matrixAddition does
+            std::vector<Entry> & a = workspace.leftRows[slot];
+            std::vector<Entry> & b = workspace.rightRows[slot];
+            row(*term.left, slot + 1, i, workspace, a);
+            row(*term.right, slot + 1 + term.left->size, i, workspace, b);
+            std::size_t p = 0;
+            std::size_t q = 0;
+            while (p < a.size() || q < b.size()) {
+                if (q == b.size() || (p < a.size() && a[p].first < b[q].first)) {
+                    out.push_back(a[p++]); // Only in a
+                } else if (p == a.size() || b[q].first < a[p].first) {
+                    out.push_back(b[q++]); // Only in b
+                } else {
+                    T sum = checkedAdd(a[p].second, b[q].second); // In both, skip if they cancel out
+                    if (sum != 0) {
+                        out.push_back(Entry(a[p].first, sum));
+                    }
+                    p++;
+                    q++;
+                }
+            }
+            return;
+        }
+
+        case Term::PRODUCT: { // Accumulate a(i,k) * b(k,:) over the row of a, as multiplyRow does
+            std::vector<Entry> & a = workspace.leftRows[slot];
+            std::vector<Entry> & b = workspace.rightRows[slot];
+            typename Workspace::Accumulator & accumulator = workspace.accumulators[slot];
+            if (accumulator.values.empty()) {
+                accumulator.values.assign(std::size_t(term.numCol) + 1, 0);
+                accumulator.stamps.assign(std::size_t(term.numCol) + 1, 0);
+            }
+            std::size_t stamp = ++accumulator.stamp;
+            accumulator.touched.clear();
+            auto accumulate = [&](T aValue, Index j, T bValue) {
+                if (accumulator.stamps[j] != stamp) { // First contribution to column j in this row
+                    accumulator.stamps[j] = stamp;
+                    accumulator.values[j] = 0;
+                    accumulator.touched.push_back(j);
+                }
+                accumulator.values[j] = checkedAdd(accumulator.values[j], checkedMultiply(aValue, bValue));
+            };
+
+            row(*term.left, slot + 1, i, workspace, a);
+            const Term & right = *term.right;
+            for (const Entry & entry : a) {
+                if (right.kind == Term::OPERAND && !right.transposed) { // Walk row k of the operand directly
+                    const SparseMatrix & m = *right.matrix;
+                    for (Node* bNode = m.rowHeaders[entry.first]->nextCol; bNode != m.rowHeaders[entry.first]; bNode = bNode->nextCol) {
+                        accumulate(entry.second, bNode->colIndex, bNode->data);
+                    }
+                } else { // Column k of a transposed operand; materializeFactors leaves no other kind here
+                    row(right, slot + 1 + term.left->size, entry.first, workspace, b);
+                    for (const Entry & bEntry : b) {
+                        accumulate(entry.second, bEntry.first, bEntry.second);
+                    }
+                }
+            }
+
+            // Emit the row in column order, skipping entries that cancelled out to zero
+            std::sort(accumulator.touched.begin(), accumulator.touched.end());
+            for (Index j : accumulator.touched) {
+                if (accumulator.values[j] != 0) {
+                    out.push_back(Entry(j, accumulator.values[j]));
+                }
+            }
+            return;
+        }
+    }
+}
+
+// Implementation of MatrixExpression evaluate method
+template <typename T, typename Index>
+SparseMatrix<T, Index> MatrixExpression<T, Index>::evaluate() const {
+    SparseMatrix c(rowLength(), colLength());
+    evaluateRows([](Index, const std::vector<Entry> &) {}, &c);
+    return c;
+}
+
+// Implementation of MatrixExpression evaluateRows method
+template <typename T, typename Index>
+template <typename Consume>
+void MatrixExpression<T, Index>::evaluateRows(Consume consume, SparseMatrix * result) const {
+    if (result != nullptr && (result->numRow != rowLength() || result->numCol != colLength())) {
+        throw std::invalid_argument("The result matrix does not have the dimensions of the expression");
+    }
+    std::vector<Node*> colTails;
+    if (result != nullptr) {
+        colTails.assign(result->colHeaders, result->colHeaders + result->numCol + 1);
+    }
+    std::deque<SparseMatrix> factors;
+    std::shared_ptr<const Term> prepared = materializeFactors(root, factors, nullptr);
+    Workspace workspace(prepared->size);
+    std::vector<Entry> entries;
+    for (std::size_t i = 1; i <= rowLength(); i++) {
+        row(*prepared, 0, i, workspace, entries);
+        if (result != nullptr) {
+            Node* rowTail = result->rowHeaders[i];
+            for (const Entry & entry : entries) {
+                result->appendNode(entry.second, i, entry.first, rowTail, colTails);
+            }
+        }
+        consume(static_cast<Index>(i), static_cast<const std::vector<Entry> &>(entries));
+    }
+}
+
+// Implementation of MatrixExpression evaluate method, on a thread pool
+template <typename T, typename Index>
+SparseMatrix<T, Index> MatrixExpression<T, Index>::evaluate(ThreadPool & threads) const {
+    std::deque<SparseMatrix> factors;
+    std::shared_ptr<const Term> prepared = materializeFactors(root, factors, &threads);
+    std::vector<std::size_t> work(std::size_t(rowLength()) + 1, 1); // The cost of a row is not known in advance
+    return SparseMatrix::buildRowsInParallel(rowLength(), colLength(), work, threads,
+                                             [&](std::size_t first, std::size_t last, typename SparseMatrix::RowWriter & writer) {
+        Workspace workspace(prepared->size);
+        std::vector<Entry> entries;
+        for (std::size_t i = first; i < last; i++) {
+            row(*prepared, 0, i, workspace, entries);
+            writer.beginRow(i);
+            for (const Entry & entry : entries) {
+                writer.append(entry.second, entry.first);
+            }
+        }
+    });
+}
+
+/**
+ * @struct MatrixExpression::ParsedValue
+ * @brief The value of a subexpression while parsing: a number, or a matrix expression.
+ */
+template <typename T, typename Index>
+struct MatrixExpression<T, Index>::ParsedValue {
+    bool isScalar;
+    T scalar;
+    MatrixExpression expression;
+};
+
+/**
+ * @brief The message for an unexpected character of an expression, quoting the whole UTF-8 sequence that
+ * starts at `p` rather than its first byte.
+ */
+static std::string unexpectedCharacter(const char* p, const char* end) {
+    unsigned char lead = static_cast<unsigned char>(*p);
+    std::size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+    length = std::min<std::size_t>(length, end - p);
+    return "Unexpected '" + std::string(p, length) + "' in expression (operators are + - * ( ), and ' or ^T to transpose)";
+}
+
+// Implementation of MatrixExpression parse method
+template <typename T, typename Index>
+MatrixExpression<T, Index> MatrixExpression<T, Index>::parse(const std::string & text, const std::vector<const SparseMatrix*> & operands) {
+    const char* p = text.data();
+    const char* end = text.data() + text.size();
+    ParsedValue value = parseSum(p, end, operands);
+    while (p < end && std::isspace(static_cast<unsigned char>(*p))) {
+        p++;
+    }
+    if (p != end) {
+        throw std::invalid_argument(unexpectedCharacter(p, end));
+    }
+    if (value.isScalar) {
+        throw std::invalid_argument("The expression must denote a matrix");
+    }
+    return value.expression;
+}
+
+// Implementation of MatrixExpression parseSum method: product (('+' | '-') product)*
+template <typename T, typename Index>
+typename MatrixExpression<T, Index>::ParsedValue MatrixExpression<T, Index>::parseSum(
+    const char*& p, const char* end, const std::vector<const SparseMatrix*> & operands) {
+    ParsedValue value = parseProduct(p, end, operands);
+    while (true) {
+        while (p < end && std::isspace(static_cast<unsigned char>(*p))) {
+            p++;
+        }
+        if (p == end || (*p != '+' && *p != '-')) {
+            return value;
+        }
+        char op = *p++;
+        ParsedValue next = parseProduct(p, end, operands);
+        if (value.isScalar != next.isScalar) {
+            throw std::invalid_argument("Cannot add a number to a matrix");
+        }
+        if (value.isScalar) {
+            value.scalar = op == '+' ? checkedAdd(value.scalar, next.scalar) : checkedAdd(value.scalar, checkedMultiply(T(-1), next.scalar));
+        } else {
+            value.expression = op == '+' ? value.expression + next.expression : value.expression - next.expression;
+        }
+    }
+}
+
+// Implementation of MatrixExpression parseProduct method: factor ('*' factor)*
+template <typename T, typename Index>
+typename MatrixExpression<T, Index>::ParsedValue MatrixExpression<T, Index>::parseProduct(
+    const char*& p, const char* end, const std::vector<const SparseMatrix*> & operands) {
+    ParsedValue value = parseFactor(p, end, operands);
+    while (true) {
+        while (p < end && std::isspace(static_cast<unsigned char>(*p))) {
+            p++;
+        }
+        if (p == end || *p != '*') {
+            return value;
+        }
+        p++;
+        ParsedValue next = parseFactor(p, end, operands);
+        if (value.isScalar && next.isScalar) {
+            value.scalar = checkedMultiply(value.scalar, next.scalar);
+        } else if (value.isScalar) {
+            value = ParsedValue{false, T(0), value.scalar * next.expression};
+        } else if (next.isScalar) {
+            value.expression = value.expression * next.scalar;
+        } else {
+            value.expression = value.expression * next.expression;
+        }
+    }
+}
+
+// Implementation of MatrixExpression parseFactor method: ['-'] (number | letter | '(' sum ')') ("'" | "^T" | "ᵀ")*
+template <typename T, typename Index>
+typename MatrixExpression<T, Index>::ParsedValue MatrixExpression<T, Index>::parseFactor(
+    const char*& p, const char* end, const std::vector<const SparseMatrix*> & operands) {
+    while (p < end && std::isspace(static_cast<unsigned char>(*p))) {
+        p++;
+    }
+    if (p == end) {
+        throw std::invalid_argument("Unexpected end of expression");
+    }
+
+    ParsedValue value{true, T(0), MatrixExpression()};
+    if (*p == '-') { // Unary minus
+        p++;
+        value = parseFactor(p, end, operands);
+        if (value.isScalar) {
+            value.scalar = checkedMultiply(T(-1), value.scalar);
+        } else {
+            value.expression = T(-1) * value.expression;
+        }
+        return value;
+    }
+    if (*p == '(') {
+        p++;
+        value = parseSum(p, end, operands);
+        while (p < end && std::isspace(static_cast<unsigned char>(*p))) {
+            p++;
+        }
+        if (p == end || *p != ')') {
+            throw std::invalid_argument("Missing ')' in expression");
+        }
+        p++;
+    } else if (*p >= 'A' && *p <= 'Z') {
+        std::size_t operand = *p - 'A';
+        if (operand >= operands.size()) {
+            throw std::invalid_argument("Expression uses matrix " + std::string(1, *p) + ", which is not given");
+        }
+        value = ParsedValue{false, T(0), MatrixExpression(*operands[operand])};
+        p++;
+    } else {
+        std::from_chars_result result = std::from_chars(p, end, value.scalar);
+        if (result.ec != std::errc()) {
+            throw std::invalid_argument(unexpectedCharacter(p, end));
+        }
+        p = result.ptr;
+    }
+
+    // Postfix transposes, which leave numbers unchanged
+    while (true) {
+        while (p < end && std::isspace(static_cast<unsigned char>(*p))) {
+            p++;
+        }
+        if (p < end && *p == '\'') {
+            p++;
+        } else if (p + 1 < end && p[0] == '^' && p[1] == 'T') {
+            p += 2;
+        } else if (end - p >= 3 && std::memcmp(p, "\xE1\xB5\x80", 3) == 0) { // ᵀ in UTF-8
+            p += 3;
+        } else {
+            return value;
+        }
+        if (!value.isScalar) {
+            value.expression = value.expression.transposed();
+        }
+    }
+}
+
+// Implementation of CompressedStorage memoryUsage method
+template <typename T, typename Index>
+std::size_t CompressedStorage<T, Index>::memoryUsage() const {
+    return majorPtr.capacity() * sizeof(std::size_t) + minorIndex.capacity() * sizeof(Index)
+         + values.capacity() * sizeof(T);
+}
+
+// Implementation of CompressedStorage find method
+template <typename T, typename Index>
+T CompressedStorage<T, Index>::find(Index major, Index minor) const {
+    auto first = minorIndex.begin() + majorPtr[major - 1];
+    auto last = minorIndex.begin() + majorPtr[major];
+    auto position = std::lower_bound(first, last, minor);
+    if (position == last || *position != minor) {
+        return 0;
+    }
+    return values[position - minorIndex.begin()];
+}
+
+// Implementation of CompressedStorage add method
+template <typename T, typename Index>
+CompressedStorage<T, Index> CompressedStorage<T, Index>::add(const CompressedStorage & a, const CompressedStorage & b) {
+    if (a.numMajor != b.numMajor || a.numMinor != b.numMinor) {
+        throw std::invalid_argument("Matrices must be equal in size");
+    }
+    CompressedStorage c(a.numMajor, a.numMinor);
+    c.minorIndex.reserve(a.nonZeros() + b.nonZeros());
+    c.values.reserve(a.nonZeros() + b.nonZeros());
+
+    for (std::size_t m = 1; m <= a.numMajor; m++) {
+        std::size_t p = a.majorPtr[m - 1], pEnd = a.majorPtr[m];
+        std::size_t q = b.majorPtr[m - 1], qEnd = b.majorPtr[m];
+
+        // Merge the two sorted lines
+        while (p < pEnd || q < qEnd) {
+            if (q == qEnd || (p < pEnd && a.minorIndex[p] < b.minorIndex[q])) {
+                c.minorIndex.push_back(a.minorIndex[p]);
+                c.values.push_back(a.values[p++]);
+            } else if (p == pEnd || b.minorIndex[q] < a.minorIndex[p]) {
+                c.minorIndex.push_back(b.minorIndex[q]);
+                c.values.push_back(b.values[q++]);
+            } else {
+                T sum = checkedAdd(a.values[p], b.values[q]);
+                if (sum != 0) {
+                    c.minorIndex.push_back(a.minorIndex[p]);
+                    c.values.push_back(sum);
+                }
+                p++;
+                q++;
+            }
+        }
+        c.majorPtr[m] = c.values.size();
+    }
+    return c;
+}
+
+// Implementation of CompressedStorage scale method
+template <typename T, typename Index>
+CompressedStorage<T, Index> CompressedStorage<T, Index>::scale(const CompressedStorage & a, T k) {
+    CompressedStorage c(a.numMajor, a.numMinor);
+    if (k == 0) {
+        return c; // Every element becomes zero
+    }
+    c.minorIndex.reserve(a.nonZeros());
+    c.values.reserve(a.nonZeros());
+
+    for (std::size_t m = 1; m <= a.numMajor; m++) {
+        for (std::size_t p = a.majorPtr[m - 1]; p < a.majorPtr[m]; p++) {
+            T product = checkedMultiply(a.values[p], k);
+            if (product != 0) {
+                c.minorIndex.push_back(a.minorIndex[p]);
+                c.values.push_back(product);
+            }
+        }
+        c.majorPtr[m] = c.values.size();
+    }
+    return c;
+}
+
+// Implementation of CompressedStorage multiply method
+template <typename T, typename Index>
+CompressedStorage<T, Index> CompressedStorage<T, Index>::multiply(const CompressedStorage & x, const CompressedStorage & y) {
+    if (x.numMinor != y.numMajor) {
+        throw std::invalid_argument("Number of col in matrix 'a' must be equal to number of row in matrix 'b'");
+    }
+    CompressedStorage c(x.numMajor, y.numMinor);
+
+    // Sparse accumulator: partial sums per minor index, and the line that last touched each of them
+    std::vector<T> accumulator(y.numMinor + 1, 0);
+    std::vector<Index> lastTouched(y.numMinor + 1, 0);
+    std::vector<Index> touched;
+
+    for (std::size_t i = 1; i <= x.numMajor; i++) {
+        touched.clear();
+        for (std::size_t p = x.majorPtr[i - 1]; p < x.majorPtr[i]; p++) {
+            Index k = x.minorIndex[p];
+            T xValue = x.values[p];
+            for (std::size_t q = y.majorPtr[k - 1]; q < y.majorPtr[k]; q++) {
+                Index j = y.minorIndex[q];
+                if (lastTouched[j] != i) { // First contribution to j in this line
+                    lastTouched[j] = i;
+                    accumulator[j] = 0;
+                    touched.push_back(j);
+                }
+                accumulator[j] = checkedAdd(accumulator[j], checkedMultiply(xValue, y.values[q]));
+            }
+        }
+
+        // Emit the line in minor order, skipping entries that cancelled out to zero
+        std::sort(touched.begin(), touched.end());
+        for (Index j : touched) {
+            if (accumulator[j] != 0) {
+                c.minorIndex.push_back(j);
+                c.values.push_back(accumulator[j]);
+            }
+        }
+        c.majorPtr[i] = c.values.size();
+    }
+    return c;
+}
+
+// Implementation of CompressedStorage transpose method
+template <typename T, typename Index>
+CompressedStorage<T, Index> CompressedStorage<T, Index>::transpose(const CompressedStorage & a) {
+    CompressedStorage t(a.numMinor, a.numMajor);
+    t.minorIndex.resize(a.nonZeros());
+    t.values.resize(a.nonZeros());
+
+    // Count the entries of every minor line, then turn the counts into start offsets
+    for (Index minor : a.minorIndex) {
+        t.majorPtr[minor]++;
+    }
+    for (std::size_t m = 1; m <= t.numMajor; m++) {
+        t.majorPtr[m] += t.majorPtr[m - 1];
+    }
+
+    // Scatter in major order, so every new line comes out sorted
+    std::vector<std::size_t> next(t.majorPtr.begin(), t.majorPtr.end() - 1);
+    for (std::size_t m = 1; m <= a.numMajor; m++) {
+        for (std::size_t p = a.majorPtr[m - 1]; p < a.majorPtr[m]; p++) {
+            std::size_t target = next[a.minorIndex[p] - 1]++;
+            t.minorIndex[target] = m;
+            t.values[target] = a.values[p];
+        }
+    }
+    return t;
+}
+
+// SpMV kernels over major lines [firstMajor, lastMajor) of compressed storage, selected by multiplyVectorLines
+template <typename T, typename Index>
+static void multiplyVectorLinesScalar(const CompressedStorage<T, Index> & a, const T* x, T* y, std::size_t firstMajor, std::size_t lastMajor) {
+    const Index* minorIndex = a.minorIndex.data();
+    const T* values = a.values.data();
+    for (std::size_t m = firstMajor; m < lastMajor; m++) {
+        T sum = 0;
+        for (std::size_t p = a.majorPtr[m - 1]; p < a.majorPtr[m]; p++) {
+            sum = checkedAdd(sum, checkedMultiply(values[p], x[minorIndex[p] - 1]));
+        }
+        y[m - 1] = sum;
+    }
+}
+
+#ifdef SPARSE_MATRIX_X86_SIMD
+// The SIMD kernels multiply in 64 bits, so no product wraps, and also add up the magnitudes of the products;
+// the sums are kept unsigned so that adding up large products is defined before they are checked.
+// While every product stays below 2^31 in magnitude and so does their total, no partial sum in any order can
+// overflow and the 64-bit sum is the result; otherwise the line is redone by the checked scalar kernel, which
+// then throws exactly where it would have on its own.
+static inline void finishVectorLine(const CompressedStorage<std::int32_t, std::uint32_t> & a, const std::int32_t* x, std::int32_t* y,
+                                    std::size_t m, std::uint64_t sum, std::uint64_t magnitude, std::uint64_t largest) {
+    if ((largest >> 31) != 0 || magnitude > std::uint64_t(INT32_MAX)) {
+        multiplyVectorLinesScalar(a, x, y, m, m + 1);
+        return;
+    }
+    y[m - 1] = static_cast<std::int32_t>(static_cast<std::int64_t>(sum));
+}
+
+__attribute__((target("avx2")))
+static void multiplyVectorLinesAVX2(const CompressedStorage<std::int32_t, std::uint32_t> & a, const std::int32_t* x, std::int32_t* y,
+                                    std::size_t firstMajor, std::size_t lastMajor) {
+    const std::uint32_t* minorIndex = a.minorIndex.data();
+    const std::int32_t* values = a.values.data();
+    const __m256i one = _mm256_set1_epi32(1);
+    for (std::size_t m = firstMajor; m < lastMajor; m++) {
+        std::size_t p = a.majorPtr[m - 1];
+        std::size_t end = a.majorPtr[m];
+        __m256i sums = _mm256_setzero_si256();        // 4 signed 64-bit sums
+        __m256i magnitudes = _mm256_setzero_si256();  // 4 sums of |product|
+        __m256i largest = _mm256_setzero_si256();     // The bits of every |product|, or-ed together
+
+        // 8 entries at a time: gather x at the (1-based) indices, then multiply the even and the odd lanes
+        for (; p + 8 <= end; p += 8) {
+            __m256i index = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(minorIndex + p)), one);
+            __m256i gathered = _mm256_i32gather_epi32(x, index, 4);
+            __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + p));
+            sums = _mm256_add_epi64(sums, _mm256_mul_epi32(value, gathered));
+            sums = _mm256_add_epi64(sums, _mm256_mul_epi32(_mm256_srli_epi64(value, 32), _mm256_srli_epi64(gathered, 32)));
+            __m256i absValue = _mm256_abs_epi32(value);
+            __m256i absGathered = _mm256_abs_epi32(gathered);
+            __m256i even = _mm256_mul_epu32(absValue, absGathered);
+            __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(absValue, 32), _mm256_srli_epi64(absGathered, 32));
+            magnitudes = _mm256_add_epi64(magnitudes, _mm256_add_epi64(even, odd));
+            largest = _mm256_or_si256(largest, _mm256_or_si256(even, odd));
+        }
+
+        // Horizontal sums of the 4 lanes, then the remaining entries
+        alignas(32) std::int64_t sumLanes[4];
+        alignas(32) std::uint64_t magnitudeLanes[4];
+        alignas(32) std::uint64_t largestLanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sumLanes), sums);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(magnitudeLanes), magnitudes);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(largestLanes), largest);
+        std::uint64_t sum = std::uint64_t(sumLanes[0]) + std::uint64_t(sumLanes[1]) + std::uint64_t(sumLanes[2]) + std::uint64_t(sumLanes[3]);
+        std::uint64_t magnitude = magnitudeLanes[0] + magnitudeLanes[1] + magnitudeLanes[2] + magnitudeLanes[3];
+        std::uint64_t largestBits = largestLanes[0] | largestLanes[1] | largestLanes[2] | largestLanes[3];
+        for (; p < end; p++) {
+            std::int64_t product = std::int64_t(values[p]) * x[minorIndex[p] - 1];
+            std::uint64_t size = product < 0 ? 0 - std::uint64_t(product) : std::uint64_t(product);
+            sum += std::uint64_t(product);
+            magnitude += size;
+            largestBits |= size;
+        }
+        finishVectorLine(a, x, y, m, sum, magnitude, largestBits);
+    }
+}
+
+// Adds the 64-bit products of 16 pairs of int32, and their magnitudes, to the 8 lanes of the sums. The maskz
+// forms with every lane kept are the plain instructions, without the false -Wmaybe-uninitialized of GCC 12
+__attribute__((target("avx512f")))
+static inline void accumulateProducts(__m512i value, __m512i gathered, __m512i & sums, __m512i & magnitudes, __m512i & largest) {
+    const __mmask8 all = 0xFF;
+    __m512i oddValue = _mm512_maskz_srli_epi64(all, value, 32);
+    __m512i oddGathered = _mm512_maskz_srli_epi64(all, gathered, 32);
+    sums = _mm512_add_epi64(sums, _mm512_maskz_mul_epi32(all, value, gathered));
+    sums = _mm512_add_epi64(sums, _mm512_maskz_mul_epi32(all, oddValue, oddGathered));
+    __m512i absValue = _mm512_maskz_abs_epi32(0xFFFF, value);
+    __m512i absGathered = _mm512_maskz_abs_epi32(0xFFFF, gathered);
+    __m512i even = _mm512_maskz_mul_epu32(all, absValue, absGathered);
+    __m512i odd = _mm512_maskz_mul_epu32(all, _mm512_maskz_srli_epi64(all, absValue, 32), _mm512_maskz_srli_epi64(all, absGathered, 32));
+    magnitudes = _mm512_add_epi64(magnitudes, _mm512_add_epi64(even, odd));
+    largest = _mm512_or_si512(largest, _mm512_or_si512(even, odd));
+}
+
+__attribute__((target("avx512f")))
+static void multiplyVectorLinesAVX512(const CompressedStorage<std::int32_t, std::uint32_t> & a, const std::int32_t* x, std::int32_t* y,
+                                      std::size_t firstMajor, std::size_t lastMajor) {
+    const std::uint32_t* minorIndex = a.minorIndex.data();
+    const std::int32_t* values = a.values.data();
+    const __m512i one = _mm512_set1_epi32(1);
+    for (std::size_t m = firstMajor; m < lastMajor; m++) {
+        std::size_t p = a.majorPtr[m - 1];
+        std::size_t end = a.majorPtr[m];
+        __m512i sums = _mm512_setzero_si512();        // 8 signed 64-bit sums
+        __m512i magnitudes = _mm512_setzero_si512();  // 8 sums of |product|
+        __m512i largest = _mm512_setzero_si512();     // The bits of every |product|, or-ed together
+
+        // 16 entries at a time, then one masked step for the remainder, whose lanes past the end are zeros
+        for (; p + 16 <= end; p += 16) {
+            __m512i index = _mm512_sub_epi32(_mm512_loadu_si512(minorIndex + p), one);
+            __m512i gathered = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, index, x, 4);
+            accumulateProducts(_mm512_loadu_si512(values + p), gathered, sums, magnitudes, largest);
+        }
+        if (p < end) {
+            __mmask16 mask = static_cast<__mmask16>((1u << (end - p)) - 1);
+            __m512i index = _mm512_sub_epi32(_mm512_maskz_loadu_epi32(mask, minorIndex + p), one);
+            __m512i gathered = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), mask, index, x, 4);
+            accumulateProducts(_mm512_maskz_loadu_epi32(mask, values + p), gathered, sums, magnitudes, largest);
+        }
+        // Horizontal sums of the 8 lanes
+        alignas(64) std::int64_t sumLanes[8];
+        alignas(64) std::uint64_t magnitudeLanes[8];
+        alignas(64) std::uint64_t largestLanes[8];
+        _mm512_store_si512(sumLanes, sums);
+        _mm512_store_si512(magnitudeLanes, magnitudes);
+        _mm512_store_si512(largestLanes, largest);
+        std::uint64_t sum = 0;
+        std::uint64_t magnitude = 0;
+        std::uint64_t largestBits = 0;
+        for (int lane = 0; lane < 8; lane++) {
+            sum += std::uint64_t(sumLanes[lane]);
+            magnitude += magnitudeLanes[lane];
+            largestBits |= largestLanes[lane];
+        }
+        finishVectorLine(a, x, y, m, sum, magnitude, largestBits);
+    }
+}
+#endif
+
+typedef void (*VectorLinesKernel)(const CompressedStorage<std::int32_t, std::uint32_t> &, const std::int32_t*, std::int32_t*, std::size_t, std::size_t);
+
+// Picks the widest int32 SpMV kernel the CPU supports, with its name
+static std::pair<VectorLinesKernel, const char*> selectVectorKernel() {
+#ifdef SPARSE_MATRIX_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return std::make_pair(&multiplyVectorLinesAVX512, "avx512");
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return std::make_pair(&multiplyVectorLinesAVX2, "avx2");
+    }
+#endif
+    return std::make_pair(&multiplyVectorLinesScalar<std::int32_t, std::uint32_t>, "scalar");
+}
+
+// Implementation of CompressedStorage multiplyVectorLines method
+template <typename T, typename Index>
+void CompressedStorage<T, Index>::multiplyVectorLines(const CompressedStorage & a, const T* x, T* y, std::size_t firstMajor, std::size_t lastMajor) {
+    if constexpr (std::is_same<T, std::int32_t>::value && std::is_same<Index, std::uint32_t>::value) {
+        static const std::pair<VectorLinesKernel, const char*> kernel = selectVectorKernel();
+        kernel.first(a, x, y, firstMajor, lastMajor);
+    } else {
+        multiplyVectorLinesScalar(a, x, y, firstMajor, lastMajor);
+    }
+}
+
+// Implementation of CompressedStorage vectorKernelName method
+template <typename T, typename Index>
+const char* CompressedStorage<T, Index>::vectorKernelName() {
+    if constexpr (std::is_same<T, std::int32_t>::value && std::is_same<Index, std::uint32_t>::value) {
+        static const std::pair<VectorLinesKernel, const char*> kernel = selectVectorKernel();
+        return kernel.second;
+    } else {
+        return "scalar";
+    }
+}
+
+// Implementation of CompressedStorage scatterVectorLines method
+template <typename T, typename Index>
+void CompressedStorage<T, Index>::scatterVectorLines(const CompressedStorage & a, const T* x, T* y, std::size_t firstMajor, std::size_t lastMajor) {
+    for (std::size_t m = firstMajor; m < lastMajor; m++) {
+        T scale = x[m - 1];
+        if (scale == 0) {
+            continue;
+        }
+        for (std::size_t p = a.majorPtr[m - 1]; p < a.majorPtr[m]; p++) {
+            y[a.minorIndex[p] - 1] = checkedAdd(y[a.minorIndex[p] - 1], checkedMultiply(a.values[p], scale));
+        }
+    }
+}
+
+// Implementation of CSRMatrix access method
+template <typename T, typename Index>
+T CSRMatrix<T, Index>::access(Index rowIndex, Index colIndex) const {
+    // Check for out-of-bounds indices
+    if (rowIndex == 0 || rowIndex > this->rowLength() || colIndex == 0 || colIndex > this->colLength()) {
+        throw std::out_of_range("Row or column index is out of bounds");
+    }
+    return this->storage.find(rowIndex, colIndex);
+}
+
+// Implementation of CSRMatrix toCSC method
+template <typename T, typename Index>
+CSCMatrix<T, Index> CSRMatrix<T, Index>::toCSC() const {
+    return CSCMatrix(CompressedStorage::transpose(this->storage));
+}
+
+// Implementation of CSRMatrix exportToCSV method
+template <typename T, typename Index>
+void CSRMatrix<T, Index>::exportToCSV(const std::string & filePath, std::ostream & out) const {
+    std::string outputPath = SparseMatrix<T, Index>::outputFilePath(filePath);
+
+    // Open the file in trunc mode to ensure a new file is created
+    std::ofstream file(outputPath, std::ios::trunc);
+    BufferedWriter writer(file);
+
+    for (std::size_t i = 1; i <= this->storage.numMajor; i++) {
+        for (std::size_t p = this->storage.majorPtr[i - 1]; p < this->storage.majorPtr[i]; p++) {
+            writer.writeNumber(i);
+            writer.put(',');
+            writer.writeNumber(this->storage.minorIndex[p]);
+            writer.put(',');
+            writer.writeNumber(this->storage.values[p]);
+            writer.put('\n');
+        }
+    }
+    writer.flush();
+    file.close();
+    out << "Data exported successfully to " << "'" << outputPath<< "'" << std::endl;
+}
+
+// Implementation of CSRMatrix exportToBinary method
+template <typename T, typename Index>
+void CSRMatrix<T, Index>::exportToBinary(const std::string & outputPath) const {
+    std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open the output file!");
+    }
+    static const char zeros[8] = {0};
+    std::uint64_t nonZeros = this->storage.nonZeros();
+    BinaryMatrixFile::Header header = BinaryMatrixFile::makeHeader<T>(this->storage.numMajor, this->storage.numMinor, nonZeros);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // The arrays already have the layout of the file, apart from column indices of another width
+    static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "row pointers are written as they are stored");
+    file.write(reinterpret_cast<const char*>(this->storage.majorPtr.data()), this->storage.majorPtr.size() * sizeof(std::uint64_t));
+    if constexpr (sizeof(Index) == sizeof(std::uint32_t)) {
+        file.write(reinterpret_cast<const char*>(this->storage.minorIndex.data()), nonZeros * sizeof(std::uint32_t));
+    } else {
+        std::vector<std::uint32_t> colIndex(this->storage.minorIndex.begin(), this->storage.minorIndex.end());
+        file.write(reinterpret_cast<const char*>(colIndex.data()), nonZeros * sizeof(std::uint32_t));
+    }
+    file.write(zeros, BinaryMatrixFile::padded(nonZeros * sizeof(std::uint32_t)) - nonZeros * sizeof(std::uint32_t));
+    file.write(reinterpret_cast<const char*>(this->storage.values.data()), nonZeros * sizeof(T));
+    file.write(zeros, BinaryMatrixFile::padded(nonZeros * sizeof(T)) - nonZeros * sizeof(T));
+    if (!file) {
+        throw std::runtime_error("Could not write the output file!");
+    }
+}
+
+// Implementation of CSRMatrix multiplyVector method
+template <typename T, typename Index>
+std::vector<T> CSRMatrix<T, Index>::multiplyVector(const std::vector<T> & x) const {
+    if (x.size() != this->storage.numMinor) {
+        throw std::invalid_argument("Vector size must be equal to the number of columns");
+    }
+    std::vector<T> y(this->storage.numMajor, 0);
+    CompressedStorage::multiplyVectorLines(this->storage, x.data(), y.data(), 1, std::size_t(this->storage.numMajor) + 1);
+    return y;
+}
+
+// Implementation of the parallel CSRMatrix multiplyVector method
+template <typename T, typename Index>
+std::vector<T> CSRMatrix<T, Index>::multiplyVector(const std::vector<T> & x, ThreadPool & threads) const {
+    if (x.size() != this->storage.numMinor) {
+        throw std::invalid_argument("Vector size must be equal to the number of columns");
+    }
+    std::vector<T> y(this->storage.numMajor, 0);
+
+    // Cut the rows where the running count of non-zeros (plus one per row) crosses an even share
+    const std::vector<std::size_t> & rowPtr = this->storage.majorPtr;
+    std::size_t numRow = this->storage.numMajor;
+    std::size_t parts = std::max<std::size_t>(1, std::min<std::size_t>(threads.size() * 4, numRow));
+    std::size_t total = rowPtr[numRow] + numRow;
+    std::vector<std::size_t> firstRows(1, 1);
+    for (std::size_t part = 1; part < parts; part++) {
+        std::size_t target = total * part / parts;
+        // Fewest rows r, at least those before the previous cut and at most numRow, with rowPtr[r] + r >= target,
+        // found by binary search since both grow with r; the next range starts at row r + 1, so the cuts never
+        // decrease nor pass numRow + 1
+        std::size_t low = firstRows.back() - 1, high = numRow;
+        while (low < high) {
+            std::size_t middle = (low + high) / 2;
+            if (rowPtr[middle] + middle >= target) {
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
+        firstRows.push_back(low + 1);
+    }
+    firstRows.push_back(numRow + 1);
+
+    for (std::size_t p = 0; p + 1 < firstRows.size(); p++) {
+        if (firstRows[p] < firstRows[p + 1]) {
+            threads.submit([&, p]() {
+                CompressedStorage::multiplyVectorLines(this->storage, x.data(), y.data(), firstRows[p], firstRows[p + 1]);
+            });
+        }
+    }
+    threads.wait();
+    return y;
+}
+
+// Implementation of CSRMatrix multiplyVectorTransposed method
+template <typename T, typename Index>
+std::vector<T> CSRMatrix<T, Index>::multiplyVectorTransposed(const std::vector<T> & x) const {
+    if (x.size() != this->storage.numMajor) {
+        throw std::invalid_argument("Vector size must be equal to the number of rows");
+    }
+    std::vector<T> y(this->storage.numMinor, 0);
+    CompressedStorage::scatterVectorLines(this->storage, x.data(), y.data(), 1, std::size_t(this->storage.numMajor) + 1);
+    return y;
+}
+
+// Implementation of the parallel CSRMatrix multiplyVectorTransposed method
+template <typename T, typename Index>
+std::vector<T> CSRMatrix<T, Index>::multiplyVectorTransposed(const std::vector<T> & x, ThreadPool & threads) const {
+    if (x.size() != this->storage.numMajor) {
+        throw std::invalid_argument("Vector size must be equal to the number of rows");
+    }
+    std::size_t numCol = this->storage.numMinor;
+    std::size_t parts = std::max<std::size_t>(1, threads.size());
+    std::vector<std::vector<T>> partial(parts);
+
+    // Every range of rows scatters into its own vector
+    std::size_t step = (this->storage.numMajor + parts - 1) / parts;
+    for (std::size_t p = 0; p < parts; p++) {
+        std::size_t first = 1 + p * step;
+        std::size_t last = std::min<std::size_t>(std::size_t(this->storage.numMajor) + 1, 1 + (p + 1) * step);
+        threads.submit([&, p, first, last]() {
+            partial[p].assign(numCol, 0);
+            if (first < last) {
+                CompressedStorage::scatterVectorLines(this->storage, x.data(), partial[p].data(), first, last);
+            }
+        });
+    }
+    threads.wait();
+
+    // Sum the partial results, in parallel over slices of the columns
+    std::vector<T> y(numCol, 0);
+    threads.parallelFor(0, numCol, parts, [&](std::size_t first, std::size_t last) {
+        for (const std::vector<T> & part : partial) {
+            for (std::size_t j = first; j < last; j++) {
+                y[j] = checkedAdd(y[j], part[j]);
+            }
+        }
+    });
+    return y;
+}
+
+// Implementation of CSCMatrix access method
+template <typename T, typename Index>
+T CSCMatrix<T, Index>::access(Index rowIndex, Index colIndex) const {
+    // Check for out-of-bounds indices
+    if (rowIndex == 0 || rowIndex > this->rowLength() || colIndex == 0 || colIndex > this->colLength()) {
+        throw std::out_of_range("Row or column index is out of bounds");
+    }
+    return this->storage.find(colIndex, rowIndex);
+}
+
+// Implementation of CSCMatrix toCSR method
+template <typename T, typename Index>
+CSRMatrix<T, Index> CSCMatrix<T, Index>::toCSR() const {
+    return CSRMatrix(CompressedStorage::transpose(this->storage));
+}
+
+/*==============================================================================================================*/
+// Implementation of HypersparseMatrix access method
+template <typename T, typename Index>
+T HypersparseMatrix<T, Index>::access(Index rowIndex, Index colIndex) const {
+    // Check for out-of-bounds indices
+    if (rowIndex == 0 || rowIndex > this->numRow || colIndex == 0 || colIndex > this->numCol) {
+        throw std::out_of_range("Row or column index is out of bounds");
+    }
+    typename Directory::const_iterator row = this->rowHeaders.find(rowIndex);
+    if (row == this->rowHeaders.end()) {
+        return 0; // Empty row
+    }
+    for (Node* current = row->second->nextCol; current != row->second && current->colIndex <= colIndex; current = current->nextCol) {
+        if (current->colIndex == colIndex) {
+            return current->data;
+        }
+    }
+    return 0;
+}
+
+// Implementation of HypersparseMatrix insert method
+template <typename T, typename Index>
+void HypersparseMatrix<T, Index>::insert(T data, Index rowIndex, Index colIndex) {
+    // Check for out-of-bounds indices
+    if (rowIndex == 0 || rowIndex > this->numRow || colIndex == 0 || colIndex > this->numCol) {
+        throw std::out_of_range("Row or column index is out of bounds");
+    }
+
+    // A zero value is not stored, so inserting one deletes the element
+    if (data == 0) {
+        remove(rowIndex, colIndex);
+        return;
+    }
+
+    // ===== Insert into the row ===== //
+    Node* & rowHeader = this->rowHeaders[rowIndex];
+    if (rowHeader == nullptr) { // First element of the row
+        rowHeader = this->pool.allocate(0, rowIndex, 0);
+        rowHeader->nextCol = rowHeader;
+    }
+    Node* rowNode = rowHeader;
+    while (rowNode->nextCol != rowHeader && rowNode->nextCol->colIndex < colIndex) {
+        rowNode = rowNode->nextCol;
+    }
+
+    // If the node already exists, update its data
+    if (rowNode->nextCol != rowHeader && rowNode->nextCol->colIndex == colIndex) {
+        rowNode->nextCol->data = data;
+        return;
+    }
+    Node* newNode = this->pool.allocate(data, rowIndex, colIndex);
+    newNode->nextCol = rowNode->nextCol;
+    rowNode->nextCol = newNode;
+
+    // ===== Insert into the column ===== //
+    Node* & colHeader = this->colHeaders[colIndex];
+    if (colHeader == nullptr) { // First element of the column
+        colHeader = this->pool.allocate(0, 0, colIndex);
+        colHeader->nextRow = colHeader;
+    }
+    Node* colNode = colHeader;
+    while (colNode->nextRow != colHeader && colNode->nextRow->rowIndex < rowIndex) {
+        colNode = colNode->nextRow;
+    }
+    newNode->nextRow = colNode->nextRow;
+    colNode->nextRow = newNode;
+}
+
+// Implementation of HypersparseMatrix remove method
+template <typename T, typename Index>
+void HypersparseMatrix<T, Index>::remove(Index rowIndex, Index colIndex) {
+    // Check for out-of-bounds indices
+    if (rowIndex == 0 || rowIndex > this->numRow || colIndex == 0 || colIndex > this->numCol) {
+        throw std::out_of_range("Row or column index is out of bounds");
+    }
+
+    // ===== Remove from the row ===== //
+    typename Directory::iterator row = this->rowHeaders.find(rowIndex);
+    if (row == this->rowHeaders.end()) {
+        return; // Empty row
+    }
+    Node* prevRowNode = row->second;
+    while (prevRowNode->nextCol != row->second && prevRowNode->nextCol->colIndex < colIndex) {
+        prevRowNode = prevRowNode->nextCol;
+    }
+    Node* toRemove = prevRowNode->nextCol;
+    if (toRemove == row->second || toRemove->colIndex != colIndex) {
+        return; // Node not found
+    }
+    prevRowNode->nextCol = toRemove->nextCol;
+
+    // ===== Remove from the column ===== //
+    typename Directory::iterator col = this->colHeaders.find(colIndex);
+    Node* prevColNode = col->second;
+    while (prevColNode->nextRow != toRemove) {
+        prevColNode = prevColNode->nextRow;
+    }
+    prevColNode->nextRow = toRemove->nextRow;
+    this->pool.release(toRemove);
+
+    // Drop the placeholders of lines that became empty
+    if (row->second->nextCol == row->second) {
+        this->pool.release(row->second);
+        this->rowHeaders.erase(row);
+    }
+    if (col->second->nextRow == col->second) {
+        this->pool.release(col->second);
+        this->colHeaders.erase(col);
+    }
+}
+
+// Implementation of HypersparseMatrix addRows method
+template <typename T, typename Index>
+void HypersparseMatrix<T, Index>::addRows(const RowWriter & writer) {
+    for (const std::pair<Index, Node*> & header : writer.headers) {
+        this->rowHeaders.emplace_hint(this->rowHeaders.end(), header.first, header.second);
+    }
+}
+
+// Implementation of HypersparseMatrix linkColumns method
+template <typename T, typename Index>
+void HypersparseMatrix<T, Index>::linkColumns() {
+    // The nodes in row order; a stable sort by column leaves every column in row order
+    std::vector<Node*> nodes;
+    for (const std::pair<const Index, Node*> & row : this->rowHeaders) {
+        for (Node* current = row.second->nextCol; current != row.second; current = current->nextCol) {
+            nodes.push_back(current);
+        }
+    }
+    std::stable_sort(nodes.begin(), nodes.end(), [](const Node* x, const Node* y) { return x->colIndex < y->colIndex; });
+
+    // Columns now come in order, so every placeholder is added at the end of the directory
+    Node* colTail = nullptr;
+    for (Node* current : nodes) {
+        if (colTail == nullptr || colTail->colIndex != current->colIndex) { // First element of the column
+            if (colTail != nullptr) {
+                colTail->nextRow = this->colHeaders.rbegin()->second; // Close the previous circle
+            }
+            colTail = this->pool.allocate(0, 0, current->colIndex);
+            this->colHeaders.emplace_hint(this->colHeaders.end(), current->colIndex, colTail);
+        }
+        colTail->nextRow = current;
+        colTail = current;
+    }
+    if (colTail != nullptr) {
+        colTail->nextRow = this->colHeaders.rbegin()->second;
+    }
+}
+
+// Implementation of HypersparseMatrix buildRows method
+template <typename T, typename Index>
+template <typename RowKernel>
+HypersparseMatrix<T, Index> HypersparseMatrix<T, Index>::buildRows(Index numRow, Index numCol, const std::vector<std::size_t> & work,
+                                                                   ThreadPool * threads, RowKernel kernel) {
+    HypersparseMatrix c(numRow, numCol);
+
+    // Cut the positions into ranges of about equal work, counting one extra unit per row for its own overhead
+    std::size_t total = 0;
+    for (std::size_t w : work) {
+        total += w + 1;
+    }
+    std::size_t parts = threads ? std::max<std::size_t>(1, std::min<std::size_t>(threads->size() * 4, work.size())) : 1;
+    std::vector<std::size_t> firsts(1, 0);
+    std::size_t done = 0;
+    for (std::size_t p = 0; p < work.size() && firsts.size() < parts; p++) {
+        done += work[p] + 1;
+        if (done * parts >= total * firsts.size()) {
+            firsts.push_back(p + 1);
+        }
+    }
+    firsts.push_back(work.size());
+
+    // Build every range with its own pool
+    std::vector<NodePool> pools(firsts.size() - 1);
+    std::vector<RowWriter> writers;
+    writers.reserve(pools.size());
+    for (NodePool & pool : pools) {
+        writers.push_back(RowWriter(pool));
+    }
+    if (threads) {
+        for (std::size_t p = 0; p < writers.size(); p++) {
+            threads->submit([&, p]() { kernel(firsts[p], firsts[p + 1], writers[p]); });
+        }
+        threads->wait();
+    } else {
+        kernel(firsts[0], firsts[1], writers[0]);
+    }
+
+    for (std::size_t p = 0; p < writers.size(); p++) {
+        c.pool.adopt(std::move(pools[p]));
+        c.addRows(writers[p]);
+    }
+    c.linkColumns();
+    return c;
+}
+
+// Implementation of HypersparseMatrix fromTriplets method
+template <typename T, typename Index>
+HypersparseMatrix<T, Index> HypersparseMatrix<T, Index>::fromTriplets(Index numRow, Index numCol, const std::vector<Triplet> & triplets) {
+    for (const Triplet & t : triplets) {
+        if (t.rowIndex == 0 || t.rowIndex > numRow || t.colIndex == 0 || t.colIndex > numCol) {
+            throw std::out_of_range("Row or column index is out of bounds");
+        }
+    }
+
+    // Sort by (row, column). The sort is stable, so duplicates stay in input order and the last one wins
+    std::vector<Triplet> sorted(triplets);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Triplet & x, const Triplet & y) {
+        return x.rowIndex != y.rowIndex ? x.rowIndex < y.rowIndex : x.colIndex < y.colIndex;
+    });
+
+    HypersparseMatrix m(numRow, numCol);
+    m.pool.reserve(sorted.size());
+    RowWriter writer(m.pool);
+    Index currentRow = 0;
+    for (std::size_t p = 0; p < sorted.size(); p++) {
+        const Triplet & t = sorted[p];
+        if (p + 1 < sorted.size() && sorted[p + 1].rowIndex == t.rowIndex && sorted[p + 1].colIndex == t.colIndex) {
+            continue;
+        }
+        if (t.data == 0) {
+            continue;
+        }
+        if (t.rowIndex != currentRow) {
+            currentRow = t.rowIndex;
+            writer.beginRow(currentRow);
+        }
+        writer.append(t.data, t.colIndex);
+    }
+    m.addRows(writer);
+    m.linkColumns();
+    return m;
+}
+
+// Implementation of HypersparseMatrix add method
+template <typename T, typename Index>
+HypersparseMatrix<T, Index> HypersparseMatrix<T, Index>::add(const HypersparseMatrix & a, const HypersparseMatrix & b, ThreadPool * threads) {
+    // Check the size
+    if (a.numCol != b.numCol || a.numRow != b.numRow) {
+        throw std::invalid_argument("Matrices must be equal in size");
+    }
+
+    // The rows present in either matrix, with their placeholders in a and b (null if empty there)
+    struct RowPair {
+        Index row;
+        Node* aRow;
+        Node* bRow;
+    };
+    std::vector<RowPair> rows;
+    std::vector<std::size_t> work;
+    typename Directory::const_iterator aRow = a.rowHeaders.begin();
+    typename Directory::const_iterator bRow = b.rowHeaders.begin();
+    while (aRow != a.rowHeaders.end() || bRow != b.rowHeaders.end()) {
+        if (bRow == b.rowHeaders.end() || (aRow != a.rowHeaders.end() && aRow->first < bRow->first)) {
+            rows.push_back(RowPair{aRow->first, aRow->second, nullptr});
+            aRow++;
+        } else if (aRow == a.rowHeaders.end() || bRow->first < aRow->first) {
+            rows.push_back(RowPair{bRow->first, nullptr, bRow->second});
+            bRow++;
+        } else {
+            rows.push_back(RowPair{aRow->first, aRow->second, bRow->second});
+            aRow++;
+            bRow++;
+        }
+        work.push_back(1);
+    }
+
+    return buildRows(a.numRow, a.numCol, work, threads, [&](std::size_t first, std::size_t last, RowWriter & writer) {
+        for (std::size_t p = first; p < last; p++) {
+            writer.beginRow(rows[p].row);
+            Node* aNode = rows[p].aRow ? rows[p].aRow->nextCol : nullptr;
+            Node* bNode = rows[p].bRow ? rows[p].bRow->nextCol : nullptr;
+            bool aEnd = aNode == rows[p].aRow;
+            bool bEnd = bNode == rows[p].bRow;
+            while (!aEnd || !bEnd) {
+                if (bEnd || (!aEnd && aNode->colIndex < bNode->colIndex)) {
+                    writer.append(aNode->data, aNode->colIndex); // Only in a
+                    aNode = aNode->nextCol;
+                } else if (aEnd || bNode->colIndex < aNode->colIndex) {
+                    writer.append(bNode->data, bNode->colIndex); // Only in b
+                    bNode = bNode->nextCol;
+                } else {
+                    T sum = checkedAdd(aNode->data, bNode->data); // In both, skip if they cancel out
+                    if (sum != 0) {
+                        writer.append(sum, aNode->colIndex);
+                    }
+                    aNode = aNode->nextCol;
+                    bNode = bNode->nextCol;
+                }
+                aEnd = aNode == rows[p].aRow;
+                bEnd = bNode == rows[p].bRow;
+            }
+        }
+    });
+}
+
+// Implementation of HypersparseMatrix multiply method
+template <typename T, typename Index>
+HypersparseMatrix<T, Index> HypersparseMatrix<T, Index>::multiply(const HypersparseMatrix & a, const HypersparseMatrix & b, ThreadPool * threads) {
+    // Check the size
+    if (a.numCol != b.numRow) {
+        throw std::invalid_argument("Invalid matrix dimensions for multiplication");
+    }
+
+    // The non-empty rows of a. Their lengths stand for the work, since counting the multiply-adds would
+    // cost as many directory lookups in b as the product itself
+    std::vector<Node*> rows;
+    std::vector<std::size_t> work;
+    for (const std::pair<const Index, Node*> & row : a.rowHeaders) {
+        std::size_t length = 0;
+        for (Node* aNode = row.second->nextCol; aNode != row.second; aNode = aNode->nextCol) {
+            length++;
+        }
+        rows.push_back(row.second);
+        work.push_back(length);
+    }
+
+    return buildRows(a.numRow, b.numCol, work, threads, [&](std::size_t first, std::size_t last, RowWriter & writer) {
+        std::vector<std::pair<Index, T>> products; // (column, product) of the current row, reused
+        for (std::size_t p = first; p < last; p++) {
+            products.clear();
+            for (Node* aNode = rows[p]->nextCol; aNode != rows[p]; aNode = aNode->nextCol) {
+                typename Directory::const_iterator bRow = b.rowHeaders.find(aNode->colIndex);
+                if (bRow == b.rowHeaders.end()) {
+                    continue;
+                }
+                for (Node* bNode = bRow->second->nextCol; bNode != bRow->second; bNode = bNode->nextCol) {
+                    products.push_back(std::make_pair(bNode->colIndex, checkedMultiply(aNode->data, bNode->data)));
+                }
+            }
+
+            // Sum the products of every column, in order
+            std::stable_sort(products.begin(), products.end(), [](const std::pair<Index, T> & x, const std::pair<Index, T> & y) {
+                return x.first < y.first;
+            });
+            writer.beginRow(rows[p]->rowIndex);
+            for (std::size_t q = 0; q < products.size();) {
+                Index j = products[q].first;
+                T sum = 0;
+                for (; q < products.size() && products[q].first == j; q++) {
+                    sum = checkedAdd(sum, products[q].second);
+                }
+                if (sum != 0) {
+                    writer.append(sum, j);
+                }
+            }
+        }
+    });
+}
+
+// Implementation of HypersparseMatrix scale method
+template <typename T, typename Index>
+HypersparseMatrix<T, Index> HypersparseMatrix<T, Index>::scale(const HypersparseMatrix & a, T k, ThreadPool * threads) {
+    std::vector<Node*> rows;
+    std::vector<std::size_t> work;
+    if (k != 0) { // Otherwise every element becomes zero
+        for (const std::pair<const Index, Node*> & row : a.rowHeaders) {
+            rows.push_back(row.second);
+            work.push_back(1);
+        }
+    }
+
+    return buildRows(a.numRow, a.numCol, work, threads, [&](std::size_t first, std::size_t last, RowWriter & writer) {
+        for (std::size_t p = first; p < last; p++) {
+            writer.beginRow(rows[p]->rowIndex);
+            for (Node* current = rows[p]->nextCol; current != rows[p]; current = current->nextCol) {
+                T product = checkedMultiply(current->data, k);
+                if (product != 0) { // Only possible for floating-point values
+                    writer.append(product, current->colIndex);
+                }
+            }
+        }
+    });
+}
+
+// Implementation of HypersparseMatrix matrixAddition method
+template <typename T, typename Index>
+HypersparseMatrix<T, Index> HypersparseMatrix<T, Index>::matrixAddition(const HypersparseMatrix & a, const HypersparseMatrix & b) {
+    return add(a, b, nullptr);
+}
+
+// Implementation of HypersparseMatrix matrixAddition method, on a thread pool
+template <typename T, typename Index>
+HypersparseMatrix<T, Index> HypersparseMatrix<T, Index>::matrixAddition(const HypersparseMatrix & a, const HypersparseMatrix & b, ThreadPool & threads) {
+    return add(a, b, &threads);
+}
+
+// Implementation of HypersparseMatrix matrixMultiplication method
+template <typename T, typename Index>
+HypersparseMatrix<T, Index> HypersparseMatrix<T, Index>::matrixMultiplication(const HypersparseMatrix & a, const HypersparseMatrix & b) {
+    return multiply(a, b, nullptr);
+}
+
+// Implementation of HypersparseMatrix matrixMultiplication method, on a thread pool
+template <typename T, typename Index>
+HypersparseMatrix<T, Index> HypersparseMatrix<T, Index>::matrixMultiplication(const HypersparseMatrix & a, const HypersparseMatrix & b, ThreadPool & threads) {
+    return multiply(a, b, &threads);
+}
+
+// Implementation of HypersparseMatrix matrixScalarMultiplication method
+template <typename T, typename Index>
+HypersparseMatrix<T, Index> HypersparseMatrix<T, Index>::matrixScalarMultiplication(const HypersparseMatrix & a, T k) {
+    return scale(a, k, nullptr);
+}
+
+// Implementation of HypersparseMatrix matrixScalarMultiplication method, on a thread pool
+template <typename T, typename Index>
+HypersparseMatrix<T, Index> HypersparseMatrix<T, Index>::matrixScalarMultiplication(const HypersparseMatrix & a, T k, ThreadPool & threads) {
+    return scale(a, k, &threads);
+}
+
+// Implementation of HypersparseMatrix matrixTransposition method
+template <typename T, typename Index>
+HypersparseMatrix<T, Index> HypersparseMatrix<T, Index>::matrixTransposition(const HypersparseMatrix & a) {
+    // Column j of a, walked in row order, is row j of the result
+    std::vector<Node*> cols;
+    for (const std::pair<const Index, Node*> & col : a.colHeaders) {
+        cols.push_back(col.second);
+    }
+    std::vector<std::size_t> work(cols.size(), 1);
+
+    return buildRows(a.numCol, a.numRow, work, nullptr, [&](std::size_t first, std::size_t last, RowWriter & writer) {
+        for (std::size_t p = first; p < last; p++) {
+            writer.beginRow(cols[p]->colIndex);
+            for (Node* current = cols[p]->nextRow; current != cols[p]; current = current->nextRow) {
+                writer.append(current->data, current->rowIndex);
+            }
+        }
+    });
+}
+
+// Implementation of HypersparseMatrix display method
+template <typename T, typename Index>
+void HypersparseMatrix<T, Index>::display(DisplayMode mode, std::ostream & out) const {
+    mode = displayModeFor(mode, numRow, numCol);
+    if (mode == DisplayMode::None) {
+        return;
+    }
+    BufferedWriter writer(out);
+
+    if (mode == DisplayMode::Sparse) { // Only the stored elements, walking the non-empty rows
+        for (const std::pair<const Index, Node*> & row : this->rowHeaders) {
+            for (Node* current = row.second->nextCol; current != row.second; current = current->nextCol) {
+                writer.writeNumber(current->rowIndex);
+                writer.put(',');
+                writer.writeNumber(current->colIndex);
+                writer.put(',');
+                writer.writeDisplayNumber(current->data);
+                writer.put('\n');
+            }
+        }
+    } else {
+        typename Directory::const_iterator row = this->rowHeaders.begin();
+        for (std::size_t i = 1; i <= numRow; ++i) {
+            Node* placeholder = nullptr;
+            if (row != this->rowHeaders.end() && row->first == i) {
+                placeholder = row->second;
+                row++;
+            }
+            Node* current = placeholder ? placeholder->nextCol : nullptr;
+            for (std::size_t j = 1; j <= numCol; ++j) {
+                if (current != placeholder && current->colIndex == j) {
+                    writer.writeDisplayNumber(current->data);
+                    writer.put(' ');
+                    current = current->nextCol;
+                } else {
+                    writer.write("0 ", 2);
+                }
+            }
+            writer.put('\n');
+        }
+    }
+    writer.flush();
+    out.flush();
+}
+
+// Implementation of HypersparseMatrix exportToCSV method
+template <typename T, typename Index>
+void HypersparseMatrix<T, Index>::exportToCSV(const std::string & filePath, std::ostream & out) const {
+    std::string outputPath = SparseMatrix<T>::outputFilePath(filePath);
+
+    // Open the file in trunc mode to ensure a new file is created
+    std::ofstream file(outputPath, std::ios::trunc);
+    BufferedWriter writer(file);
+    for (const std::pair<const Index, Node*> & row : this->rowHeaders) {
+        for (Node* current = row.second->nextCol; current != row.second; current = current->nextCol) {
+            writer.writeNumber(current->rowIndex);
+            writer.put(',');
+            writer.writeNumber(current->colIndex);
+            writer.put(',');
+            writer.writeNumber(current->data);
+            writer.put('\n');
+        }
+    }
+    writer.flush();
+    file.close();
+    out << "Data exported successfully to " << "'" << outputPath<< "'" << std::endl;
+}
+
+// Implementation of MappedFile constructor
+MappedFile::MappedFile(const std::string & filePath) : contents(nullptr), length(0) {
+#ifndef _WIN32
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open the file!");
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not open the file!");
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length > 0) { // mmap rejects empty mappings
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Could not map the file!");
+        }
+        ::madvise(mapping, length, MADV_SEQUENTIAL); // Lines are scanned front to back
+        contents = static_cast<const char*>(mapping);
+    }
+    ::close(fd); // The mapping stays valid after closing the descriptor
+#else
+    std::ifstream input(filePath, std::ios::binary);
+    if (!input.is_open()) {
+        throw std::runtime_error("Could not open the file!");
+    }
+    buffer.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    length = buffer.size();
+    contents = buffer.data();
+#endif
+}
+
+// Implementation of MappedFile destructor
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (contents != nullptr) {
+        ::munmap(const_cast<char*>(contents), length);
+    }
+#endif
+}
+
+// Implementation of MatrixFileParser constructor
+MatrixFileParser::MatrixFileParser(const std::string & filePath) : file(filePath) {
+    cursor = file.begin();
+}
+
+// Implementation of MatrixFileParser nextLine method
+bool MatrixFileParser::nextLine(const char*& lineBegin, const char*& lineEnd) {
+    if (cursor == nullptr || cursor >= file.end()) {
+        return false;
+    }
+    lineBegin = cursor;
+    const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', file.end() - cursor));
+    lineEnd = newline != nullptr ? newline : file.end();
+    cursor = newline != nullptr ? newline + 1 : file.end();
+
+    if (lineEnd > lineBegin && lineEnd[-1] == '\r') { // Windows line ending
+        lineEnd--;
+    }
+    return true;
+}
+
+// Implementation of MatrixFileParser parseField method
+template <typename Number>
+void MatrixFileParser::parseField(const char*& p, const char* end, Number & value) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        throw std::invalid_argument(std::is_integral<Number>::value ? "Expected an integer in the input file"
+                                                                    : "Expected a number in the input file");
+    }
+    // Skip whatever follows the number up to and including the comma
+    p = result.ptr;
+    while (p < end && *p != ',') {
+        p++;
+    }
+    if (p < end) {
+        p++;
+    }
+}
+
+// Implementation of MatrixFileParser readHeader method
+bool MatrixFileParser::readHeader(JobHeader & header) {
+    const char* lineBegin;
+    const char* lineEnd;
+    if (!nextLine(lineBegin, lineEnd) || lineBegin == lineEnd) {
+        return false;
+    }
+    header.operation = *lineBegin;
+
+    // The number of rows is the second field
+    const char* p = static_cast<const char*>(std::memchr(lineBegin, ',', lineEnd - lineBegin));
+    if (p == nullptr) {
+        throw std::invalid_argument("Expected an integer in the input file");
+    }
+    p++;
+    parseField(p, lineEnd, header.numRow);
+
+    // The columns of A and B are optional, blank fields count as omitted
+    auto optionalField = [&](std::uint64_t & value, std::uint64_t fallback) {
+        while (p < lineEnd && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        if (p == lineEnd || *p == ',') {
+            value = fallback;
+            p += p < lineEnd ? 1 : 0;
+        } else {
+            parseField(p, lineEnd, value);
+        }
+    };
+    optionalField(header.numCol, header.numRow);
+    optionalField(header.numColB, header.numCol);
+    return true;
+}
+
+// Implementation of MatrixFileParser skipLine method
+void MatrixFileParser::skipLine() {
+    const char* lineBegin;
+    const char* lineEnd;
+    nextLine(lineBegin, lineEnd);
+}
+
+// Implementation of MatrixFileParser readLine method
+bool MatrixFileParser::readLine(std::string & line) {
+    const char* lineBegin;
+    const char* lineEnd;
+    if (!nextLine(lineBegin, lineEnd)) {
+        return false;
+    }
+    line.assign(lineBegin, lineEnd);
+    return true;
+}
+
+// Implementation of MatrixFileParser parseLines method
+template <typename T, typename Index>
+const char* MatrixFileParser::parseLines(const char* begin, const char* end, std::vector<Triplet<T, Index>> & triplets) {
+    const char* lineBegin = begin;
+    while (lineBegin < end) {
+        const char* newline = static_cast<const char*>(std::memchr(lineBegin, '\n', end - lineBegin));
+        const char* lineEnd = newline != nullptr ? newline : end;
+        const char* next = newline != nullptr ? newline + 1 : end;
+        if (lineEnd > lineBegin && lineEnd[-1] == '\r') { // Windows line ending
+            lineEnd--;
+        }
+
+        // A line containing two consecutive commas ends the section
+        for (const char* p = lineBegin; p + 1 < lineEnd; p++) {
+            if (p[0] == ',' && p[1] == ',') {
+                return next;
+            }
+        }
+        if (lineBegin == lineEnd) {
+            lineBegin = next;
+            continue;  // Blank line
+        }
 
-    /**
-     * @brief Perform scalar multiplication on a sparse matrix.
-     * 
-     * This function performs scalar multiplication on the input sparse matrix `a` by multiplying each element 
-     * of the matrix by the scalar `k`. The function returns a new sparse matrix, `b`, which contains the 
-     * scaled elements of the original matrix.
-     * 
-     * The matrix `a` is passed as a `const` reference to avoid unnecessary copying and ensure that the 
-     * input matrix is not modified, improving both performance and safety. The scalar `k` is passed by value 
-     * since it is a simple data type.
-     * 
-     * @param const SparseMatrix & a: A const reference to a SparseMatrix object representing the matrix to be multiplied by the scalar.
-     *          Passing by reference avoids copying the matrix, and the const qualifier ensures that the matrix is not modified.
-     * @param int k: The scalar value to multiply each element of the matrix by.
-     * 
-     * @return SparseMatrix The resulting sparse matrix `b` after multiplying each element of matrix `a` by scalar `k`.
-     */
-    static SparseMatrix matrixScalarMultiplication(const SparseMatrix & a, int k);
+        long long rowNum = 0;
+        long long colNum = 0;
+        T value = 0;
+        const char* p = lineBegin;
+        parseField(p, lineEnd, rowNum);
+        parseField(p, lineEnd, colNum);
+        parseField(p, lineEnd, value);
+        if (rowNum <= 0 || static_cast<unsigned long long>(rowNum) > std::numeric_limits<Index>::max()
+            || colNum <= 0 || static_cast<unsigned long long>(colNum) > std::numeric_limits<Index>::max()) {
+            throw std::out_of_range("Row or column index is out of bounds");
+        }
+        triplets.push_back(Triplet<T, Index>(value, static_cast<Index>(rowNum), static_cast<Index>(colNum)));
+        lineBegin = next;
+    }
+    return nullptr;
+}
+
+// Implementation of MatrixFileParser readSection method
+template <typename T, typename Index>
+std::size_t MatrixFileParser::readSection(std::vector<Triplet<T, Index>> & triplets) {
+    if (atEnd()) {
+        return 0;
+    }
+    std::size_t before = triplets.size();
+    const char* rest = parseLines(cursor, file.end(), triplets);
+    cursor = rest != nullptr ? rest : file.end();
+    return triplets.size() - before;
+}
 
+// Implementation of MatrixFileParser readSection method for several threads
+template <typename T, typename Index>
+std::size_t MatrixFileParser::readSection(std::vector<std::vector<Triplet<T, Index>>> & buffers, ThreadPool & threads) {
     /**
-     * @brief Export non-zero elements of the sparse matrix to a CSV file.
-     * 
-     * This function exports the non-zero elements of the sparse matrix to a CSV file. The output filename 
-     * is based on `filePath`, with "_output" appended before the file extension (or added if none exists).
-     * 
-     * Each line in the CSV contains the row index, column index, and value of a non-zero element. The file 
-     * is opened in truncation mode to overwrite any existing content.
-     * 
-     * @param const std::string & filePath: Path and name of the output file. The filename is modified to 
-     *          include "_output".
+     * @struct Chunk
+     * @brief The outcome of parsing one chunk.
      */
-    void exportToCSV(const std::string & filePath);
+    struct Chunk {
+        std::vector<Triplet<T, Index>> triplets;  ///< Entries of the chunk up to its separator.
+        const char* rest = nullptr;               ///< One past the separator line, if the chunk has one.
+        std::exception_ptr error;                 ///< The error that stopped the chunk, if any.
+    };
 
-};
+    std::size_t count = 0;
+    bool ended = false;
+    while (!ended && !atEnd()) {
+        // Cut the next wave of chunks at line boundaries, one chunk per thread
+        std::size_t remaining = file.end() - cursor;
+        std::size_t chunkBytes = std::max(MIN_CHUNK_BYTES, std::min(MAX_CHUNK_BYTES, remaining / threads.size()));
+        std::vector<const char*> bounds(1, cursor);
+        while (bounds.size() <= threads.size() && bounds.back() < file.end()) {
+            const char* cut = bounds.back() + std::min<std::size_t>(chunkBytes, file.end() - bounds.back());
+            const char* newline = cut < file.end() ? static_cast<const char*>(std::memchr(cut, '\n', file.end() - cut)) : nullptr;
+            bounds.push_back(newline != nullptr ? newline + 1 : file.end());
+        }
 
-/*==============================================================================================================*/
-// Implementation of rowLength method
-int SparseMatrix::rowLength() const {
-    return this->numRow;
+        std::vector<Chunk> chunks(bounds.size() - 1);
+        threads.parallelFor(0, chunks.size(), chunks.size(), [&](std::size_t first, std::size_t last) {
+            for (std::size_t c = first; c < last; c++) {
+                try {
+                    chunks[c].triplets.reserve((bounds[c + 1] - bounds[c]) / 12); // About one entry per 12 bytes
+                    chunks[c].rest = parseLines(bounds[c], bounds[c + 1], chunks[c].triplets);
+                } catch (...) {
+                    chunks[c].error = std::current_exception();
+                }
+            }
+        });
+
+        // Keep the chunks up to the first separator, failing on the first error before it
+        cursor = bounds.back();
+        for (Chunk & chunk : chunks) {
+            if (chunk.error) {
+                std::rethrow_exception(chunk.error);
+            }
+            count += chunk.triplets.size();
+            buffers.push_back(std::move(chunk.triplets));
+            if (chunk.rest != nullptr) {
+                cursor = chunk.rest;
+                ended = true;
+                break;
+            }
+        }
+    }
+    return count;
 }
 
-// Implementation of colLength method
-int SparseMatrix::colLength() const {
-    return this->numCol;
+// Implementation of MatrixFileParser readScalar method
+template <typename T>
+bool MatrixFileParser::readScalar(T & scalar) {
+    const char* lineBegin;
+    const char* lineEnd;
+    if (!nextLine(lineBegin, lineEnd)) {
+        return false;
+    }
+    parseField(lineBegin, lineEnd, scalar);
+    return true;
 }
 
-// Implementation of access method
-int SparseMatrix::access(int rowIndex, int colIndex) const {
-    // Check for out-of-bounds indices
-    if (rowIndex <= 0 || rowIndex > this->numRow || colIndex <= 0 || colIndex > this->numCol) {
-        throw std::out_of_range("Row or column index is out of bounds");
+// Implementation of BinaryMatrixFile valueSize method
+std::size_t BinaryMatrixFile::valueSize(std::uint32_t valueType) {
+    switch (valueType) {
+        case ValueTraits<std::int32_t>::BINARY_TYPE: return sizeof(std::int32_t);
+        case ValueTraits<std::int64_t>::BINARY_TYPE: return sizeof(std::int64_t);
+        case ValueTraits<float>::BINARY_TYPE: return sizeof(float);
+        case ValueTraits<double>::BINARY_TYPE: return sizeof(double);
+        default: return 0;
     }
+}
 
-    // Start at the row placeholder
-    Node* rowNode = this->rowHeaders[rowIndex];  
+// Implementation of BinaryMatrixFile makeHeader method
+template <typename T>
+BinaryMatrixFile::Header BinaryMatrixFile::makeHeader(std::uint64_t numRow, std::uint64_t numCol, std::uint64_t nonZeros) {
+    if (numCol > UINT32_MAX) {
+        throw std::invalid_argument("Too many columns for the binary matrix format");
+    }
+    Header header;
+    std::memcpy(header.magic, "SPMB", 4);
+    header.version = VERSION;
+    header.valueType = ValueTraits<T>::BINARY_TYPE;
+    header.reserved = 0;
+    header.numRow = numRow;
+    header.numCol = numCol;
+    header.nonZeros = nonZeros;
+    return header;
+}
 
-    // Traverse and find the correct position in the row based on the column index
-    while (rowNode->nextCol != this->rowHeaders[rowIndex] && rowNode->nextCol->colIndex < colIndex) {
-        rowNode = rowNode->nextCol;
+// Implementation of BinaryMatrixFile constructor
+BinaryMatrixFile::BinaryMatrixFile(const std::string & filePath) : file(filePath) {
+    if (file.size() < sizeof(Header)) {
+        throw std::runtime_error("Not a binary matrix file: " + filePath);
+    }
+    header = reinterpret_cast<const Header*>(file.begin());
+    if (std::memcmp(header->magic, "SPMB", 4) != 0 || header->version != VERSION) {
+        throw std::runtime_error("Not a binary matrix file of version 1: " + filePath);
+    }
+    std::size_t valueBytesEach = valueSize(header->valueType);
+    if (valueBytesEach == 0) {
+        throw std::runtime_error("Unsupported value type in " + filePath);
+    }
+    if (header->numRow >= UINT64_MAX / sizeof(std::uint64_t) || header->nonZeros >= UINT64_MAX / sizeof(std::uint64_t)) {
+        throw std::runtime_error("Matrix dimensions too large in " + filePath);
     }
 
-    // If no node exists, return 0
-    if (rowNode->nextCol == this->rowHeaders[rowIndex] || rowNode->nextCol->colIndex != colIndex) {
-        return 0;
+    // Locate the arrays and check that the file holds all of them
+    std::uint64_t rowPtrBytes = padded((header->numRow + 1) * sizeof(std::uint64_t));
+    std::uint64_t colIndexBytes = padded(header->nonZeros * sizeof(std::uint32_t));
+    std::uint64_t valueBytes = padded(header->nonZeros * valueBytesEach);
+    if (file.size() < sizeof(Header) + rowPtrBytes + colIndexBytes + valueBytes) {
+        throw std::runtime_error("Truncated binary matrix file: " + filePath);
+    }
+    const char* p = file.begin() + sizeof(Header);
+    rowPtr = reinterpret_cast<const std::uint64_t*>(p);
+    colIndex = reinterpret_cast<const std::uint32_t*>(p + rowPtrBytes);
+    value = p + rowPtrBytes + colIndexBytes;
+    if (rowPtr[0] != 0 || rowPtr[header->numRow] != header->nonZeros) {
+        throw std::runtime_error("Corrupt row pointers in " + filePath);
     }
 
-    // Return the data
-    return rowNode->nextCol->data;
+    // Every reader takes the rows as sorted, duplicate-free and in bounds, so check them all once here
+    for (std::uint64_t i = 1; i <= header->numRow; i++) {
+        if (rowPtr[i] < rowPtr[i - 1] || rowPtr[i] > header->nonZeros) {
+            throw std::runtime_error("Corrupt row pointers in " + filePath);
+        }
+        std::uint64_t previous = 0;
+        for (std::uint64_t p = rowPtr[i - 1]; p < rowPtr[i]; p++) {
+            if (colIndex[p] <= previous || colIndex[p] > header->numCol) {
+                throw std::runtime_error("Corrupt column indices in row " + std::to_string(i) + " of " + filePath);
+            }
+            previous = colIndex[p];
+        }
+    }
 }
 
-// Implementation of insert method
-void SparseMatrix::insert(int data, int rowIndex, int colIndex) {
+// Implementation of BinaryMatrixFile checkType method
+template <typename T, typename Index>
+void BinaryMatrixFile::checkType() const {
+    if (header->valueType != ValueTraits<T>::BINARY_TYPE) {
+        throw std::runtime_error(std::string("Binary matrix file does not hold ") + ValueTraits<T>::NAME + " values");
+    }
+    if (header->numRow > std::numeric_limits<Index>::max() || header->numCol > std::numeric_limits<Index>::max()) {
+        throw std::runtime_error("Matrix dimensions too large for the index type");
+    }
+}
+
+// Implementation of BinaryMatrixFile values method
+template <typename T>
+const T* BinaryMatrixFile::values() const {
+    checkType<T, std::uint64_t>();
+    return reinterpret_cast<const T*>(this->value);
+}
+
+// Implementation of BinaryMatrixFile access method
+template <typename T>
+T BinaryMatrixFile::access(std::uint64_t rowIndex, std::uint64_t colIndex) const {
     // Check for out-of-bounds indices
-    if (rowIndex <= 0 || rowIndex > this->numRow || colIndex <= 0 || colIndex > this->numCol) {
+    if (rowIndex == 0 || rowIndex > this->rowLength() || colIndex == 0 || colIndex > this->colLength()) {
         throw std::out_of_range("Row or column index is out of bounds");
     }
+    const T* value = this->values<T>();
+    const std::uint32_t* first = this->colIndex + this->rowPtr[rowIndex - 1];
+    const std::uint32_t* last = this->colIndex + this->rowPtr[rowIndex];
+    const std::uint32_t* position = std::lower_bound(first, last, static_cast<std::uint32_t>(colIndex));
+    if (position == last || *position != static_cast<std::uint32_t>(colIndex)) {
+        return 0;
+    }
+    return value[position - this->colIndex];
+}
+
+// Implementation of BinaryMatrixFile toCSR method
+template <typename T, typename Index>
+CSRMatrix<T, Index> BinaryMatrixFile::toCSR() const {
+    checkType<T, Index>();
+    const T* value = reinterpret_cast<const T*>(this->value);
+    CSRMatrix<T, Index> csr(header->numRow, header->numCol);
+    CompressedStorage<T, Index> & storage = csr.storage;
+    std::copy(this->rowPtr, this->rowPtr + header->numRow + 1, storage.majorPtr.begin());
+    storage.minorIndex.assign(this->colIndex, this->colIndex + header->nonZeros);
+    storage.values.assign(value, value + header->nonZeros);
+    return csr;
+}
+
+// Implementation of BinaryMatrixFile toSparseMatrix method
+template <typename T, typename Index>
+SparseMatrix<T, Index> BinaryMatrixFile::toSparseMatrix() const {
+    checkType<T, Index>();
+    const T* value = reinterpret_cast<const T*>(this->value);
+    SparseMatrix<T, Index> m(header->numRow, header->numCol);
+    m.pool.reserve(header->nonZeros);
+    std::vector<Node<T, Index>*> colTails(m.colHeaders, m.colHeaders + m.numCol + 1);
+
+    // Rows are stored in order, so every node is appended at the tails
+    for (std::size_t i = 1; i <= m.numRow; i++) {
+        Node<T, Index>* rowTail = m.rowHeaders[i];
+        for (std::uint64_t p = this->rowPtr[i - 1]; p < this->rowPtr[i]; p++) {
+            if (this->colIndex[p] == 0 || this->colIndex[p] > m.numCol) {
+                throw std::out_of_range("Row or column index is out of bounds");
+            }
+            m.appendNode(value[p], i, this->colIndex[p], rowTail, colTails);
+        }
+    }
+    return m;
+}
+
+/*==============================================================================================================*/
+// Implementation of OutOfCoreMultiplier SpillReader constructor
+OutOfCoreMultiplier::SpillReader::SpillReader(const std::string & filePath, std::size_t bufferSize)
+    : file(filePath, std::ios::binary), buffer(bufferSize) {
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open the spill file '" + filePath + "'");
+    }
+}
 
-    // No need to add zero value
-    if (data == 0) {
+// Implementation of OutOfCoreMultiplier SpillReader refill method
+void OutOfCoreMultiplier::SpillReader::refill() {
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    filled = static_cast<std::size_t>(file.gcount());
+    position = 0;
+    if (filled == 0) {
+        throw std::runtime_error("Truncated spill file");
+    }
+}
+
+// Implementation of OutOfCoreMultiplier SpillReader read method
+void OutOfCoreMultiplier::SpillReader::read(void* destination, std::size_t bytes) {
+    char* out = static_cast<char*>(destination);
+    while (bytes != 0) {
+        if (position == filled) {
+            refill();
+        }
+        std::size_t count = std::min(bytes, filled - position);
+        std::memcpy(out, buffer.data() + position, count);
+        position += count;
+        out += count;
+        bytes -= count;
+    }
+}
+
+// Implementation of OutOfCoreMultiplier SpillReader copyTo method
+void OutOfCoreMultiplier::SpillReader::copyTo(BufferedWriter & writer, std::uint64_t bytes) {
+    while (bytes != 0) {
+        if (position == filled) {
+            refill();
+        }
+        std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(bytes, filled - position));
+        writer.write(buffer.data() + position, count);
+        position += count;
+        bytes -= count;
+    }
+}
+
+// Implementation of OutOfCoreMultiplier planColumnBlocks method
+std::vector<OutOfCoreMultiplier::ColumnBlock> OutOfCoreMultiplier::planColumnBlocks(const BinaryMatrixFile & b, std::size_t valueBytes,
+                                                                                    std::uint64_t budget, std::uint32_t maxWidth,
+                                                                                    std::size_t workers) {
+    // Entries of every column, from one pass over the mapped column indices
+    std::uint64_t numCol = b.colLength();
+    std::vector<std::uint64_t> colCounts(numCol + 1, 0);
+    const std::uint32_t* colIndex = b.colIndices();
+    for (std::uint64_t p = 0; p < b.nonZeros(); p++) {
+        if (colIndex[p] == 0 || colIndex[p] > numCol) {
+            throw std::out_of_range("Row or column index is out of bounds");
+        }
+        colCounts[colIndex[p]]++;
+    }
+
+    // A block costs its row pointers, plus for every column its entries, and a slot of the accumulator and
+    // of a result row for every worker
+    std::uint64_t entryBytes = sizeof(std::uint32_t) + valueBytes;
+    std::uint64_t blockBytes = (b.rowLength() + 1) * sizeof(std::uint64_t);
+    std::uint64_t slotBytes = workers * (valueBytes + sizeof(std::uint64_t) + sizeof(std::uint32_t) + entryBytes);
+    std::vector<ColumnBlock> blocks;
+    ColumnBlock block = {1, 0, 0};
+    std::uint64_t bytes = blockBytes;
+    for (std::uint64_t j = 1; j <= numCol; j++) {
+        std::uint64_t columnBytes = colCounts[j] * entryBytes + slotBytes;
+        std::uint32_t width = block.last + 1 - block.first;
+        if (width != 0 && (bytes + columnBytes > budget || (maxWidth != 0 && width == maxWidth))) {
+            blocks.push_back(block);
+            block = {static_cast<std::uint32_t>(j), static_cast<std::uint32_t>(j - 1), 0};
+            bytes = blockBytes;
+        }
+        if (bytes + columnBytes > budget) {
+            throw std::runtime_error("Column " + std::to_string(j) + " of the right operand does not fit in the memory limit");
+        }
+        block.last = static_cast<std::uint32_t>(j);
+        block.nonZeros += colCounts[j];
+        bytes += columnBytes;
+    }
+    if (block.last >= block.first) {
+        blocks.push_back(block);
+    }
+    return blocks;
+}
+
+// Implementation of OutOfCoreMultiplier reserveOpenFiles method
+void OutOfCoreMultiplier::reserveOpenFiles(std::uint64_t files) {
+#ifndef _WIN32
+    struct rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY || limit.rlim_cur >= files) {
         return;
     }
+    if (limit.rlim_max == RLIM_INFINITY || limit.rlim_max >= files) {
+        limit.rlim_cur = static_cast<rlim_t>(files);
+        if (::setrlimit(RLIMIT_NOFILE, &limit) == 0) {
+            return;
+        }
+    }
+    throw std::runtime_error("The merge needs " + std::to_string(files) + " open files, above the limit of "
+                             + std::to_string(limit.rlim_max) + "; raise --memory-limit or --tile-cols, or ulimit -n");
+#else
+    (void)files;
+#endif
+}
 
-    // ===== Insert into the row ===== //
-    // Start at the row placeholder
-    Node* rowNode = this->rowHeaders[rowIndex];  
+// Implementation of OutOfCoreMultiplier multiply method
+template <typename T>
+std::uint64_t OutOfCoreMultiplier::multiply(const BinaryMatrixFile & a, const BinaryMatrixFile & b, const std::string & outputPath,
+                                            const Options & options, ThreadPool * threads, std::ostream * progress) {
+    // Check the size of both matrices and the budget
+    if (a.colLength() != b.rowLength()) {
+        throw std::invalid_argument("Number of col in matrix 'a' must be equal to number of row in matrix 'b'");
+    }
+    if (b.colLength() > UINT32_MAX) {
+        throw std::invalid_argument("Too many columns for the binary matrix format");
+    }
+    if (options.memoryLimit < MIN_MEMORY_LIMIT) {
+        throw std::invalid_argument("The memory limit must be at least " + std::to_string(MIN_MEMORY_LIMIT >> 20) + " MiB");
+    }
+    const std::uint64_t* aRowPtr = a.rowPointers();
+    const std::uint32_t* aColIndex = a.colIndices();
+    const T* aValues = a.values<T>();
+    const std::uint64_t* bRowPtr = b.rowPointers();
+    const std::uint32_t* bColIndex = b.colIndices();
+    const T* bValues = b.values<T>();
+    std::uint64_t numRow = a.rowLength();
+    std::uint64_t bRows = b.rowLength();
+    std::size_t workers = threads != nullptr ? threads->size() : 1;
+    const std::uint64_t entryBytes = sizeof(std::uint32_t) + sizeof(T);
+
+    // Half of the budget holds the block of B and the accumulators, the other half the spill buffers and the
+    // tiles in flight, one per worker
+    std::vector<ColumnBlock> blocks = planColumnBlocks(b, sizeof(T), options.memoryLimit / 2, options.tileCols, workers);
+    // The merge reads the counts and the entries of every block at once, so check it can open them all before
+    // computing any block; a few more files are left to the output and the standard streams
+    reserveOpenFiles(2 * std::uint64_t(blocks.size()) + 16);
+    std::uint64_t tileBudget = (options.memoryLimit / 2 - 3 * SPILL_BUFFER) / workers;
+    if (progress != nullptr) {
+        *progress << "Out-of-core multiplication: " << blocks.size() << " column blocks, memory limit "
+                  << options.memoryLimit << " bytes" << std::endl;
+    }
+    double totalRows = double(blocks.size()) * double(numRow);
+    unsigned int nextReport = PROGRESS_PERCENT;
+    auto report = [&](std::size_t k, std::uint64_t rowsDone) {
+        // An empty product has no rows to count, and would divide 0 by 0
+        if (progress == nullptr || totalRows == 0) {
+            return;
+        }
+        unsigned int percent = static_cast<unsigned int>((double(k) * double(numRow) + double(rowsDone)) * 100 / totalRows);
+        if (percent >= nextReport) {
+            *progress << "Out-of-core multiplication: block " << k + 1 << "/" << blocks.size() << ", row " << rowsDone
+                      << "/" << numRow << " (" << percent << "%)" << std::endl;
+            nextReport = (percent / PROGRESS_PERCENT + 1) * PROGRESS_PERCENT;
+        }
+    };
+
+    // The spill files are removed however the product ends
+    struct SpillFiles {
+        std::vector<std::string> paths;
+        ~SpillFiles() {
+            for (const std::string & path : paths) {
+                std::remove(path.c_str());
+            }
+        }
+    } spill;
+    auto spillPath = [&](std::size_t k, const char* extension) { return outputPath + "." + std::to_string(k) + extension; };
+
+    // A range of rows of A, with the count of entries of every row in the block and the entries, by column
+    struct Tile {
+        std::uint64_t first = 0;
+        std::uint64_t last = 0;
+        std::vector<std::uint32_t> counts;
+        std::vector<std::uint32_t> colIndex;
+        std::vector<T> values;
+    };
+    struct Accumulator {
+        std::vector<T> values;
+        std::vector<std::uint64_t> lastTouched;
+        std::vector<std::uint32_t> touched;
+    };
+    std::vector<Accumulator> accumulators(workers);
+    std::uint64_t nonZeros = 0;
+
+    for (std::size_t k = 0; k < blocks.size(); k++) {
+        const ColumnBlock & block = blocks[k];
+        std::uint32_t width = block.last + 1 - block.first;
+
+        // Copy the block of B: the part of every row between its first and last columns, numbered from 0
+        std::vector<std::uint64_t> blockPtr(bRows + 1, 0);
+        std::vector<std::uint32_t> blockCols;
+        std::vector<T> blockValues;
+        blockCols.reserve(block.nonZeros);
+        blockValues.reserve(block.nonZeros);
+        for (std::uint64_t r = 0; r < bRows; r++) {
+            const std::uint32_t* first = std::lower_bound(bColIndex + bRowPtr[r], bColIndex + bRowPtr[r + 1], block.first);
+            const std::uint32_t* last = std::upper_bound(first, bColIndex + bRowPtr[r + 1], block.last);
+            for (const std::uint32_t* p = first; p != last; p++) {
+                blockCols.push_back(*p - block.first);
+                blockValues.push_back(bValues[p - bColIndex]);
+            }
+            blockPtr[r + 1] = blockCols.size();
+        }
+        for (Accumulator & accumulator : accumulators) {
+            accumulator.values.assign(width, 0);
+            accumulator.lastTouched.assign(width, 0);
+        }
+
+        // Rows of a tile: c(i,:) = sum over the non-zeros a(i,r) of a(i,r) * b(r,:), as in multiplyRow
+        auto computeTile = [&](Tile & tile, Accumulator & accumulator) {
+            tile.counts.clear();
+            tile.colIndex.clear();
+            tile.values.clear();
+            for (std::uint64_t i = tile.first; i < tile.last; i++) {
+                accumulator.touched.clear();
+                for (std::uint64_t p = aRowPtr[i]; p < aRowPtr[i + 1]; p++) {
+                    std::uint64_t r = aColIndex[p] - 1;
+                    for (std::uint64_t q = blockPtr[r]; q < blockPtr[r + 1]; q++) {
+                        std::uint32_t j = blockCols[q];
+                        if (accumulator.lastTouched[j] != i + 1) { // First contribution to column j in this row
+                            accumulator.lastTouched[j] = i + 1;
+                            accumulator.values[j] = 0;
+                            accumulator.touched.push_back(j);
+                        }
+                        accumulator.values[j] = checkedAdd(accumulator.values[j], checkedMultiply(aValues[p], blockValues[q]));
+                    }
+                }
+                std::sort(accumulator.touched.begin(), accumulator.touched.end());
+                std::uint32_t count = 0;
+                for (std::uint32_t j : accumulator.touched) {
+                    if (accumulator.values[j] != 0) { // Skip entries that cancelled out to zero
+                        tile.colIndex.push_back(block.first + j);
+                        tile.values.push_back(accumulator.values[j]);
+                        count++;
+                    }
+                }
+                tile.counts.push_back(count);
+            }
+        };
+
+        // The most bytes row i can add to a tile: its count, and an entry per entry of B it reaches, up to the width
+        auto rowBytes = [&](std::uint64_t i) {
+            std::uint64_t reached = 0;
+            for (std::uint64_t p = aRowPtr[i]; p < aRowPtr[i + 1]; p++) {
+                if (aColIndex[p] == 0 || aColIndex[p] > bRows) {
+                    throw std::out_of_range("Row or column index is out of bounds");
+                }
+                reached += blockPtr[aColIndex[p]] - blockPtr[aColIndex[p] - 1];
+            }
+            return sizeof(std::uint32_t) + std::min<std::uint64_t>(reached, width) * entryBytes;
+        };
+
+        for (const char* extension : {".rows", ".cols", ".values"}) {
+            spill.paths.push_back(spillPath(k, extension));
+        }
+        std::ofstream rowsFile(spillPath(k, ".rows"), std::ios::binary | std::ios::trunc);
+        std::ofstream colsFile(spillPath(k, ".cols"), std::ios::binary | std::ios::trunc);
+        std::ofstream valuesFile(spillPath(k, ".values"), std::ios::binary | std::ios::trunc);
+        if (!rowsFile.is_open() || !colsFile.is_open() || !valuesFile.is_open()) {
+            throw std::runtime_error("Could not open the spill files of '" + outputPath + "'");
+        }
+        BufferedWriter rowsOut(rowsFile);
+        BufferedWriter colsOut(colsFile);
+        BufferedWriter valuesOut(valuesFile);
+
+        // Cut a tile per worker, compute them together, and spill them in order
+        std::vector<Tile> tiles(workers);
+        std::uint64_t row = 0;
+        while (row < numRow) {
+            std::size_t tileCount = 0;
+            for (; tileCount < workers && row < numRow; tileCount++) {
+                Tile & tile = tiles[tileCount];
+                tile.first = row;
+                std::uint64_t bytes = 0;
+                while (row < numRow && (options.tileRows == 0 || row - tile.first < options.tileRows)) {
+                    std::uint64_t next = rowBytes(row);
+                    if (row != tile.first && bytes + next > tileBudget) {
+                        break;
+                    }
+                    bytes += next;
+                    row++;
+                }
+                tile.last = row;
+            }
+            if (threads != nullptr && tileCount > 1) {
+                for (std::size_t t = 0; t < tileCount; t++) {
+                    threads->submit([&, t]() { computeTile(tiles[t], accumulators[t]); });
+                }
+                threads->wait();
+            } else {
+                for (std::size_t t = 0; t < tileCount; t++) {
+                    computeTile(tiles[t], accumulators[0]);
+                }
+            }
+            for (std::size_t t = 0; t < tileCount; t++) {
+                const Tile & tile = tiles[t];
+                rowsOut.write(reinterpret_cast<const char*>(tile.counts.data()), tile.counts.size() * sizeof(std::uint32_t));
+                colsOut.write(reinterpret_cast<const char*>(tile.colIndex.data()), tile.colIndex.size() * sizeof(std::uint32_t));
+                valuesOut.write(reinterpret_cast<const char*>(tile.values.data()), tile.values.size() * sizeof(T));
+                nonZeros += tile.colIndex.size();
+            }
+            report(k, row);
+        }
+        rowsOut.flush();
+        colsOut.flush();
+        valuesOut.flush();
+        if (!rowsFile.flush() || !colsFile.flush() || !valuesFile.flush()) {
+            throw std::runtime_error("Could not write the spill files of '" + outputPath + "'");
+        }
+    }
+
+    // Merge the blocks into the result, reading every spill file in order once per pass
+    std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open the output file!");
+    }
+    BufferedWriter out(file);
+    BinaryMatrixFile::Header header = BinaryMatrixFile::makeHeader<T>(numRow, b.colLength(), nonZeros);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::uint64_t readerBuffer = (options.memoryLimit - SPILL_BUFFER) / (2 * std::max<std::size_t>(blocks.size(), 1));
+    readerBuffer = std::min(std::max<std::uint64_t>(readerBuffer, 4096), SPILL_BUFFER);
+    auto openReaders = [&](const char* extension) {
+        std::vector<std::unique_ptr<SpillReader>> readers;
+        for (std::size_t k = 0; k < blocks.size(); k++) {
+            readers.emplace_back(new SpillReader(spillPath(k, extension), readerBuffer));
+        }
+        return readers;
+    };
+    auto pad = [&](std::uint64_t bytes) {
+        static const char zeros[8] = {0};
+        out.write(zeros, BinaryMatrixFile::padded(bytes) - bytes);
+    };
+
+    // Pass 1: row pointers, from the counts of the row in every block
+    if (progress != nullptr) {
+        *progress << "Out-of-core multiplication: merging the row pointers" << std::endl;
+    }
+    {
+        std::vector<std::unique_ptr<SpillReader>> counts = openReaders(".rows");
+        std::uint64_t offset = 0;
+        out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        for (std::uint64_t i = 0; i < numRow; i++) {
+            for (std::unique_ptr<SpillReader> & reader : counts) {
+                std::uint32_t count;
+                reader->read(&count, sizeof(count));
+                offset += count;
+            }
+            out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        }
+    }
+
+    // Passes 2 and 3: column indices, then values, the part of every row in each block in turn
+    auto mergeEntries = [&](const char* name, const char* extension, std::size_t bytesEach) {
+        if (progress != nullptr) {
+            *progress << "Out-of-core multiplication: merging the " << name << std::endl;
+        }
+        std::vector<std::unique_ptr<SpillReader>> counts = openReaders(".rows");
+        std::vector<std::unique_ptr<SpillReader>> entries = openReaders(extension);
+        for (std::uint64_t i = 0; i < numRow; i++) {
+            for (std::size_t k = 0; k < blocks.size(); k++) {
+                std::uint32_t count;
+                counts[k]->read(&count, sizeof(count));
+                entries[k]->copyTo(out, std::uint64_t(count) * bytesEach);
+            }
+        }
+        pad(nonZeros * bytesEach);
+    };
+    mergeEntries("column indices", ".cols", sizeof(std::uint32_t));
+    mergeEntries("values", ".values", sizeof(T));
+    out.flush();
+    if (!file.flush()) {
+        throw std::runtime_error("Could not write the output file!");
+    }
+    return nonZeros;
+}
+
+/*==============================================================================================================*/
+// Explicit instantiations for the supported value types, with 32-bit indices
+template class NodePool<std::int32_t, std::uint32_t>;
+template class NodePool<std::int64_t, std::uint32_t>;
+template class NodePool<float, std::uint32_t>;
+template class NodePool<double, std::uint32_t>;
+
+template class SparseMatrix<std::int32_t, std::uint32_t>;
+template class SparseMatrix<std::int64_t, std::uint32_t>;
+template class SparseMatrix<float, std::uint32_t>;
+template class SparseMatrix<double, std::uint32_t>;
+
+template class TransposedView<std::int32_t, std::uint32_t>;
+template class TransposedView<std::int64_t, std::uint32_t>;
+template class TransposedView<float, std::uint32_t>;
+template class TransposedView<double, std::uint32_t>;
+
+template class MatrixExpression<std::int32_t, std::uint32_t>;
+template class MatrixExpression<std::int64_t, std::uint32_t>;
+template class MatrixExpression<float, std::uint32_t>;
+template class MatrixExpression<double, std::uint32_t>;
+
+template struct CompressedStorage<std::int32_t, std::uint32_t>;
+template struct CompressedStorage<std::int64_t, std::uint32_t>;
+template struct CompressedStorage<float, std::uint32_t>;
+template struct CompressedStorage<double, std::uint32_t>;
+
+template class CSRMatrix<std::int32_t, std::uint32_t>;
+template class CSRMatrix<std::int64_t, std::uint32_t>;
+template class CSRMatrix<float, std::uint32_t>;
+template class CSRMatrix<double, std::uint32_t>;
+
+template class CSCMatrix<std::int32_t, std::uint32_t>;
+template class CSCMatrix<std::int64_t, std::uint32_t>;
+template class CSCMatrix<float, std::uint32_t>;
+template class CSCMatrix<double, std::uint32_t>;
+
+// Hypersparse matrices, with 64-bit indices
+template class NodePool<std::int32_t, std::uint64_t>;
+template class NodePool<std::int64_t, std::uint64_t>;
+template class NodePool<float, std::uint64_t>;
+template class NodePool<double, std::uint64_t>;
+
+template class HypersparseMatrix<std::int32_t, std::uint64_t>;
+template class HypersparseMatrix<std::int64_t, std::uint64_t>;
+template class HypersparseMatrix<float, std::uint64_t>;
+template class HypersparseMatrix<double, std::uint64_t>;
+
+/*==============================================================================================================*/
+/**
+ * @struct RunOptions
+ * @brief Command-line options that apply to a CSV job.
+ */
+struct RunOptions {
+    bool binaryOutput = false;  ///< Export the result as `.smb` instead of CSV (`--binary`).
+    unsigned int threads = 1;   ///< Worker threads for the operations (`--threads N`), 1 runs single-threaded.
+    std::string valueType = ValueTraits<std::int32_t>::NAME;  ///< Type of the matrix values (`--type`).
+    bool stats = false;         ///< Time the phases of the run and print a summary on stderr (`--stats`).
+    DisplayMode display = DisplayMode::Auto;  ///< How the matrices are printed (`--display auto|dense|sparse|none`).
+    bool hypersparse = false;   ///< Use HypersparseMatrix even when the dimensions fit in 32 bits (`--hypersparse`).
+    std::string batch;          ///< Directory or manifest of the jobs of a batch, `-` for stdin (`--batch`).
+    unsigned int jobs = 0;      ///< Jobs of a batch run at once (`--jobs N`), 0 for one per hardware thread.
+    bool pipeline = false;      ///< Overlap the stages of a CSV job on their own threads (`--pipeline`).
+    bool outOfCore = false;     ///< Multiply `.smb` files with OutOfCoreMultiplier (`--out-of-core`).
+    OutOfCoreMultiplier::Options tiling;  ///< Budget and tiles of `--out-of-core` (`--memory-limit`, `--tile-rows`, `--tile-cols`).
+};
+
+/**
+ * @class PhaseTimer
+ * @brief Wall-clock time spent in each phase of a run, for the `--stats` summary.
+ *
+ * start() ends the running phase and starts the next one, so the calls can be dropped between the steps
+ * of a run without restructuring it. When disabled, start() and stop() return at once.
+ */
+class PhaseTimer {
+    public:
+    enum Phase { PARSE, BUILD, DISPLAY, COMPUTE, EXPORT, PHASE_COUNT };
+
+    private:
+    bool enabled;
+    int running;  ///< The running phase, or PHASE_COUNT when none.
+    std::chrono::steady_clock::time_point started;
+    double seconds[PHASE_COUNT] = {};
+
+    public:
+    explicit PhaseTimer(bool enabled) : enabled(enabled), running(PHASE_COUNT) {}
+
+    /**
+     * @brief Ends the running phase, if any, and starts `phase`.
+     */
+    void start(Phase phase) {
+        if (!enabled) {
+            return;
+        }
+        stop();
+        running = phase;
+        started = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief Ends the running phase, if any.
+     */
+    void stop() {
+        if (!enabled || running == PHASE_COUNT) {
+            return;
+        }
+        seconds[running] += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        running = PHASE_COUNT;
+    }
+
+    /**
+     * @brief Returns the seconds spent in `phase`, not counting the time since it started if it is running.
+     */
+    double elapsed(Phase phase) const {
+        return seconds[phase];
+    }
+
+    /**
+     * @brief Returns the name of `phase` in the reports.
+     */
+    static const char* name(Phase phase) {
+        static const char* const NAMES[PHASE_COUNT] = {"parse", "build", "display", "compute", "export"};
+        return NAMES[phase];
+    }
+
+    /**
+     * @brief Writes the time of every phase and the total, followed by the counters of matrixStats().
+     */
+    void report(std::ostream & out) {
+        stop();
+        double total = 0;
+        out << "---Stats---" << std::endl;
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            const char* phaseName = name(static_cast<Phase>(phase));
+            out << phaseName << std::string(10 - std::strlen(phaseName), ' ') << seconds[phase] * 1e3 << " ms" << std::endl;
+            total += seconds[phase];
+        }
+        out << "total     " << total * 1e3 << " ms" << std::endl;
+        matrixStats().report(out);
+    }
+};
+
+/**
+ * @brief Calls `job` with a zero of the value type named `valueType`, so that it can instantiate the
+ * matrices with that type.
+ *
+ * @param const std::string & valueType One of int32, int64, float or double.
+ * @param Job job A generic callable taking the zero and returning the exit code.
+ *
+ * @return int The exit code of `job`, or 1 if the type is unknown.
+ */
+template <typename Job>
+static int withValueType(const std::string & valueType, Job job) {
+    if (valueType == ValueTraits<std::int32_t>::NAME) {
+        return job(std::int32_t(0));
+    }
+    if (valueType == ValueTraits<std::int64_t>::NAME) {
+        return job(std::int64_t(0));
+    }
+    if (valueType == ValueTraits<float>::NAME) {
+        return job(float(0));
+    }
+    if (valueType == ValueTraits<double>::NAME) {
+        return job(double(0));
+    }
+    std::cerr << "Error: unknown value type '" << valueType << "', expected int32, int64, float or double." << std::endl;
+    return 1;
+}
+
+/**
+ * @brief Writes the result of an operation, as CSV or in the binary format.
+ *
+ * @param SparseMatrix<T> & result The matrix to write.
+ * @param const std::string & filePath The input file the output name is derived from.
+ * @param bool binaryOutput true to write `<name>_output.smb` with exportToBinary instead of the CSV file.
+ * @param std::ostream & out Stream the confirmation message is printed to.
+ */
+template <typename T>
+static void exportResult(SparseMatrix<T> & result, const std::string & filePath, bool binaryOutput, std::ostream & out) {
+    if (!binaryOutput) {
+        result.exportToCSV(filePath, out); // Export Result
+        return;
+    }
+    std::string outputPath = SparseMatrix<T>::outputFilePath(filePath);
+    outputPath.replace(outputPath.rfind('.'), std::string::npos, ".smb"); // Job files always end in .csv
+    result.exportToBinary(outputPath);
+    out << "Data exported successfully to " << "'" << outputPath<< "'" << std::endl;
+}
+
+/**
+ * @brief Writes the result of a hypersparse operation as CSV. There is no binary form of such a matrix.
+ *
+ * @throws std::runtime_error if `binaryOutput` is set.
+ */
+template <typename T>
+static void exportResult(HypersparseMatrix<T> & result, const std::string & filePath, bool binaryOutput, std::ostream & out) {
+    if (binaryOutput) {
+        throw std::runtime_error("Hypersparse matrices cannot be exported in the binary format, drop --binary");
+    }
+    result.exportToCSV(filePath, out);
+}
+
+/**
+ * @brief Reads the next section of a job file and builds the matrix it holds, in the parse and build phases.
+ *
+ * With a thread pool the lines of a SparseMatrix are parsed in chunks on the threads and merged by the
+ * parallel sort-and-build of fromTriplets; otherwise they are read and built on the calling thread.
+ *
+ * @param ThreadPool * threads The threads of the job, or nullptr.
+ *
+ * @return Matrix The matrix, `numRow` x `numCol`.
+ */
+template <typename T, typename Index, typename Matrix>
+static Matrix readMatrix(MatrixFileParser & parser, Index numRow, Index numCol, ThreadPool * threads, PhaseTimer & phases) {
+    typedef typename Matrix::Triplet Triplet;
+    phases.start(PhaseTimer::PARSE);
+    if constexpr (std::is_same<Matrix, SparseMatrix<T, Index>>::value) {
+        if (threads != nullptr) {
+            std::vector<std::vector<Triplet>> buffers;
+            parser.readSection(buffers, *threads);
+            phases.start(PhaseTimer::BUILD);
+            return Matrix::fromTriplets(numRow, numCol, buffers, *threads);
+        }
+    }
+    std::vector<Triplet> triplets;
+    parser.readSection(triplets);
+    phases.start(PhaseTimer::BUILD);
+    return Matrix::fromTriplets(numRow, numCol, triplets);
+}
+
+/**
+ * @brief Runs the operation of a CSV job whose header was read: reads the matrices, prints them, computes
+ * the result, prints it and exports it.
+ *
+ * @param MatrixFileParser & parser The job file, positioned on the first line of matrix A.
+ * @param const JobHeader & header The operation and the dimensions, which must fit in Index.
+ * @param ThreadPool * threads The pool of the job, or nullptr to run on the calling thread.
+ * @param PhaseTimer & phases Timer of the run, in the parse phase.
+ * @param std::ostream & out Stream the matrices and messages are printed to.
+ */
+template <typename T, typename Index, typename Matrix>
+static void runCSVOperation(MatrixFileParser & parser, const JobHeader & header, const std::string & filePath,
+                            const RunOptions & options, ThreadPool * threads, PhaseTimer & phases, std::ostream & out) {
+    char operation = header.operation;
+    Index numRow = static_cast<Index>(header.numRow);
+    Index numCol = static_cast<Index>(header.numCol);
+    bool binaryOutput = options.binaryOutput;
+
+    if(operation == 'A' || operation == 'M') {
+        // Get data for aMatrix and bMatrix, built in bulk once read. B has the shape of A for an
+        // addition, and numCol x numColB rows for a multiplication
+        Index bRows = operation == 'A' ? numRow : numCol;
+        Index bCols = operation == 'A' ? numCol : static_cast<Index>(header.numColB);
+        Matrix aMatrix = readMatrix<T, Index, Matrix>(parser, numRow, numCol, threads, phases);
+        phases.start(PhaseTimer::DISPLAY);
+        aMatrix.display(options.display, out); //Display aMatrix
+
+        out << "-----------"<< std::endl;
+        Matrix bMatrix = readMatrix<T, Index, Matrix>(parser, bRows, bCols, threads, phases);
+        phases.start(PhaseTimer::DISPLAY);
+        bMatrix.display(options.display, out); //Display bMatrix
+
+        // Compute Results
+        out << "---Result---"<< std::endl;
+        if (operation == 'A') {
+            phases.start(PhaseTimer::COMPUTE);
+            Matrix resultMatrix = threads ? Matrix::matrixAddition(aMatrix,bMatrix,*threads)
+                                                : Matrix::matrixAddition(aMatrix,bMatrix);
+            phases.start(PhaseTimer::DISPLAY);
+            resultMatrix.display(options.display, out); //Print result
+            phases.start(PhaseTimer::EXPORT);
+            exportResult(resultMatrix, filePath, binaryOutput, out);
+        }
 
-    // Traverse and find the correct position in the row based on the column index
-    while (rowNode->nextCol != this->rowHeaders[rowIndex] && rowNode->nextCol->colIndex < colIndex) {
-        rowNode = rowNode->nextCol;
-    }
+        if (operation == 'M') {
+            phases.start(PhaseTimer::COMPUTE);
+            Matrix resultMatrix = threads ? Matrix::matrixMultiplication(aMatrix,bMatrix,*threads)
+                                                : Matrix::matrixMultiplication(aMatrix,bMatrix);
+            phases.start(PhaseTimer::DISPLAY);
+            resultMatrix.display(options.display, out); //Print result
+            phases.start(PhaseTimer::EXPORT);
+            exportResult(resultMatrix, filePath, binaryOutput, out);
+        }
 
-    // If the node already exists at the position (rowIndex, colIndex), update its data
-    if (rowNode->nextCol != this->rowHeaders[rowIndex] && rowNode->nextCol->colIndex == colIndex) {
-        rowNode->nextCol->data = data;  // Update the existing node's data
-        return;
-    }
+    } // End of If (A or M)
 
-    // If no node existed, create a new node for the matrix
-    Node* newNode = new Node(data, rowIndex, colIndex);
+    if(operation == 'T' || operation == 'S') {
+        // Get data for aMatrix, built in bulk once read
+        Matrix aMatrix = readMatrix<T, Index, Matrix>(parser, numRow, numCol, threads, phases);
+        phases.start(PhaseTimer::DISPLAY);
+        aMatrix.display(options.display, out); //Display aMatrix
 
-    // Insert the new node into the row
-    newNode->nextCol = rowNode->nextCol;  // Link to the next node in the row
-    rowNode->nextCol = newNode;  // Link the previous node to the new node
+        //Compute and print Result
+        out << "---Result---"<< std::endl;
+        if (operation == 'S') {
+            phases.start(PhaseTimer::PARSE);
+            T scalar = 0;
+            if (parser.readScalar(scalar)) {
+                out << "Scalar: " << scalar << std::endl;
+            }
+            phases.start(PhaseTimer::COMPUTE);
+            Matrix resultMatrix = threads ? Matrix::matrixScalarMultiplication(aMatrix,scalar,*threads)
+                                                : Matrix::matrixScalarMultiplication(aMatrix,scalar);
+            phases.start(PhaseTimer::DISPLAY);
+            resultMatrix.display(options.display, out); //Print result
+            phases.start(PhaseTimer::EXPORT);
+            exportResult(resultMatrix, filePath, binaryOutput, out);
+        }
 
-    //=============================================================================================//
+        if(operation == 'T') {
+            phases.start(PhaseTimer::COMPUTE);
+            Matrix resultMatrix = Matrix::matrixTransposition(aMatrix);
+            phases.start(PhaseTimer::DISPLAY);
+            resultMatrix.display(options.display, out); //Print result
+            phases.start(PhaseTimer::EXPORT);
+            exportResult(resultMatrix, filePath, binaryOutput, out);
+        }
+    }// End of If (S or T)
+}
 
-    // ===== Insert into the column ===== //
-    // Start at the colum placeholder
-    Node* colNode = this->colHeaders[colIndex];  
+/**
+ * @brief Runs an `E` job whose header and expression were read: reads the matrices A, B, ... in order, prints
+ * them, evaluates the expression with the fused kernels of MatrixExpression, prints the result and exports it.
+ *
+ * Every matrix has the dimensions of the header. The matrices and messages are printed to `out`.
+ *
+ * @throws std::invalid_argument If the expression is invalid or its dimensions do not match.
+ */
+template <typename T>
+static void runExpressionJob(MatrixFileParser & parser, const JobHeader & header, const std::string & expression,
+                             const std::string & filePath, const RunOptions & options, ThreadPool * threads,
+                             PhaseTimer & phases, std::ostream & out) {
+    typedef SparseMatrix<T> Matrix;
 
-    // Traverse and find the correct position in the column based on the row index
-    while (colNode->nextRow != this->colHeaders[colIndex] && colNode->nextRow->rowIndex < rowIndex) {
-        colNode = colNode->nextRow;
+    // Read every matrix up to the end of the file
+    std::deque<Matrix> matrices; // Never moves its elements, so the expression can point to them
+    std::vector<const Matrix*> operands;
+    while (!parser.atEnd()) {
+        matrices.push_back(readMatrix<T, std::uint32_t, Matrix>(parser, static_cast<std::uint32_t>(header.numRow),
+                                                                static_cast<std::uint32_t>(header.numCol), threads, phases));
+        operands.push_back(&matrices.back());
+        phases.start(PhaseTimer::DISPLAY);
+        if (operands.size() > 1) {
+            out << "-----------"<< std::endl;
+        }
+        matrices.back().display(options.display, out);
     }
 
-    // Insert the new node into the column
-    newNode->nextRow = colNode->nextRow;  // Link to the next node in the column
-    colNode->nextRow = newNode;  // Link the previous node to the new node
+    // Compute Result
+    out << "---Result---"<< std::endl;
+    phases.start(PhaseTimer::COMPUTE);
+    MatrixExpression<T> chain = MatrixExpression<T>::parse(expression, operands);
+    Matrix resultMatrix = threads ? chain.evaluate(*threads) : chain.evaluate();
+    phases.start(PhaseTimer::DISPLAY);
+    resultMatrix.display(options.display, out); //Print result
+    phases.start(PhaseTimer::EXPORT);
+    exportResult(resultMatrix, filePath, options.binaryOutput, out);
 }
 
-// Implementation of remove method
-void SparseMatrix::remove(int rowIndex, int colIndex) {
-    // Check for out-of-bounds indices
-    if (rowIndex <= 0 || rowIndex > this->numRow || colIndex <= 0 || colIndex > this->numCol) {
-        throw std::out_of_range("Row or column index is out of bounds");
+/**
+ * @brief Runs a CSV job whose header was read as a pipeline of stages on their own threads, linked by bounded
+ * queues (`--pipeline`).
+ *
+ * The calling thread parses the matrices one section at a time while a builder thread builds and prints the
+ * section before, so building A overlaps with parsing B. The operation is then evaluated row by row as a
+ * MatrixExpression (A+B, A*B, k*A, Aᵀ, or the expression of an `E` job), and the finished rows go in batches
+ * to an exporter thread that writes the CSV file while the next rows are computed. At most one parsed section
+ * and QUEUED_BATCHES batches of rows wait between two stages.
+ *
+ * The result is only built when it is displayed (any mode but `none`) or exported in the binary format,
+ * which is written once the result is complete since its row pointers come first. With `--threads` the
+ * builder uses the thread pool. The phases of `--stats` are those of the calling thread, so the work of the
+ * stages it overlaps is not counted twice.
+ *
+ * @throws std::invalid_argument If the expression of an `E` job is invalid.
+ */
+template <typename T>
+static void runPipelinedJob(MatrixFileParser & parser, const JobHeader & header, const std::string & expression,
+                            const std::string & filePath, const RunOptions & options, ThreadPool * threads,
+                            PhaseTimer & phases, std::ostream & out) {
+    typedef SparseMatrix<T> Matrix;
+    typedef typename Matrix::Triplet Triplet;
+    typedef typename MatrixExpression<T>::Entry Entry;
+    const std::size_t BATCH_ENTRIES = std::size_t(1) << 16;  // Entries per batch of result rows
+    const std::size_t QUEUED_BATCHES = 8;                    // Batches waiting for the exporter at most
+
+    char operation = header.operation;
+    if (std::strchr("AMSTE", operation) == nullptr) {
+        return; // Nothing to compute, as in runCSVOperation
     }
 
-    // ===== Remove from the row =====
-    Node* prevRowNode = this->rowHeaders[rowIndex];
-    Node* toRemoveRowNode = prevRowNode->nextCol;
+    // Parse -> build: the builder thread builds and prints every section while the next one is parsed
+    std::deque<Matrix> matrices; // Never moves its elements, so the expression can point to them
+    BoundedQueue<std::vector<Triplet>> sections(1);
+    std::exception_ptr buildError;
+    std::thread builder([&]() {
+        std::vector<Triplet> triplets;
+        for (std::size_t k = 0; sections.pop(triplets); k++) {
+            if (buildError) {
+                continue; // Drain the queue after an error
+            }
+            try {
+                // B has numCol x numColB elements in a multiplication, every other matrix the header size
+                std::uint32_t numRow = static_cast<std::uint32_t>(operation == 'M' && k == 1 ? header.numCol : header.numRow);
+                std::uint32_t numCol = static_cast<std::uint32_t>(operation == 'M' && k == 1 ? header.numColB : header.numCol);
+                matrices.push_back(threads ? Matrix::fromTriplets(numRow, numCol, triplets, *threads)
+                                           : Matrix::fromTriplets(numRow, numCol, triplets));
+                if (k > 0) {
+                    out << "-----------"<< std::endl;
+                }
+                matrices.back().display(options.display, out);
+            } catch (...) {
+                buildError = std::current_exception();
+            }
+        }
+    });
 
-    // Traverse and find the node to remove in the row
-    while (toRemoveRowNode != this->rowHeaders[rowIndex] && toRemoveRowNode->colIndex < colIndex) {
-        prevRowNode = toRemoveRowNode;
-        toRemoveRowNode = toRemoveRowNode->nextCol;
+    std::size_t sectionCount = operation == 'A' || operation == 'M' ? 2 : 1;
+    T scalar = 0;
+    bool hasScalar = false;
+    phases.start(PhaseTimer::PARSE);
+    try {
+        for (std::size_t k = 0; operation == 'E' ? !parser.atEnd() : k < sectionCount; k++) {
+            std::vector<Triplet> triplets;
+            parser.readSection(triplets);
+            sections.push(std::move(triplets));
+        }
+        if (operation == 'S') {
+            hasScalar = parser.readScalar(scalar);
+        }
+    } catch (...) {
+        sections.close();
+        builder.join();
+        throw;
+    }
+    sections.close();
+    phases.start(PhaseTimer::BUILD);
+    builder.join();
+    if (buildError) {
+        std::rethrow_exception(buildError);
     }
 
-    // If the node is found in the row list
-    if (toRemoveRowNode != this->rowHeaders[rowIndex] && toRemoveRowNode->colIndex == colIndex) {
-        prevRowNode->nextCol = toRemoveRowNode->nextCol;  // Remove node from row
-    } else {
-        return;  // Node not found
+    // Compute Result
+    out << "---Result---"<< std::endl;
+    if (hasScalar) {
+        out << "Scalar: " << scalar << std::endl;
+    }
+    phases.start(PhaseTimer::COMPUTE);
+    std::vector<const Matrix*> operands;
+    for (const Matrix & matrix : matrices) {
+        operands.push_back(&matrix);
+    }
+    MatrixExpression<T> chain = operation == 'E' ? MatrixExpression<T>::parse(expression, operands)
+                              : operation == 'A' ? MatrixExpression<T>(matrices[0]) + MatrixExpression<T>(matrices[1])
+                              : operation == 'M' ? MatrixExpression<T>(matrices[0]) * MatrixExpression<T>(matrices[1])
+                              : operation == 'S' ? scalar * MatrixExpression<T>(matrices[0])
+                              : MatrixExpression<T>(matrices[0]).transposed();
+    if (options.binaryOutput) {
+        Matrix resultMatrix = chain.evaluate();
+        phases.start(PhaseTimer::DISPLAY);
+        resultMatrix.display(options.display, out); //Print result
+        phases.start(PhaseTimer::EXPORT);
+        exportResult(resultMatrix, filePath, true, out);
+        return;
     }
 
-    // ===== Remove from the column =====
-    Node* prevColNode = this->colHeaders[colIndex];
-    Node* toRemoveColNode = prevColNode->nextRow;
+    // Compute -> export: the exporter thread writes every batch of rows while the next one is computed
+    std::string outputPath = Matrix::outputFilePath(filePath);
+    BoundedQueue<std::vector<Triplet>> batches(QUEUED_BATCHES);
+    std::thread exporter([&]() {
+        std::ofstream file(outputPath, std::ios::trunc);
+        BufferedWriter writer(file);
+        std::vector<Triplet> batch;
+        while (batches.pop(batch)) {
+            for (const Triplet & t : batch) {
+                writer.writeNumber(t.rowIndex);
+                writer.put(',');
+                writer.writeNumber(t.colIndex);
+                writer.put(',');
+                writer.writeNumber(t.data);
+                writer.put('\n');
+            }
+        }
+        writer.flush();
+    });
 
-    // Traverse and find the node to remove in the column
-    while (toRemoveColNode != this->colHeaders[colIndex] && toRemoveColNode->rowIndex < rowIndex) {
-        prevColNode = toRemoveColNode;
-        toRemoveColNode = toRemoveColNode->nextRow;
+    std::unique_ptr<Matrix> resultMatrix;
+    if (options.display != DisplayMode::None) {
+        resultMatrix.reset(new Matrix(chain.rowLength(), chain.colLength()));
     }
-
-    // If the node is found in the column list
-    if (toRemoveColNode != this->colHeaders[colIndex] && toRemoveColNode->rowIndex == rowIndex) {
-        prevColNode->nextRow = toRemoveColNode->nextRow;  // Remove node from column
+    std::vector<Triplet> batch;
+    batch.reserve(BATCH_ENTRIES);
+    try {
+        chain.evaluateRows([&](std::uint32_t i, const std::vector<Entry> & entries) {
+            for (const Entry & entry : entries) {
+                batch.push_back(Triplet(entry.second, i, entry.first));
+            }
+            if (batch.size() >= BATCH_ENTRIES) {
+                batches.push(std::move(batch));
+                batch = std::vector<Triplet>();
+                batch.reserve(BATCH_ENTRIES);
+            }
+        }, resultMatrix.get());
+        batches.push(std::move(batch));
+    } catch (...) { // No partial output file is left behind
+        batches.close();
+        exporter.join();
+        std::remove(outputPath.c_str());
+        throw;
     }
-
-    // Free the memory of the node
-    delete toRemoveRowNode;  // Only need to delete once since row and column point to the same node
+    batches.close();
+    phases.start(PhaseTimer::EXPORT);
+    exporter.join();
+    if (resultMatrix) {
+        phases.start(PhaseTimer::DISPLAY);
+        resultMatrix->display(options.display, out); //Print result
+    }
+    out << "Data exported successfully to " << "'" << outputPath<< "'" << std::endl;
 }
 
-// Implementation of display method
-void SparseMatrix::display() {
-    // Iterate over each row
-    for (int i = 1; i <= numRow; ++i) {
-        Node* current = rowHeaders[i]->nextCol;  // Skip the placeholder and start with the first actual node
+/**
+ * @brief Runs the job described by a CSV file: reads the operation and the matrices, prints them, computes
+ * the result, prints it and exports it.
+ *
+ * The values of the matrices, and the scalar, are read as T. The matrices are SparseMatrix objects, or
+ * HypersparseMatrix objects with `--hypersparse` or when a dimension does not fit in 32 bits. An `E` job
+ * evaluates the expression on its second line over the matrices that follow (see runExpressionJob).
+ *
+ * @param const std::string & filePath Path of the CSV job file.
+ * @param const RunOptions & options The output format and the display mode.
+ * @param ThreadPool * threads The pool the matrices are parsed, built and computed on, or nullptr to run on the
+ *        calling thread. A batch worker passes the same pool to all of its jobs.
+ * @param PhaseTimer & phases Timer the phases of the job are added to.
+ * @param std::ostream & out Stream the matrices and messages are printed to.
+ * @param std::ostream & err Stream errors are printed to.
+ *
+ * @return int 0 on success, or 1 if the file could not be read or an integer result overflowed.
+ */
+template <typename T>
+static int runCSVJob(const std::string & filePath, const RunOptions & options, ThreadPool * threads, PhaseTimer & phases,
+                     std::ostream & out, std::ostream & err) {
+    int status = 0;
+    try {
+        // Map the csv file
+        phases.start(PhaseTimer::PARSE);
+        MatrixFileParser parser(filePath);
 
-        // Iterate over each column in this row
-        for (int j = 1; j <= numCol; ++j) {
-            // If current is not header and it's the correct column, print the data
-            if (current != rowHeaders[i] && current->colIndex == j) { 
-                std::cout << current->data << " ";
-                current = current->nextCol;  // Move to the next node in the row
-            } else {
-                // Otherwise, print 0 (sparse matrix)
-                std::cout << "0 ";
+        // Read the first line from the file; non-square sizes are echoed in full
+        JobHeader header;
+        parser.readHeader(header);
+        out << header.operation << " " << header.numRow;
+        if (header.numCol != header.numRow || header.numColB != header.numCol) {
+            out << " " << header.numCol;
+            if (header.operation == 'M') {
+                out << " " << header.numColB;
             }
         }
-        // Move to the next row after printing all columns in this row
-        std::cout << std::endl;
+        out << std::endl;
+
+        // The second line is the expression of an E job, otherwise a separator
+        std::string expression;
+        if (header.operation == 'E') {
+            parser.readLine(expression);
+            out << expression << std::endl;
+        } else {
+            parser.skipLine();
+        }
+        out << "============="<< std::endl;
+
+        std::uint64_t largest = std::max(header.numRow, std::max(header.numCol, header.numColB));
+        bool hypersparse = options.hypersparse || largest > std::numeric_limits<std::uint32_t>::max();
+        if (header.operation == 'E' && hypersparse) {
+            throw std::runtime_error("Expression jobs need dimensions that fit in 32 bits, and no --hypersparse");
+        }
+        if (options.pipeline && !hypersparse) {
+            runPipelinedJob<T>(parser, header, expression, filePath, options, threads, phases, out);
+        } else if (header.operation == 'E') {
+            runExpressionJob<T>(parser, header, expression, filePath, options, threads, phases, out);
+        } else if (hypersparse) {
+            runCSVOperation<T, std::uint64_t, HypersparseMatrix<T>>(parser, header, filePath, options, threads, phases, out);
+        } else {
+            runCSVOperation<T, std::uint32_t, SparseMatrix<T>>(parser, header, filePath, options, threads, phases, out);
+        }
+    } catch (const std::runtime_error & e) { // The file could not be opened, or an integer overflowed
+        err << e.what() << std::endl;
+        status = 1;
+    } catch (const std::invalid_argument & e) { // An invalid expression
+        err << "Error: " << e.what() << std::endl;
+        status = 1;
     }
+    phases.stop();
+    return status;
 }
 
-// Implementation of matrixAddition method
-SparseMatrix SparseMatrix::matrixAddition(const SparseMatrix & a, const SparseMatrix & b) {
-    // Check the size
-    if (a.colLength() != b.colLength() || a.rowLength() != b.rowLength()) {
-        throw std::invalid_argument("Matrices must be equal in size");
+/**
+ * @brief Loads an operand of a file operation, picking the reader from the file extension.
+ *
+ * @param const std::string & filePath Path of a `.smb` binary matrix file or a `.mtx` Matrix Market file.
+ *
+ * @return SparseMatrix<T> The loaded matrix.
+ *
+ * @throws std::runtime_error if the file cannot be read, its format is not supported, or a `.smb` file
+ * holds values of another type.
+ */
+template <typename T>
+static SparseMatrix<T> loadMatrixFile(const std::string & filePath) {
+    size_t dotPosition = filePath.rfind('.');
+    std::string extension = dotPosition == std::string::npos ? "" : filePath.substr(dotPosition);
+    if (extension == ".smb") {
+        return BinaryMatrixFile(filePath).toSparseMatrix<T>();
     }
-    SparseMatrix c(a.rowLength(),a.colLength());
-        // Adding elements
-    int sum = 0;
-    for(int i = 1; i <= c.rowLength(); i++) {
-        for(int j = 1; j <= c.numCol; j++) {
-            sum = a.access(i,j) + b.access(i,j);
-            c.insert(sum,i,j);
+    if (extension == ".mtx") {
+        return SparseMatrix<T>::importMatrixMarket(filePath);
+    }
+    throw std::runtime_error("Unsupported matrix file format: " + filePath);
+}
+
+/**
+ * @brief Runs a multiplication of two `.smb` files out of core (`--op M --out-of-core`), and writes the result
+ * next to the first one as `<name>_output.smb`. Progress lines go to stderr.
+ *
+ * @param const std::vector<std::string> & operands The two matrix files.
+ * @param const RunOptions & options The memory budget and tile sizes, the threads, and whether to print the
+ *        `--stats` summary.
+ *
+ * @return int 0 on success, or 1 on invalid input.
+ */
+template <typename T>
+static int runOutOfCoreMultiplication(const std::vector<std::string> & operands, const RunOptions & options) {
+    PhaseTimer phases(options.stats);
+    int status = 0;
+    try {
+        std::unique_ptr<ThreadPool> threads;
+        if (options.threads > 1) {
+            threads.reset(new ThreadPool(options.threads));
         }
+        phases.start(PhaseTimer::PARSE); // Only maps the files
+        BinaryMatrixFile aFile(operands[0]);
+        BinaryMatrixFile bFile(operands[1]);
+        phases.start(PhaseTimer::COMPUTE); // The result is exported as it is computed
+        std::string outputPath = SparseMatrix<T>::outputFilePath(operands[0]);
+        OutOfCoreMultiplier::multiply<T>(aFile, bFile, outputPath, options.tiling, threads.get(), &std::cerr);
+        phases.stop();
+        std::cout << "Data exported successfully to " << "'" << outputPath<< "'" << std::endl;
+    } catch (const std::exception & e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        status = 1;
     }
-    return c;
+    if (options.stats) {
+        phases.report(std::cerr);
+    }
+    return status;
 }
 
-// Implementation of matrixMultiplication method
-SparseMatrix SparseMatrix::matrixMultiplication(const SparseMatrix & a, const SparseMatrix & b){
-    // Check the size of both matrices
-    if (a.colLength() != b.rowLength() ) {
-        throw std::invalid_argument("Number of col in matrix 'a' must be equal to number of row in matrix 'b'");
+/**
+ * @brief Runs one operation on matrix files given on the command line, and writes the result next to the
+ * first operand as `<name>_output.<ext>` in the same format.
+ *
+ * @param char operation One of A, M, T or S.
+ * @param const std::vector<std::string> & operands The matrix files, then the scalar for S.
+ * @param const RunOptions & options The value type and whether to print the `--stats` summary.
+ *
+ * @return int 0 on success, or 1 on invalid input.
+ */
+template <typename T>
+static int runFileOperation(char operation, const std::vector<std::string> & operands, const RunOptions & options) {
+    typedef SparseMatrix<T> Matrix;
+    bool twoMatrices = operation == 'A' || operation == 'M';
+    if ((operation != 'A' && operation != 'M' && operation != 'T' && operation != 'S')
+        || operands.size() != (operation == 'T' ? 1u : 2u)) {
+        std::cerr << "Error: expected A or M with two matrix files, T with one, or S with one and a scalar." << std::endl;
+        return 1;
     }
-    // Create the result matrix
-    SparseMatrix c(a.rowLength(),b.colLength());
-    
-    for(int i = 1; i <= a.rowLength(); i++) {
-        for(int j = 1; j <= b.colLength(); j++){
-            int prod = 0;
-            for (int k = 1; k <= a.colLength(); k++) {
-                prod += a.access(i,k) * b.access(k,j);
-                c.insert(prod,i,j);
-            }
+    if (options.outOfCore) {
+        auto isBinary = [](const std::string & path) { return path.size() >= 4 && path.compare(path.size() - 4, 4, ".smb") == 0; };
+        if (operation != 'M' || !isBinary(operands[0]) || !isBinary(operands[1])) {
+            std::cerr << "Error: --out-of-core multiplies two .smb files (--op M)." << std::endl;
+            return 1;
         }
+        return runOutOfCoreMultiplication<T>(operands, options);
     }
+    PhaseTimer phases(options.stats);
+    int status = 0;
+    try {
+        phases.start(PhaseTimer::PARSE); // Loading a file parses and builds the matrix in one step
+        Matrix aMatrix = loadMatrixFile<T>(operands[0]);
+        Matrix result = [&]() {
+            if (twoMatrices) {
+                Matrix bMatrix = loadMatrixFile<T>(operands[1]);
+                phases.start(PhaseTimer::COMPUTE);
+                return operation == 'A' ? Matrix::matrixAddition(aMatrix, bMatrix)
+                                        : Matrix::matrixMultiplication(aMatrix, bMatrix);
+            }
+            if (operation == 'S') {
+                T scalar = 0;
+                const char* field = operands[1].c_str();
+                MatrixFileParser::parseField(field, field + operands[1].size(), scalar);
+                phases.start(PhaseTimer::COMPUTE);
+                return Matrix::matrixScalarMultiplication(aMatrix, scalar);
+            }
+            phases.start(PhaseTimer::COMPUTE);
+            return Matrix::matrixTransposition(aMatrix);
+        }();
 
-    return c;
-
+        phases.start(PhaseTimer::EXPORT);
+        std::string outputPath = Matrix::outputFilePath(operands[0]);
+        if (outputPath.size() >= 4 && outputPath.compare(outputPath.size() - 4, 4, ".mtx") == 0) {
+            result.exportToMatrixMarket(outputPath);
+        } else {
+            result.exportToBinary(outputPath);
+        }
+        std::cout << "Data exported successfully to " << "'" << outputPath<< "'" << std::endl;
+    } catch (const std::exception & e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        status = 1;
+    }
+    if (options.stats) {
+        phases.report(std::cerr);
+    }
+    return status;
 }
 
-// Implementaion of matrixTransposition method
-SparseMatrix SparseMatrix::matrixTransposition(const SparseMatrix & a) {
-    //Initialize new matrix
-    SparseMatrix b(a.colLength(), a.rowLength());
+/**
+ * @brief Runs many CSV jobs in one process, on a bounded pool of worker threads.
+ *
+ * Each worker takes the next job of the list until none is left, so at most `options.jobs` jobs run at once.
+ * A job runs as runCSVJob, with its output kept aside and printed whole after a `==> path <==` line once it
+ * finishes, so the output of jobs running together never interleaves. Every worker holds a SlabCache, so a
+ * job builds its matrices in the node slabs of the previous job on the same worker rather than allocating
+ * new ones. With `--threads N` every worker also keeps one ThreadPool of N threads for all of its jobs, whose
+ * threads share the worker's SlabCache, instead of starting and joining N threads per job. At the end a summary
+ * on stderr gives the status and the time of every phase of each job, in the order of the list, followed by the
+ * totals.
+ *
+ * @param const std::vector<std::string> & jobs The paths of the CSV job files.
+ * @param const RunOptions & options The options of every job, and the number of workers.
+ *
+ * @return int 0 if every job succeeded, or 1 otherwise.
+ */
+template <typename T>
+static int runBatch(const std::vector<std::string> & jobs, const RunOptions & options) {
+    /**
+     * @struct JobReport
+     * @brief The outcome of one job, for the summary.
+     */
+    struct JobReport {
+        int status = 1;
+        double phaseSeconds[PhaseTimer::PHASE_COUNT] = {};
+        double seconds = 0;
+    };
 
-    for(int i = 1; i <= a.rowLength(); i++) {
-        for(int j = 1; j <= a.colLength(); j++) {
-            b.insert(a.access(i, j), j, i); 
+    unsigned int workerCount = options.jobs != 0 ? options.jobs : std::max(1u, std::thread::hardware_concurrency());
+    workerCount = static_cast<unsigned int>(std::min<std::size_t>(workerCount, std::max<std::size_t>(jobs.size(), 1)));
+    std::vector<JobReport> reports(jobs.size());
+    std::atomic<std::size_t> nextJob{0};
+    std::mutex outputMutex;
+    std::chrono::steady_clock::time_point batchStart = std::chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        SlabCache slabs; // Shared by the jobs of this worker, and the threads of its pool
+        std::unique_ptr<ThreadPool> threads;
+        if (options.threads > 1) {
+            threads.reset(new ThreadPool(options.threads, &slabs));
         }
-    }
+        for (std::size_t index = nextJob++; index < jobs.size(); index = nextJob++) {
+            const std::string & filePath = jobs[index];
+            JobReport & report = reports[index];
+            std::ostringstream out;
+            std::ostringstream err;
+            PhaseTimer phases(true);
+            std::chrono::steady_clock::time_point jobStart = std::chrono::steady_clock::now();
 
-    return b;
-}
+            std::size_t dotPosition = filePath.rfind('.');
+            if (dotPosition == std::string::npos || filePath.substr(dotPosition) != ".csv") {
+                err << "Error: The input file must be a .csv file." << std::endl;
+            } else {
+                try {
+                    report.status = runCSVJob<T>(filePath, options, threads.get(), phases, out, err);
+                } catch (const std::exception & e) { // Anything runCSVJob leaves, e.g. an index out of range
+                    phases.stop();
+                    err << "Error: " << e.what() << std::endl;
+                    report.status = 1;
+                }
+            }
 
-// Implementation of matrixScalarMultiplication method
-SparseMatrix SparseMatrix::matrixScalarMultiplication(const SparseMatrix & a, int k){
-    //Initialize new matrix
-    SparseMatrix b(a.rowLength(),a.colLength());
-    for(int i = 1; i <= a.rowLength(); i++) {
-        for(int j = 1; j <= a.colLength(); j++) {
-            b.insert(a.access(i,j)*k,i,j);
+            report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - jobStart).count();
+            for (int phase = 0; phase < PhaseTimer::PHASE_COUNT; phase++) {
+                report.phaseSeconds[phase] = phases.elapsed(static_cast<PhaseTimer::Phase>(phase));
+            }
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << "==> " << filePath << " <==" << '\n' << out.str() << std::flush;
+            std::cerr << err.str() << std::flush;
         }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < workerCount; i++) {
+        workers.emplace_back(worker);
+    }
+    worker(); // The main thread is one of the workers
+    for (std::thread & thread : workers) {
+        thread.join();
     }
+    double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStart).count();
 
-    return b;
+    // Summary, as CSV lines after a title line
+    std::size_t failed = 0;
+    std::cerr << "---Batch---" << '\n' << "job,status";
+    for (int phase = 0; phase < PhaseTimer::PHASE_COUNT; phase++) {
+        std::cerr << ',' << PhaseTimer::name(static_cast<PhaseTimer::Phase>(phase)) << "_ms";
+    }
+    std::cerr << ",total_ms" << '\n';
+    for (std::size_t index = 0; index < jobs.size(); index++) {
+        const JobReport & report = reports[index];
+        failed += report.status != 0;
+        std::cerr << jobs[index] << ',' << report.status;
+        for (double seconds : report.phaseSeconds) {
+            std::cerr << ',' << seconds * 1e3;
+        }
+        std::cerr << ',' << report.seconds * 1e3 << '\n';
+    }
+    std::cerr << "jobs " << jobs.size() << ", failed " << failed << ", workers " << workerCount << ", "
+              << batchSeconds * 1e3 << " ms, " << (batchSeconds > 0 ? jobs.size() / batchSeconds : 0) << " jobs/s" << std::endl;
+    if (options.stats) { // The counters cover the whole batch
+        matrixStats().report(std::cerr);
+    }
+    return failed == 0 ? 0 : 1;
 }
 
-// Implementation of exportToCSV method
-void SparseMatrix::exportToCSV(const std::string & filePath) {
-     // Find the last '/' or '\' to separate the path from the file name
-    size_t sepPosition = filePath.find_last_of("/\\");
-    std::string path = "";
-    std::string fileName = filePath; //initialize the filename var
-
-    if (sepPosition != std::string::npos) { // If the sepPosition exist
-        path = filePath.substr(0, sepPosition + 1);  // Directory path with trailing separator
-        fileName = filePath.substr(sepPosition + 1); // File name only
+/*==============================================================================================================*/
+// Programs that embed the matrix code, such as the benchmark suite in bench/, define SPARSE_MATRIX_NO_MAIN
+#ifndef SPARSE_MATRIX_NO_MAIN
+/**
+ * @brief Parses a number of bytes such as `512M`, with an optional K, M or G suffix for KiB, MiB or GiB.
+ *
+ * @return bool False if the text is not a number of bytes, or does not fit in 64 bits.
+ */
+static bool parseByteSize(const std::string & text, std::uint64_t & bytes) {
+    const char* end = text.data() + text.size();
+    std::from_chars_result result = std::from_chars(text.data(), end, bytes);
+    if (result.ec != std::errc()) {
+        return false;
     }
-
-    // Find the position of the file extension (if any)
-    size_t dotPosition = fileName.find_last_of('.');
-    if (dotPosition != std::string::npos) { //if the file has a dot position (extension)
-        fileName.insert(dotPosition, "_output");
-    } else {
-        // If there's no extension, just append _output at the end
-        fileName += "_output";
+    if (result.ptr == end) {
+        return true;
     }
+    static const char UNITS[] = "KMG";
+    const char* suffix = std::strchr(UNITS, std::toupper(static_cast<unsigned char>(*result.ptr)));
+    if (suffix == nullptr || *suffix == '\0' || result.ptr + 1 != end) {
+        return false;
+    }
+    unsigned int shift = 10 * static_cast<unsigned int>(suffix - UNITS + 1);
+    if (bytes > (UINT64_MAX >> shift)) {
+        return false;
+    }
+    bytes <<= shift;
+    return true;
+}
 
-    // Combine the path and the modified filename
-    std::string outputPath = path + fileName;
-
-    // Open the file in trunc mode to ensure a new file is created
-    std::ofstream file(outputPath, std::ios::trunc);
-
-    // Iterate over each row
-    for (int i = 1; i <= numRow; ++i) {
-        Node* current = rowHeaders[i]->nextCol;  // Skip the placeholder and start with the first actual node
+/**
+ * @brief Parses a whole count such as the `N` of `--tile-rows N`.
+ *
+ * @return bool False if the text is not a decimal number, or does not fit in N.
+ */
+template <typename N>
+static bool parseCount(const std::string & text, N & count) {
+    const char* end = text.data() + text.size();
+    std::from_chars_result result = std::from_chars(text.data(), end, count);
+    return result.ec == std::errc() && result.ptr == end;
+}
 
-        // Iterate over each column in this row
-        for (int j = 1; j <= numCol; ++j) {
-            if (current->data != 0) {
-                file << current->rowIndex << "," << current->colIndex << "," << current->data;
-                current = current->nextCol;  // Move to the next node in the row
-                file << "\n";  // New line
+/**
+ * @brief Lists the job files of a batch.
+ *
+ * @param const std::string & source A directory, whose `.csv` files are listed in name order (results named
+ *        `*_output.csv` excepted), or a manifest file holding one job path per line, or `-` to read the manifest
+ *        from standard input. Blank lines and lines starting with `#` in a manifest are skipped.
+ *
+ * @return std::vector<std::string> The paths of the job files.
+ *
+ * @throws std::runtime_error if the directory or the manifest cannot be read.
+ */
+static std::vector<std::string> listBatchJobs(const std::string & source) {
+    std::vector<std::string> jobs;
+    std::error_code error;
+    if (source != "-" && std::filesystem::is_directory(source, error)) {
+        static const std::string OUTPUT_SUFFIX = "_output.csv";
+        for (std::filesystem::directory_iterator entry(source, error), end; !error && entry != end; entry.increment(error)) {
+            std::string name = entry->path().filename().string();
+            bool isOutput = name.size() >= OUTPUT_SUFFIX.size()
+                            && name.compare(name.size() - OUTPUT_SUFFIX.size(), OUTPUT_SUFFIX.size(), OUTPUT_SUFFIX) == 0;
+            if (entry->path().extension() == ".csv" && !isOutput && entry->is_regular_file(error)) {
+                jobs.push_back(entry->path().string());
             }
         }
-            
+        if (error) {
+            throw std::runtime_error("Error: Could not read the directory '" + source + "': " + error.message());
+        }
+        std::sort(jobs.begin(), jobs.end());
+        return jobs;
     }
-    file.close();
-    std::cout << "Data exported successfully to " << "'" << outputPath<< "'" << std::endl;
-}
 
+    std::ifstream manifestFile;
+    if (source != "-") {
+        manifestFile.open(source);
+        if (!manifestFile.is_open()) {
+            throw std::runtime_error("Error: Could not open the batch manifest '" + source + "'");
+        }
+    }
+    std::istream & manifest = source == "-" ? std::cin : manifestFile;
+    std::string line;
+    while (std::getline(manifest, line)) {
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        std::size_t last = line.find_last_not_of(" \t\r");
+        jobs.push_back(line.substr(first, last - first + 1));
+    }
+    return jobs;
+}
 
-/*==============================================================================================================*/
 /**
  * @brief Entry point of the program that demonstrates SparseMatrix operations.
  *
@@ -572,8 +7930,34 @@ void SparseMatrix::exportToCSV(const std::string & filePath) {
  * and demonstrates matrix creation, insertion, removal, access, and addition 
  * using the SparseMatrix class. Results are printed to the console.
  * 
- * @param argc Number of command-line arguments (should be 2).
- * @param argv Array of arguments, where argv[1] is the path to a CSV file.
+ * Usage:
+ *   - `<program> [--binary] [--threads N] [--type T] [--stats] [--display M] [--hypersparse] [--pipeline] <csv-file-path>` runs a CSV job;
+ *     `--binary` exports the result as `<name>_output.smb` instead of CSV, and `--threads N` runs addition,
+ *     multiplication and scalar multiplication on N threads, and parses and builds the matrices on them.
+ *   - `<program> [--type T] --op <A|M|T|S> <matrix-file> [<matrix-file>|<scalar>]` runs one operation on
+ *     binary `.smb` or Matrix Market `.mtx` files and writes `<name>_output.smb` (or `.mtx`, following the
+ *     first operand) next to the first one.
+ *   - `--out-of-core` runs `--op M` on two `.smb` files with OutOfCoreMultiplier, which spills the result to
+ *     disk in tiles instead of holding it in memory; `--memory-limit N[K|M|G]` sets its budget (256M by
+ *     default), and `--tile-rows N` and `--tile-cols N` cap its tiles of A and blocks of B.
+ *   - `--type` picks the value type of the matrices: int32 (the default), int64, float or double.
+ *   - `--display` picks how the matrices of a CSV job are printed: `dense` prints every element, `sparse` only
+ *     the stored ones as `row,col,value` lines, `none` nothing, and `auto` (the default) is dense up to
+ *     DENSE_DISPLAY_LIMIT elements and sparse above.
+ *   - `--hypersparse` builds the matrices of a CSV job as HypersparseMatrix objects, which only allocate the
+ *     non-empty rows and columns; this is automatic when a dimension of the job does not fit in 32 bits.
+ *   - `--pipeline` runs the parse, build, compute and export stages of a CSV job on their own threads so that
+ *     they overlap (see runPipelinedJob); hypersparse jobs run as usual.
+ *   - A CSV job with the operation `E` gives an expression such as `2*A + B'` on its second line, and its
+ *     matrices A, B, C... in order, separated by `,,`; the expression is evaluated as a MatrixExpression.
+ *   - `--stats` prints the time of every phase (parse, build, display, compute, export) and the counters of
+ *     matrixStats() on stderr; the counters are only collected when compiled with -DSPARSE_MATRIX_STATS.
+ *   - `<program> [options] [--jobs N] --batch <directory|manifest|->` runs every CSV job of a directory, or
+ *     listed in a manifest file or on stdin, in one process on N workers (one per hardware thread by
+ *     default), and prints the time of every job on stderr (see runBatch).
+ * 
+ * @param argc Number of command-line arguments.
+ * @param argv Array of arguments, see the usage above.
  * 
  * @return int Returns 0 on success, or 1 on invalid input.
  * * Error Handling:
@@ -581,178 +7965,112 @@ void SparseMatrix::exportToCSV(const std::string & filePath) {
  *   - If the input file is not a CSV file (based on the file extension), the program prints an error message and exits.
  */
 int main(int argc, char* argv[]){
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    // Options come before the file path
+    RunOptions options;
+    while (!args.empty() && args[0].compare(0, 2, "--") == 0) {
+        if (args[0] == "--binary") {
+            options.binaryOutput = true;
+        } else if (args[0] == "--stats") {
+            options.stats = true;
+        } else if (args[0] == "--hypersparse") {
+            options.hypersparse = true;
+        } else if (args[0] == "--pipeline") {
+            options.pipeline = true;
+        } else if (args[0] == "--out-of-core") {
+            options.outOfCore = true;
+        } else if (args[0] == "--memory-limit" && args.size() >= 2) {
+            if (!parseByteSize(args[1], options.tiling.memoryLimit)) {
+                std::cerr << "Error: invalid memory limit '" << args[1] << "', expected bytes with an optional K, M or G suffix." << std::endl;
+                return 1;
+            }
+            args.erase(args.begin());
+        } else if (args[0] == "--tile-rows" && args.size() >= 2) {
+            if (!parseCount(args[1], options.tiling.tileRows)) {
+                std::cerr << "Error: invalid tile rows '" << args[1] << "', expected a number of rows." << std::endl;
+                return 1;
+            }
+            args.erase(args.begin());
+        } else if (args[0] == "--tile-cols" && args.size() >= 2) {
+            if (!parseCount(args[1], options.tiling.tileCols)) {
+                std::cerr << "Error: invalid tile columns '" << args[1] << "', expected a number of columns below 2^32." << std::endl;
+                return 1;
+            }
+            args.erase(args.begin());
+        } else if (args[0] == "--display" && args.size() >= 2) {
+            static const char* const MODES[] = {"auto", "dense", "sparse", "none"};
+            const char* const* mode = std::find(std::begin(MODES), std::end(MODES), args[1]);
+            if (mode == std::end(MODES)) {
+                std::cerr << "Error: unknown display mode '" << args[1] << "', expected auto, dense, sparse or none." << std::endl;
+                return 1;
+            }
+            options.display = static_cast<DisplayMode>(mode - std::begin(MODES));
+            args.erase(args.begin());
+        } else if (args[0] == "--threads" && args.size() >= 2) {
+            options.threads = static_cast<unsigned int>(std::max(1, std::atoi(args[1].c_str())));
+            args.erase(args.begin());
+        } else if (args[0] == "--type" && args.size() >= 2) {
+            options.valueType = args[1];
+            args.erase(args.begin());
+        } else if (args[0] == "--batch" && args.size() >= 2) {
+            options.batch = args[1];
+            args.erase(args.begin());
+        } else if (args[0] == "--jobs" && args.size() >= 2) {
+            options.jobs = static_cast<unsigned int>(std::max(1, std::atoi(args[1].c_str())));
+            args.erase(args.begin());
+        } else {
+            break; // --op, or an unknown option reported by the usage message below
+        }
+        args.erase(args.begin());
+    }
+
+    // Operation on matrix files
+    if (args.size() >= 2 && args[0] == "--op") {
+        char operation = args[1].empty() ? 0 : args[1][0];
+        std::vector<std::string> operands(args.begin() + 2, args.end());
+        return withValueType(options.valueType, [&](auto zero) { return runFileOperation<decltype(zero)>(operation, operands, options); });
+    }
+
+    // Many CSV jobs in one process
+    if (!options.batch.empty() && args.empty()) {
+        std::vector<std::string> jobs;
+        try {
+            jobs = listBatchJobs(options.batch);
+        } catch (const std::runtime_error & e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return withValueType(options.valueType, [&](auto zero) { return runBatch<decltype(zero)>(jobs, options); });
+    }
+
     // Ensure that a file argument is passed
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <csv-file-path>" << std::endl;
+    if (args.size() != 1 || !options.batch.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--binary] [--threads N] [--type int32|int64|float|double] [--stats] [--display auto|dense|sparse|none] [--hypersparse] [--pipeline] <csv-file-path>" << std::endl;
+        std::cerr << "       " << argv[0] << " [options above] [--jobs N] --batch <directory|manifest|->" << std::endl;
+        std::cerr << "       " << argv[0] << " [--type int32|int64|float|double] [--stats] --op <A|M|T|S> <matrix-file> [<matrix-file>|<scalar>]" << std::endl;
+        std::cerr << "       " << argv[0] << " [--type T] [--stats] [--threads N] --out-of-core [--memory-limit N[K|M|G]] [--tile-rows N] [--tile-cols N] --op M <a.smb> <b.smb>" << std::endl;
         return 1;
     }
     // Check if the file path is to a .cvs
-    std::string filePath = argv[1];
+    std::string filePath = args[0];
     size_t dotPosition = filePath.rfind('.');
     if (dotPosition == std::string::npos || filePath.substr(dotPosition) != ".csv") {
         std::cerr << "Error: The input file must be a .csv file." << std::endl;
         return 1;
     }
-    
-    //Open the csv file
-    std::ifstream file(filePath);
-    // Check if the file is open
-    if (!file.is_open()) {
-        std::cerr << "Could not open the file!" << std::endl;
-        return 1;
-    }
-
-    char operation;
-    int matrixSize;
-    std::string line;   
-
-    // Read the first line from the file
-    if (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string firstElement, secondElement;
-        // Get the first element
-        std::getline(ss, firstElement, ',');
-        // Get the second element
-        std::getline(ss, secondElement, ',');
-
-        // Store operation and matrixSize
-        operation = firstElement[0];
-        matrixSize = std::stoi(secondElement); // Convert to int
-    }
-    std::cout << operation << " " << matrixSize << std::endl;
-    std::cout << "============="<< std::endl;
-
-
-    // Skip the second line
-    std::getline(file, line);
-    
-    
-    if(operation == 'A' || operation == 'M') {
-        //initialize the 2 matrices
-        SparseMatrix aMatrix(matrixSize,matrixSize);
-        SparseMatrix bMatrix(matrixSize,matrixSize);
-        int rowNum = 0;
-        int colNum = 0;
-        int value = 0;
-
-        // Get data for aMatrix
-        while(std::getline(file, line)) {
-            // Check if the line contains two consecutive commas
-            if (line.find(",,") != std::string::npos) {
-                break;  // break out of loop
-            }
-            // Start at the third line and get data until meeting an empty line
-            std::stringstream ss(line);
-            std::string firstElement, secondElement, thirdElement;
-            // Get the first element
-            std::getline(ss, firstElement, ',');
-            // Get the second element
-            std::getline(ss, secondElement, ',');
-            // Get the third element
-            std::getline(ss, thirdElement, ',');
-            rowNum = std::stoi(firstElement);
-            colNum = std::stoi(secondElement);
-            value = std::stoi(thirdElement);
-                
-            aMatrix.insert(value,rowNum,colNum);
-        }
-        aMatrix.display(); //Display aMatrix
-
-        std::cout << "-----------"<< std::endl;
-        // Get data for bMatrix
-        while(std::getline(file, line)) {
-            // Check if the line contains two consecutive commas
-            if (line.find(",,") != std::string::npos) {
-                break;  // break out of loop
-            }
-            // Start at the third line and get data until meeting an empty line
-            std::stringstream ss(line);
-            std::string firstElement, secondElement, thirdElement;
-            // Get the first element
-            std::getline(ss, firstElement, ',');
-            // Get the second element
-            std::getline(ss, secondElement, ',');
-            // Get the third element
-            std::getline(ss, thirdElement, ',');
-            rowNum = std::stoi(firstElement);
-            colNum = std::stoi(secondElement);
-            value = std::stoi(thirdElement);  
-            bMatrix.insert(value,rowNum,colNum);
-        }
-        bMatrix.display(); //Display bMatrix
-
-        // Compute Results
-        std::cout << "---Result---"<< std::endl;
-        if (operation == 'A') {
-            SparseMatrix resultMatrix = SparseMatrix::matrixAddition(aMatrix,bMatrix);
-            resultMatrix.display(); //Print result
-            resultMatrix.exportToCSV(filePath); // Export Result
-        }
 
-        if (operation == 'M') {
-            SparseMatrix resultMatrix = SparseMatrix::matrixMultiplication(aMatrix,bMatrix);
-            resultMatrix.display(); //Print result
-            resultMatrix.exportToCSV(filePath); // Export Result
-        }
-
-    } // End of If (A or M)
-
-    if(operation == 'T' || operation == 'S') {
-        //initialize the 1 matrix
-        SparseMatrix aMatrix(matrixSize,matrixSize);
-        int rowNum = 0;
-        int colNum = 0;
-        int value = 0;
-
-        // Get data for aMatrix
-        while(std::getline(file, line)) {
-            // Check if the line contains two consecutive commas
-            if (line.find(",,") != std::string::npos) {
-                break;  // break out of loop
-            }
-            // Start at the third line and get data until meeting an empty line
-            std::stringstream ss(line);
-            std::string firstElement, secondElement, thirdElement;
-            // Get the first element
-            std::getline(ss, firstElement, ',');
-            // Get the second element
-            std::getline(ss, secondElement, ',');
-            // Get the third element
-            std::getline(ss, thirdElement, ',');
-            rowNum = std::stoi(firstElement);
-            colNum = std::stoi(secondElement);
-            value = std::stoi(thirdElement);
-                
-            aMatrix.insert(value,rowNum,colNum);
-        }
-        aMatrix.display(); //Display aMatrix
-
-        //Compute and print Result
-        std::cout << "---Result---"<< std::endl;
-        if (operation == 'S') {
-            int scalar = 0;
-            if(std::getline(file, line)) {
-                std::stringstream ss(line);
-                std::string firstElement;
-                // Get the first element (the scalar)
-                std::getline(ss, firstElement, ',');
-                // Convert to int and store it
-                scalar = std::stoi(firstElement);
-                std::cout << "Scalar: " << scalar << std::endl;
-            }
-            SparseMatrix resultMatrix = SparseMatrix::matrixScalarMultiplication(aMatrix,scalar);
-            resultMatrix.display(); //Print result
-            resultMatrix.exportToCSV(filePath); // Export Result
+    return withValueType(options.valueType, [&](auto zero) {
+        PhaseTimer phases(options.stats);
+        std::unique_ptr<ThreadPool> threads;
+        if (options.threads > 1) {
+            threads.reset(new ThreadPool(options.threads));
         }
-
-        if(operation == 'T') {
-            SparseMatrix resultMatrix = SparseMatrix::matrixTransposition(aMatrix);
-            resultMatrix.display(); //Print result
-            resultMatrix.exportToCSV(filePath); // Export Result
+        int status = runCSVJob<decltype(zero)>(filePath, options, threads.get(), phases, std::cout, std::cerr);
+        if (options.stats) { // After the matrices are gone, so that their pools are counted
+            phases.report(std::cerr);
         }
-    }// End of If (S or T)
-    
-    file.close();
-    
-    return 0;
-}
\ No newline at end of file
+        return status;
+    });
+}
+#endif // SPARSE_MATRIX_NO_MAIN
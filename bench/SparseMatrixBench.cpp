@@ -0,0 +1,595 @@
+/**
+* CS/SE 3345 - Programming Assignment 1 - Sparse Matrix
+* Benchmark suite: synthetic workloads for every SparseMatrix operation, reported as CSV or JSON.
+*
+* Build from the repository root:
+*   g++ -std=c++17 -O2 -pthread bench/SparseMatrixBench.cpp -o SparseMatrixBench
+*/
+
+#define SPARSE_MATRIX_NO_MAIN
+#include "../TANGPA1.cpp"
+
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <sstream>
+#ifndef _WIN32
+#include <sys/resource.h>  // For the peak resident set size
+#endif
+
+/**
+ * @enum Distribution
+ * @brief How the non-zeros of a generated matrix are spread over its rows and columns.
+ */
+enum class Distribution {
+    Uniform,        ///< Every position is equally likely.
+    PowerLaw,       ///< Row lengths follow a power law (a few very long rows), columns are uniform.
+    Banded,         ///< Every non-zero lies within a fixed distance of the diagonal.
+    BlockDiagonal   ///< Non-zeros fill square blocks along the diagonal.
+};
+
+static const char* const DISTRIBUTION_NAMES[] = {"uniform", "powerlaw", "banded", "block"};
+
+/**
+ * @struct BenchOptions
+ * @brief Command-line options of the benchmark.
+ */
+struct BenchOptions {
+    std::uint32_t rows = 10000;      ///< Rows of the generated matrices (`--rows`).
+    std::uint32_t cols = 10000;      ///< Columns of the generated matrices (`--cols`).
+    double density = 0.001;          ///< Fraction of stored elements (`--density`).
+    std::vector<Distribution> distributions{Distribution::Uniform, Distribution::PowerLaw,
+                                            Distribution::Banded, Distribution::BlockDiagonal};  ///< `--dist`.
+    std::uint32_t blockSize = 64;    ///< Side of the diagonal blocks of `block` matrices (`--block`).
+    double powerLawExponent = 1.0;   ///< Exponent of the row lengths of `powerlaw` matrices (`--alpha`).
+    std::uint64_t seed = 3345;       ///< Seed of the generator, so runs are reproducible (`--seed`).
+    unsigned int reps = 5;           ///< Repetitions of every operation, the median is reported (`--reps`).
+    unsigned int threads = 1;        ///< Also time the threaded operations on N threads when above 1 (`--threads`).
+    std::string format = "csv";      ///< Report format, csv or json (`--format`).
+    std::string outputPath;          ///< Report file, standard output when empty (`--output`).
+    std::string scratchDir = ".";    ///< Directory of the CSV files written by the import and export runs (`--scratch`).
+    std::string operations;          ///< Comma-separated operations to run, all of them when empty (`--ops`).
+};
+
+/**
+ * @struct BenchResult
+ * @brief Timing of one operation on one workload.
+ */
+struct BenchResult {
+    std::string operation;     ///< Name of the operation.
+    Distribution distribution; ///< Distribution of the operands.
+    std::uint32_t rows;        ///< Rows of the first operand.
+    std::uint32_t cols;        ///< Columns of the first operand.
+    std::size_t nnz;           ///< Non-zeros the operation processes (operands, or entries inserted/removed).
+    std::size_t ops;           ///< Elementary operations per repetition: 1 for whole-matrix operations.
+    double seconds;            ///< Median time of one repetition.
+    long peakRssKb;            ///< Peak resident set size of the process after the runs, in KiB.
+};
+
+/**
+ * @brief Returns the peak resident set size of the process so far, in KiB, or 0 where it is not available.
+ */
+static long peakRssKb() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024; // Reported in bytes
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @class Stopwatch
+ * @brief Accumulates the time between start() and stop() calls, so the set-up of a repetition can be left out.
+ */
+class Stopwatch {
+    private:
+    std::chrono::steady_clock::time_point started;
+    double elapsed = 0;
+
+    public:
+    void start() { started = std::chrono::steady_clock::now(); }
+    void stop() { elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count(); }
+    double seconds() const { return elapsed; }
+};
+
+/**
+ * @brief Runs `body` `reps` times and returns the median time measured by its stopwatch.
+ *
+ * @param Body body Called as `body(stopwatch)`; it starts and stops the stopwatch around the timed part.
+ */
+template <typename Body>
+static double medianSeconds(unsigned int reps, Body body) {
+    std::vector<double> times;
+    for (unsigned int r = 0; r < reps; r++) {
+        Stopwatch stopwatch;
+        body(stopwatch);
+        times.push_back(stopwatch.seconds());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+/**
+ * @class MatrixGenerator
+ * @brief Generates random matrices, as triplets, with a given size, density and distribution.
+ *
+ * Values are drawn from 1 to 9 so that products stay far from overflow. A position may be drawn twice,
+ * in which case fromTriplets keeps one entry, so the actual density can be slightly below the target.
+ */
+template <typename T>
+class MatrixGenerator {
+    public:
+    typedef ::Triplet<T, std::uint32_t> Triplet;
+
+    private:
+    std::mt19937_64 random;
+    std::uniform_int_distribution<int> values{1, 9};
+
+    void uniformRows(std::uint32_t rows, std::uint32_t cols, const std::vector<std::size_t> & rowLengths,
+                     std::vector<Triplet> & triplets) {
+        std::uniform_int_distribution<std::uint32_t> column(1, cols);
+        for (std::uint32_t i = 1; i <= rows; i++) {
+            for (std::size_t k = 0; k < rowLengths[i]; k++) {
+                triplets.push_back(Triplet(T(values(random)), i, column(random)));
+            }
+        }
+    }
+
+    public:
+    explicit MatrixGenerator(std::uint64_t seed) : random(seed) {}
+
+    /**
+     * @brief Generates the entries of one `rows` x `cols` matrix.
+     *
+     * @param const BenchOptions & options The density, block size and power-law exponent.
+     * @param Distribution distribution How the entries are spread.
+     *
+     * @return std::vector<Triplet> The entries, in no particular order.
+     */
+    std::vector<Triplet> generate(std::uint32_t rows, std::uint32_t cols, const BenchOptions & options, Distribution distribution) {
+        std::vector<Triplet> triplets;
+        double target = options.density * rows * cols;
+        triplets.reserve(static_cast<std::size_t>(target) + 1);
+
+        switch (distribution) {
+            case Distribution::Uniform: {
+                std::binomial_distribution<std::size_t> length(cols, options.density);
+                std::vector<std::size_t> rowLengths(rows + 1, 0);
+                for (std::uint32_t i = 1; i <= rows; i++) {
+                    rowLengths[i] = length(random);
+                }
+                uniformRows(rows, cols, rowLengths, triplets);
+                break;
+            }
+            case Distribution::PowerLaw: {
+                // Row of rank r gets a share proportional to r^-alpha, and the ranks are shuffled over the rows
+                std::vector<double> weights(rows + 1, 0);
+                double total = 0;
+                for (std::uint32_t r = 1; r <= rows; r++) {
+                    weights[r] = std::pow(double(r), -options.powerLawExponent);
+                    total += weights[r];
+                }
+                std::shuffle(weights.begin() + 1, weights.end(), random);
+                std::vector<std::size_t> rowLengths(rows + 1, 0);
+                for (std::uint32_t i = 1; i <= rows; i++) {
+                    rowLengths[i] = std::min<std::size_t>(cols, static_cast<std::size_t>(std::llround(target * weights[i] / total)));
+                }
+                uniformRows(rows, cols, rowLengths, triplets);
+                break;
+            }
+            case Distribution::Banded: {
+                // Half-width w so that the 2w+1 diagonals hold about density * cols entries per row
+                std::int64_t width = std::max<std::int64_t>(0, std::llround((options.density * cols - 1) / 2));
+                for (std::int64_t i = 1; i <= rows; i++) {
+                    std::int64_t first = std::max<std::int64_t>(1, i - width);
+                    std::int64_t last = std::min<std::int64_t>(cols, i + width);
+                    for (std::int64_t j = first; j <= last; j++) {
+                        triplets.push_back(Triplet(T(values(random)), std::uint32_t(i), std::uint32_t(j)));
+                    }
+                }
+                break;
+            }
+            case Distribution::BlockDiagonal: {
+                // Fill probability inside the blocks so that the whole matrix reaches the density
+                std::uint32_t side = std::max<std::uint32_t>(1, options.blockSize);
+                std::bernoulli_distribution fill(std::min(1.0, options.density * cols / side));
+                for (std::uint32_t first = 1; first <= rows && first <= cols; first += side) {
+                    std::uint32_t rowEnd = std::min<std::uint32_t>(rows, first + side - 1);
+                    std::uint32_t colEnd = std::min<std::uint32_t>(cols, first + side - 1);
+                    for (std::uint32_t i = first; i <= rowEnd; i++) {
+                        for (std::uint32_t j = first; j <= colEnd; j++) {
+                            if (fill(random)) {
+                                triplets.push_back(Triplet(T(values(random)), i, j));
+                            }
+                        }
+                    }
+                }
+                break;
+            }
+        }
+        return triplets;
+    }
+
+    /**
+     * @brief Shuffles entries, so that inserts and removes do not come in row order.
+     */
+    void shuffle(std::vector<Triplet> & triplets) { std::shuffle(triplets.begin(), triplets.end(), random); }
+
+    /**
+     * @brief Returns a random position of a `rows` x `cols` matrix.
+     */
+    std::pair<std::uint32_t, std::uint32_t> position(std::uint32_t rows, std::uint32_t cols) {
+        return std::make_pair(std::uniform_int_distribution<std::uint32_t>(1, rows)(random),
+                              std::uniform_int_distribution<std::uint32_t>(1, cols)(random));
+    }
+};
+
+/**
+ * @brief Returns the number of stored elements of a matrix, from its node pool.
+ */
+template <typename T>
+static std::size_t storedElements(const SparseMatrix<T> & m) {
+    return m.nodePool().liveNodes() - (std::size_t(m.rowLength()) + m.colLength() + 1); // Minus header and placeholders
+}
+
+/**
+ * @brief Runs every selected operation on matrices of one distribution and appends the timings to `results`.
+ *
+ * Operands: A and B are `rows` x `cols`, C is `cols` x `cols` so that A·C is defined for any shape.
+ */
+template <typename T>
+static void benchDistribution(const BenchOptions & options, Distribution distribution, ThreadPool* threads,
+                              std::vector<BenchResult> & results) {
+    typedef SparseMatrix<T> Matrix;
+    typedef typename MatrixGenerator<T>::Triplet Triplet;
+
+    MatrixGenerator<T> generator(options.seed + static_cast<std::uint64_t>(distribution));
+    std::uint32_t rows = options.rows;
+    std::uint32_t cols = options.cols;
+    std::vector<Triplet> aTriplets = generator.generate(rows, cols, options, distribution);
+    std::vector<Triplet> bTriplets = generator.generate(rows, cols, options, distribution);
+    std::vector<Triplet> cTriplets = generator.generate(cols, cols, options, distribution);
+    Matrix a = Matrix::fromTriplets(rows, cols, aTriplets);
+    Matrix b = Matrix::fromTriplets(rows, cols, bTriplets);
+    Matrix c = Matrix::fromTriplets(cols, cols, cTriplets);
+    std::size_t aNnz = storedElements(a);
+    std::size_t bNnz = storedElements(b);
+    std::size_t cNnz = storedElements(c);
+
+    auto selected = [&](const std::string & name) {
+        if (options.operations.empty()) {
+            return true;
+        }
+        std::string list = "," + options.operations + ",";
+        return list.find("," + name + ",") != std::string::npos;
+    };
+    auto record = [&](const std::string & name, std::size_t nnz, std::size_t ops, double seconds) {
+        results.push_back(BenchResult{name, distribution, rows, cols, nnz, ops, seconds, peakRssKb()});
+    };
+    volatile T sink = 0; // Keeps the results of access() alive
+
+    if (selected("insert")) {
+        std::vector<Triplet> shuffled = aTriplets;
+        generator.shuffle(shuffled);
+        record("insert", shuffled.size(), shuffled.size(), medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+            Matrix m(rows, cols);
+            stopwatch.start();
+            for (const Triplet & t : shuffled) {
+                m.insert(t.data, t.rowIndex, t.colIndex);
+            }
+            stopwatch.stop();
+        }));
+    }
+    if (selected("access")) {
+        // Half of the lookups hit a stored element, the other half a random position
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> positions;
+        for (std::size_t k = 0; k < aTriplets.size(); k++) {
+            positions.push_back(k % 2 == 0 ? std::make_pair(aTriplets[k].rowIndex, aTriplets[k].colIndex)
+                                           : generator.position(rows, cols));
+        }
+        record("access", aNnz, positions.size(), medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+            T sum = 0;
+            stopwatch.start();
+            for (const auto & position : positions) {
+                sum += a.access(position.first, position.second);
+            }
+            stopwatch.stop();
+            sink = sink + sum;
+        }));
+    }
+    if (selected("remove")) {
+        std::vector<Triplet> shuffled = aTriplets;
+        generator.shuffle(shuffled);
+        record("remove", aNnz, shuffled.size(), medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+            Matrix m = Matrix::fromTriplets(rows, cols, aTriplets);
+            stopwatch.start();
+            for (const Triplet & t : shuffled) {
+                m.remove(t.rowIndex, t.colIndex);
+            }
+            stopwatch.stop();
+        }));
+    }
+    if (selected("update")) {
+        // A third of the stored elements are deleted, a third overwritten, and as many new ones inserted
+        std::vector<Triplet> batch;
+        for (std::size_t k = 0; k < aTriplets.size(); k++) {
+            const Triplet & t = aTriplets[k];
+            if (k % 3 == 0) {
+                batch.push_back(Triplet(0, t.rowIndex, t.colIndex));
+            } else if (k % 3 == 1) {
+                batch.push_back(Triplet(t.data, t.rowIndex, t.colIndex));
+            } else {
+                std::pair<std::uint32_t, std::uint32_t> position = generator.position(rows, cols);
+                batch.push_back(Triplet(t.data, position.first, position.second));
+            }
+        }
+        generator.shuffle(batch);
+        record("update", aNnz, batch.size(), medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+            Matrix m = Matrix::fromTriplets(rows, cols, aTriplets);
+            stopwatch.start();
+            m.applyUpdates(batch);
+            stopwatch.stop();
+        }));
+    }
+    if (selected("add")) {
+        record("add", aNnz + bNnz, 1, medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+            stopwatch.start();
+            Matrix result = Matrix::matrixAddition(a, b);
+            stopwatch.stop();
+        }));
+        if (threads) {
+            record("add_parallel", aNnz + bNnz, 1, medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+                stopwatch.start();
+                Matrix result = Matrix::matrixAddition(a, b, *threads);
+                stopwatch.stop();
+            }));
+        }
+    }
+    if (selected("multiply")) {
+        record("multiply", aNnz + cNnz, 1, medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+            stopwatch.start();
+            Matrix result = Matrix::matrixMultiplication(a, c);
+            stopwatch.stop();
+        }));
+        if (threads) {
+            record("multiply_parallel", aNnz + cNnz, 1, medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+                stopwatch.start();
+                Matrix result = Matrix::matrixMultiplication(a, c, *threads);
+                stopwatch.stop();
+            }));
+        }
+    }
+    if (selected("transpose")) {
+        record("transpose", aNnz, 1, medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+            stopwatch.start();
+            Matrix result = Matrix::matrixTransposition(a);
+            stopwatch.stop();
+        }));
+    }
+    if (selected("scale")) {
+        record("scale", aNnz, 1, medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+            stopwatch.start();
+            Matrix result = Matrix::matrixScalarMultiplication(a, T(3));
+            stopwatch.stop();
+        }));
+        if (threads) {
+            record("scale_parallel", aNnz, 1, medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+                stopwatch.start();
+                Matrix result = Matrix::matrixScalarMultiplication(a, T(3), *threads);
+                stopwatch.stop();
+            }));
+        }
+    }
+
+    std::string csvPath = options.scratchDir + "/bench_" + DISTRIBUTION_NAMES[static_cast<int>(distribution)] + ".csv";
+    if (selected("csv_export")) {
+        // exportToCSV reports on standard output, which may carry the report itself
+        std::streambuf* console = std::cout.rdbuf();
+        std::ostringstream discarded;
+        record("csv_export", aNnz, 1, medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+            std::cout.rdbuf(discarded.rdbuf());
+            stopwatch.start();
+            a.exportToCSV(csvPath);
+            stopwatch.stop();
+            std::cout.rdbuf(console);
+            discarded.str("");
+        }));
+        std::remove(Matrix::outputFilePath(csvPath).c_str());
+    }
+    if (selected("csv_import")) {
+        // A transposition job file holding A, parsed and built the way the program reads its input
+        {
+            std::ofstream file(csvPath, std::ios::trunc);
+            file << "T," << rows << "," << cols << "\n,,\n";
+            typename Matrix::CompressedStorage rowsOfA = a.toCSR().storage;
+            for (std::uint32_t i = 1; i <= rows; i++) {
+                for (std::size_t k = rowsOfA.majorPtr[i - 1]; k < rowsOfA.majorPtr[i]; k++) {
+                    file << i << "," << rowsOfA.minorIndex[k] << ",";
+                    writeValue(file, rowsOfA.values[k]);
+                    file << "\n";
+                }
+            }
+        }
+        record("csv_import", aNnz, 1, medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+            stopwatch.start();
+            MatrixFileParser parser(csvPath);
+            JobHeader header;
+            parser.readHeader(header);
+            parser.skipLine();
+            std::vector<Triplet> triplets;
+            parser.readSection(triplets);
+            Matrix m = Matrix::fromTriplets(rows, cols, triplets);
+            stopwatch.stop();
+        }));
+        if (threads) {
+            record("csv_import_parallel", aNnz, 1, medianSeconds(options.reps, [&](Stopwatch & stopwatch) {
+                stopwatch.start();
+                MatrixFileParser parser(csvPath);
+                JobHeader header;
+                parser.readHeader(header);
+                parser.skipLine();
+                std::vector<std::vector<Triplet>> buffers;
+                parser.readSection(buffers, *threads);
+                Matrix m = Matrix::fromTriplets(rows, cols, buffers, *threads);
+                stopwatch.stop();
+            }));
+        }
+        std::remove(csvPath.c_str());
+    }
+}
+
+/**
+ * @brief Writes the results as CSV, one line per operation and distribution.
+ */
+static void writeCSV(std::ostream & out, const std::vector<BenchResult> & results) {
+    out << "operation,distribution,rows,cols,nnz,ops,ns_per_op,nnz_per_s,peak_rss_kb\n";
+    for (const BenchResult & r : results) {
+        out << r.operation << "," << DISTRIBUTION_NAMES[static_cast<int>(r.distribution)] << "," << r.rows << ","
+            << r.cols << "," << r.nnz << "," << r.ops << "," << std::llround(r.seconds * 1e9 / r.ops) << ","
+            << std::llround(r.seconds > 0 ? r.nnz / r.seconds : 0) << "," << r.peakRssKb << "\n";
+    }
+}
+
+/**
+ * @brief Writes the results as a JSON document with the run parameters and an array of results.
+ */
+static void writeJSON(std::ostream & out, const BenchOptions & options, const std::string & valueType,
+                      const std::vector<BenchResult> & results) {
+    out << "{\n  \"benchmark\": \"SparseMatrix\",\n  \"type\": \"" << valueType << "\",\n  \"density\": "
+        << options.density << ",\n  \"seed\": " << options.seed << ",\n  \"reps\": " << options.reps
+        << ",\n  \"threads\": " << options.threads << ",\n  \"results\": [";
+    for (std::size_t k = 0; k < results.size(); k++) {
+        const BenchResult & r = results[k];
+        out << (k == 0 ? "\n" : ",\n") << "    {\"operation\": \"" << r.operation << "\", \"distribution\": \""
+            << DISTRIBUTION_NAMES[static_cast<int>(r.distribution)] << "\", \"rows\": " << r.rows << ", \"cols\": "
+            << r.cols << ", \"nnz\": " << r.nnz << ", \"ops\": " << r.ops << ", \"ns_per_op\": "
+            << std::llround(r.seconds * 1e9 / r.ops) << ", \"nnz_per_s\": "
+            << std::llround(r.seconds > 0 ? r.nnz / r.seconds : 0) << ", \"peak_rss_kb\": " << r.peakRssKb << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+/**
+ * @brief Runs the benchmark for value type T and writes the report.
+ *
+ * @return int 0 on success, or 1 if the report cannot be written or an operation failed.
+ */
+template <typename T>
+static int runBenchmarks(const BenchOptions & options) {
+    std::unique_ptr<ThreadPool> threads;
+    if (options.threads > 1) {
+        threads.reset(new ThreadPool(options.threads));
+    }
+
+    std::vector<BenchResult> results;
+    try {
+        for (Distribution distribution : options.distributions) {
+            benchDistribution<T>(options, distribution, threads.get(), results);
+        }
+    } catch (const std::exception & e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::ofstream file;
+    if (!options.outputPath.empty()) {
+        file.open(options.outputPath, std::ios::trunc);
+        if (!file) {
+            std::cerr << "Error: cannot write '" << options.outputPath << "'" << std::endl;
+            return 1;
+        }
+    }
+    std::ostream & out = options.outputPath.empty() ? std::cout : file;
+    if (options.format == "json") {
+        writeJSON(out, options, ValueTraits<T>::NAME, results);
+    } else {
+        writeCSV(out, results);
+    }
+    return 0;
+}
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * Usage: `SparseMatrixBench [--rows N] [--cols N] [--density D] [--dist uniform,powerlaw,banded,block]
+ * [--block N] [--alpha A] [--seed S] [--reps N] [--threads N] [--type int32|int64|float|double]
+ * [--ops insert,access,remove,update,add,multiply,transpose,scale,csv_import,csv_export] [--format csv|json]
+ * [--output FILE] [--scratch DIR]`
+ *
+ * @return int 0 on success, or 1 on invalid options or a failed run.
+ */
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    std::string valueType = ValueTraits<std::int32_t>::NAME;
+
+    for (int k = 1; k < argc; k++) {
+        std::string arg = argv[k];
+        if (k + 1 >= argc) {
+            std::cerr << "Error: missing value after " << arg << std::endl;
+            return 1;
+        }
+        std::string value = argv[++k];
+        try {
+            if (arg == "--rows") {
+                options.rows = static_cast<std::uint32_t>(std::stoul(value));
+            } else if (arg == "--cols") {
+                options.cols = static_cast<std::uint32_t>(std::stoul(value));
+            } else if (arg == "--density") {
+                options.density = std::stod(value);
+            } else if (arg == "--block") {
+                options.blockSize = static_cast<std::uint32_t>(std::stoul(value));
+            } else if (arg == "--alpha") {
+                options.powerLawExponent = std::stod(value);
+            } else if (arg == "--seed") {
+                options.seed = std::stoull(value);
+            } else if (arg == "--reps") {
+                options.reps = static_cast<unsigned int>(std::stoul(value));
+            } else if (arg == "--threads") {
+                options.threads = static_cast<unsigned int>(std::stoul(value));
+            } else if (arg == "--type") {
+                valueType = value;
+            } else if (arg == "--ops") {
+                options.operations = value;
+            } else if (arg == "--format") {
+                options.format = value;
+            } else if (arg == "--output") {
+                options.outputPath = value;
+            } else if (arg == "--scratch") {
+                options.scratchDir = value;
+            } else if (arg == "--dist") {
+                options.distributions.clear();
+                std::stringstream names(value);
+                std::string name;
+                while (std::getline(names, name, ',')) {
+                    const char* const* found = std::find(std::begin(DISTRIBUTION_NAMES), std::end(DISTRIBUTION_NAMES), name);
+                    if (found == std::end(DISTRIBUTION_NAMES)) {
+                        std::cerr << "Error: unknown distribution '" << name << "'" << std::endl;
+                        return 1;
+                    }
+                    options.distributions.push_back(static_cast<Distribution>(found - std::begin(DISTRIBUTION_NAMES)));
+                }
+            } else {
+                std::cerr << "Error: unknown option " << arg << std::endl;
+                return 1;
+            }
+        } catch (const std::logic_error &) { // std::stoul and friends reject the value
+            std::cerr << "Error: invalid value '" << value << "' for " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (options.rows == 0 || options.cols == 0 || options.reps == 0 || options.density < 0 || options.density > 1
+        || (options.format != "csv" && options.format != "json")) {
+        std::cerr << "Error: rows, cols and reps must be positive, density within [0, 1] and format csv or json." << std::endl;
+        return 1;
+    }
+
+    return withValueType(valueType, [&](auto zero) { return runBenchmarks<decltype(zero)>(options); });
+}
@@ -1,7 +1,7 @@
 #include "csv_utils.h"
+#include <algorithm>
+#include <charconv>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 
 // Implementation of exportToCSV function
 void exportToCSV(const std::string &filePath, const std::string &element1, const std::string &element2, const std::string &element3) {
@@ -25,40 +25,213 @@ void exportToCSV(const std::string &filePath, const std::string &element1, const
 
 // Implementation of processCSVLine function
 int* processCSVLine(const std::string &filePath, int lineNumber) {
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
+    thread_local int array[ARRAY_SIZE];  // Array to hold elements, one per thread so concurrent calls don't collide
+    return processCSVLine(filePath, lineNumber, array) ? array : nullptr;
+}
+
+// Implementation of processCSVLine function writing into the caller's array
+bool processCSVLine(const std::string &filePath, int lineNumber, int (&array)[ARRAY_SIZE]) {
+    CSVReader reader(filePath);
+    if (!reader.isOpen()) {
         std::cerr << "Could not open the file!" << std::endl;
-        return nullptr;  // Return nullptr if the file could not be opened
+        return false;
     }
 
-    std::string line;
-    int currentLine = 0;
-    static int array[ARRAY_SIZE];  // Array to hold elements, size 10 as per your original request
-    int idx = 0;  // Index to store elements in the array
-
-    // Read the file line by line until the desired line number is reached
-    while (std::getline(file, line)) {
-        currentLine++;
-        if (currentLine == lineNumber) {
-            std::stringstream ss(line);
-            std::string element;
-            
-            // Split the line into elements separated by a comma
-            while (std::getline(ss, element, ',')) {
-                if (idx < ARRAY_SIZE) {
-                    array[idx++] = std::stoi(element);  // Convert each element to int and store in array
-                }
-            }
-            break;  // Stop reading once the desired line is processed
+    std::vector<int> row;
+    if (!reader.seekLine(lineNumber) || !reader.nextRow(row)) {
+        if (!reader.failed()) {
+            std::cerr << "Line number exceeds the total number of lines in the file." << std::endl;
         }
+        return false;
     }
 
-    file.close();
+    // Elements past ARRAY_SIZE are dropped, missing ones are 0
+    std::size_t count = std::min<std::size_t>(row.size(), ARRAY_SIZE);
+    std::copy(row.begin(), row.begin() + count, array);
+    std::fill(array + count, array + ARRAY_SIZE, 0);
+    return true;
+}
+
+// Implementation of CSVReader constructor
+CSVReader::CSVReader(const std::string &filePath, std::size_t fieldCount)
+    : file(filePath), fieldCount(fieldCount) {}
+
+// Implementation of CSVReader isOpen method
+bool CSVReader::isOpen() const {
+    return file.is_open();
+}
 
-    if (currentLine < lineNumber) {
-        std::cerr << "Line number exceeds the total number of lines in the file." << std::endl;
-        return nullptr;  // Return nullptr if the line number is out of range
+// Implementation of CSVReader nextRow method
+bool CSVReader::nextRow(std::vector<int> &row) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return readLine() && parseLine(row, fieldCount);
+}
+
+// Implementation of CSVReader nextRow method for a fixed-size array
+bool CSVReader::nextRow(int *fields, std::size_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!readLine() || !parseLine(scratch, 0)) {
+        return false;
+    }
+    if (scratch.size() != count) {
+        std::cerr << "Error: Line " << currentLine << " has " << scratch.size() << " fields instead of " << count << "." << std::endl;
+        error = true;
+        return false;
+    }
+    std::copy(scratch.begin(), scratch.end(), fields);
+    return true;
+}
+
+// Implementation of CSVReader seekLine method
+bool CSVReader::seekLine(int lineNumber) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (lineNumber <= currentLine) {
+        return false;
+    }
+    while (currentLine + 1 < lineNumber) {
+        if (!readLine()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Implementation of CSVReader lineNumber method
+int CSVReader::lineNumber() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return currentLine;
+}
+
+// Implementation of CSVReader failed method
+bool CSVReader::failed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+}
+
+// Reads the next line into the line buffer; the caller holds the mutex
+bool CSVReader::readLine() {
+    if (error || !std::getline(file, line)) {
+        return false;
+    }
+    currentLine++;
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return true;
+}
+
+// Splits the current line into integers; expected is the required number of fields, or 0 for any
+bool CSVReader::parseLine(std::vector<int> &row, std::size_t expected) {
+    row.clear();
+    const char *position = line.data();
+    const char *end = position + line.size();
+    while (position != end) {
+        while (position != end && (*position == ' ' || *position == '\t')) {
+            position++;
+        }
+        int value = 0;
+        std::from_chars_result result = std::from_chars(position, end, value);
+        position = result.ptr;
+        while (position != end && (*position == ' ' || *position == '\t')) {
+            position++;
+        }
+        if (result.ec != std::errc() || (position != end && *position != ',')) {
+            std::cerr << "Error: Line " << currentLine << " is not a list of integers." << std::endl;
+            error = true;
+            return false;
+        }
+        row.push_back(value);
+        if (position != end) {
+            position++;  // Skip the comma
+        }
     }
 
-    return array;
+    if (expected != 0 && row.size() != expected) {
+        std::cerr << "Error: Line " << currentLine << " has " << row.size() << " fields instead of " << expected << "." << std::endl;
+        error = true;
+        return false;
+    }
+    return true;
+}
+
+// Implementation of CSVBatchWriter constructor
+CSVBatchWriter::CSVBatchWriter(const std::string &filePath, std::size_t bufferSize)
+    : file(filePath, std::ios::app | std::ios::binary), bufferSize(bufferSize) {
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open or create the file!" << std::endl;
+    }
+    buffer.reserve(bufferSize);
+}
+
+// Implementation of CSVBatchWriter destructor
+CSVBatchWriter::~CSVBatchWriter() {
+    flush();
+}
+
+// Implementation of CSVBatchWriter isOpen method
+bool CSVBatchWriter::isOpen() const {
+    return file.is_open();
+}
+
+// Implementation of CSVBatchWriter writeRow method for three elements
+bool CSVBatchWriter::writeRow(const std::string &element1, const std::string &element2, const std::string &element3) {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.append(element1).append(1, ',').append(element2).append(1, ',').append(element3);
+    return finishRow();
+}
+
+// Implementation of CSVBatchWriter writeRow method for any number of elements
+bool CSVBatchWriter::writeRow(const std::vector<std::string> &elements) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::size_t i = 0; i < elements.size(); i++) {
+        if (i != 0) {
+            buffer.push_back(',');
+        }
+        buffer.append(elements[i]);
+    }
+    return finishRow();
+}
+
+// Implementation of CSVBatchWriter writeRow method for integers
+bool CSVBatchWriter::writeRow(const int *fields, std::size_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    char digits[16];
+    for (std::size_t i = 0; i < count; i++) {
+        if (i != 0) {
+            buffer.push_back(',');
+        }
+        std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), fields[i]);
+        buffer.append(digits, result.ptr);
+    }
+    return finishRow();
+}
+
+// Implementation of CSVBatchWriter flush method
+bool CSVBatchWriter::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return flushLocked() && static_cast<bool>(file.flush());
+}
+
+// Implementation of CSVBatchWriter rowsWritten method
+std::size_t CSVBatchWriter::rowsWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return rows;
+}
+
+// Ends the row being buffered and writes the buffer once it is full; the caller holds the mutex
+bool CSVBatchWriter::finishRow() {
+    buffer.push_back('\n');
+    rows++;
+    return buffer.size() < bufferSize ? file.is_open() : flushLocked();
+}
+
+// Writes the buffer to the file and empties it; the caller holds the mutex
+bool CSVBatchWriter::flushLocked() {
+    if (!file.is_open()) {
+        buffer.clear();
+        return false;
+    }
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+    return static_cast<bool>(file);
 }
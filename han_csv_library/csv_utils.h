@@ -1,17 +1,23 @@
 #ifndef CSV_UTILS_H
 #define CSV_UTILS_H
 
+#include <cstddef>
+#include <fstream>
+#include <mutex>
 #include <string>
+#include <vector>
 
 // Define a constant for the array size (you can change this as needed)
 const int ARRAY_SIZE = 10;
 
 /**
  * @brief Exports three elements as a comma-separated string into a CSV file.
- * 
- * If the file already exists, it appends the new data to a new line. If the file doesn't exist, 
+ *
+ * If the file already exists, it appends the new data to a new line. If the file doesn't exist,
  * it creates the file and writes the data.
- * 
+ *
+ * The file is opened and closed on every call; use CSVBatchWriter to append many rows.
+ *
  * @param filePath The path to the CSV file.
  * @param element1 The first element to export.
  * @param element2 The second element to export.
@@ -21,11 +27,173 @@ void exportToCSV(const std::string &filePath, const std::string &element1, const
 
 /**
  * @brief Reads a specific line from a CSV file and returns the elements as an array.
- * 
+ *
+ * The array belongs to the calling thread and is overwritten by its next call; elements past the end of
+ * the line are 0. The file is scanned from the start on every call; use CSVReader to read many lines.
+ *
  * @param filePath The path to the CSV file.
  * @param lineNumber The line number to read (1-based index).
  * @return int* An array of elements from the specified line in the CSV.
  */
 int* processCSVLine(const std::string &filePath, int lineNumber);
 
-#endif  // CSV_UTILS_H
\ No newline at end of file
+/**
+ * @brief Reads a specific line from a CSV file into an array owned by the caller.
+ *
+ * @param filePath The path to the CSV file.
+ * @param lineNumber The line number to read (1-based index).
+ * @param array The ARRAY_SIZE elements of the line; elements past the end of the line are 0.
+ * @return bool False if the file could not be opened, the line does not exist or is not made of integers.
+ */
+bool processCSVLine(const std::string &filePath, int lineNumber, int (&array)[ARRAY_SIZE]);
+
+/**
+ * @brief Streams the rows of a CSV file of integers, keeping the file open and a cursor on the next line.
+ *
+ * Each call to nextRow() reads one line, so reading a whole file is linear in its size. With a field
+ * count of 0 rows may have any number of fields; otherwise every row must have exactly that many. The
+ * reader can be shared between threads: each call returns one whole row, and rows are handed out in
+ * file order.
+ */
+class CSVReader {
+public:
+    /**
+     * @brief Opens a CSV file for reading.
+     *
+     * @param filePath The path to the CSV file.
+     * @param fieldCount The number of fields of every row, or 0 for a variable number.
+     */
+    explicit CSVReader(const std::string &filePath, std::size_t fieldCount = 0);
+
+    CSVReader(const CSVReader &) = delete;
+    CSVReader &operator=(const CSVReader &) = delete;
+
+    /**
+     * @brief Returns whether the file was opened.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Reads the next row and moves the cursor past it.
+     *
+     * @param row The fields of the row; its storage is reused between calls.
+     * @return bool False at the end of the file, or if the row is not made of integers or has the wrong
+     *         number of fields (see failed()).
+     */
+    bool nextRow(std::vector<int> &row);
+
+    /**
+     * @brief Reads the next row into an array of fixed size and moves the cursor past it.
+     *
+     * @param fields The array receiving the fields.
+     * @param count The size of the array; the row must have exactly this many fields.
+     * @return bool False at the end of the file, or if the row is malformed (see failed()).
+     */
+    bool nextRow(int *fields, std::size_t count);
+
+    /**
+     * @brief Skips lines until the cursor is on a given line.
+     *
+     * @param lineNumber The line to read next (1-based index); it must not be behind the cursor.
+     * @return bool False if the file ends first or the line is behind the cursor.
+     */
+    bool seekLine(int lineNumber);
+
+    /**
+     * @brief Returns the number of the last line read (1-based index), or 0 before the first row.
+     */
+    int lineNumber() const;
+
+    /**
+     * @brief Returns whether reading stopped on a malformed row rather than at the end of the file.
+     */
+    bool failed() const;
+
+private:
+    bool readLine();
+    bool parseLine(std::vector<int> &row, std::size_t expected);
+
+    std::ifstream file;
+    std::size_t fieldCount;
+    std::string line;             // Current line, reused between rows
+    std::vector<int> scratch;     // Fields of the current row for the array form of nextRow
+    int currentLine = 0;
+    bool error = false;
+    mutable std::mutex mutex;
+};
+
+/**
+ * @brief Appends rows to a CSV file through a memory buffer, keeping the file open between rows.
+ *
+ * Rows are written to the file when the buffer is full, on flush() and when the writer is destroyed, so
+ * appending a row costs a memory copy instead of an open, a write and a close. The writer can be shared
+ * between threads; each row is appended whole.
+ */
+class CSVBatchWriter {
+public:
+    /**
+     * @brief Opens a CSV file for appending, creating it if it doesn't exist.
+     *
+     * @param filePath The path to the CSV file.
+     * @param bufferSize The number of bytes buffered before they are written to the file.
+     */
+    explicit CSVBatchWriter(const std::string &filePath, std::size_t bufferSize = 1 << 20);
+
+    /**
+     * @brief Writes the buffered rows and closes the file.
+     */
+    ~CSVBatchWriter();
+
+    CSVBatchWriter(const CSVBatchWriter &) = delete;
+    CSVBatchWriter &operator=(const CSVBatchWriter &) = delete;
+
+    /**
+     * @brief Returns whether the file was opened.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Appends three elements as a comma-separated line, like exportToCSV.
+     *
+     * @return bool False if the file is not open or a write failed.
+     */
+    bool writeRow(const std::string &element1, const std::string &element2, const std::string &element3);
+
+    /**
+     * @brief Appends any number of elements as a comma-separated line.
+     *
+     * @return bool False if the file is not open or a write failed.
+     */
+    bool writeRow(const std::vector<std::string> &elements);
+
+    /**
+     * @brief Appends integers as a comma-separated line, without going through strings.
+     *
+     * @return bool False if the file is not open or a write failed.
+     */
+    bool writeRow(const int *fields, std::size_t count);
+
+    /**
+     * @brief Writes the buffered rows to the file.
+     *
+     * @return bool False if the file is not open or the write failed.
+     */
+    bool flush();
+
+    /**
+     * @brief Returns the number of rows appended so far.
+     */
+    std::size_t rowsWritten() const;
+
+private:
+    bool finishRow();
+    bool flushLocked();
+
+    std::ofstream file;
+    std::string buffer;
+    std::size_t bufferSize;
+    std::size_t rows = 0;
+    mutable std::mutex mutex;
+};
+
+#endif  // CSV_UTILS_H
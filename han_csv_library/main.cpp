@@ -1,4 +1,5 @@
 #include "csv_utils.h"
+#include <cstdio>
 #include <iostream>
 
 int main() {
@@ -23,5 +24,23 @@ int main() {
         std::cout << std::endl;
     }
 
+    // Demonstrate CSVBatchWriter and CSVReader, which keep the file open across many rows
+    std::string numbersPath = "numbers.csv";
+    std::remove(numbersPath.c_str());  // The writer appends, so start from an empty file on every run
+    {
+        CSVBatchWriter writer(numbersPath);
+        for (int i = 1; i <= 5; i++) {
+            int row[3] = {i, i * i, i * i * i};
+            writer.writeRow(row, 3);
+        }
+    }  // The writer flushes its buffer when it goes out of scope
+
+    std::cout << "\n--- Rows of " << numbersPath << " ---\n";
+    CSVReader reader(numbersPath, 3);
+    int row[3];
+    while (reader.nextRow(row, 3)) {
+        std::cout << "Line " << reader.lineNumber() << ": " << row[0] << " " << row[1] << " " << row[2] << "\n";
+    }
+
     return 0;
 }
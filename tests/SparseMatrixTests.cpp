@@ -0,0 +1,265 @@
+/**
+* CS/SE 3345 - Programming Assignment 1 - Sparse Matrix
+* Regression tests for what the CSV jobs of CS3345PA1_tests cannot reach: the SpMV kernels, corrupt binary files,
+* and the overflow checks.
+*
+* Build and run from the repository root:
+*   g++ -std=c++17 -O2 -pthread tests/SparseMatrixTests.cpp -o SparseMatrixTests && ./SparseMatrixTests
+*/
+
+#define SPARSE_MATRIX_NO_MAIN
+#include "../TANGPA1.cpp"
+
+#include <numeric>
+
+static int failures = 0;  // Checks that failed so far
+
+/**
+ * @brief Reports a failed check on stderr.
+ *
+ * @param bool passed Whether the check passed.
+ * @param const std::string & what What was checked, printed if it failed.
+ */
+static void check(bool passed, const std::string & what) {
+    if (!passed) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+/**
+ * @brief Checks that `run()` throws an exception of type E.
+ */
+template <typename E, typename Run>
+static void checkThrows(Run run, const std::string & what) {
+    try {
+        run();
+    } catch (const E &) {
+        return;
+    } catch (const std::exception & e) {
+        check(false, what + " (threw '" + e.what() + "' instead)");
+        return;
+    }
+    check(false, what + " (did not throw)");
+}
+
+/**
+ * @brief Builds a matrix whose non-zeros all lie in its last `fullRows` rows, which are full.
+ */
+template <typename T>
+static SparseMatrix<T> skewedMatrix(std::uint32_t numRow, std::uint32_t numCol, std::uint32_t fullRows) {
+    SparseMatrix<T> m(numRow, numCol);
+    for (std::uint32_t i = numRow - fullRows + 1; i <= numRow; i++) {
+        for (std::uint32_t j = 1; j <= numCol; j++) {
+            m.insert(T((i + j) % 7 + 1), i, j);
+        }
+    }
+    return m;
+}
+
+// The product of a matrix and a vector, one access() at a time
+template <typename T>
+static std::vector<T> referenceProduct(const SparseMatrix<T> & m, const std::vector<T> & x) {
+    std::vector<T> y(m.rowLength(), 0);
+    for (std::uint32_t i = 1; i <= m.rowLength(); i++) {
+        for (std::uint32_t j = 1; j <= m.colLength(); j++) {
+            y[i - 1] += m.access(i, j) * x[j - 1];
+        }
+    }
+    return y;
+}
+
+// SpMV on matrices whose non-zeros sit in their last rows, where the row partition used to run past the end
+template <typename T>
+static void testSkewedVectorProduct() {
+    static const std::uint32_t SHAPES[][3] = {{4, 100, 1}, {64, 100, 3}, {9, 37, 9}, {1, 20, 1}};
+    for (const std::uint32_t* shape : SHAPES) {
+        SparseMatrix<T> m = skewedMatrix<T>(shape[0], shape[1], shape[2]);
+        CSRMatrix<T> csr = m.toCSR();
+        std::vector<T> x(shape[1]);
+        for (std::size_t j = 0; j < x.size(); j++) {
+            x[j] = T(j % 5 + 1);
+        }
+        std::vector<T> expected = referenceProduct(m, x);
+        std::string name = std::to_string(shape[0]) + "x" + std::to_string(shape[1]) + " skewed SpMV";
+        check(csr.multiplyVector(x) == expected, name);
+        for (unsigned int threads : {2u, 3u, 8u}) {
+            ThreadPool pool(threads);
+            check(csr.multiplyVector(x, pool) == expected, name + " on " + std::to_string(threads) + " threads");
+        }
+    }
+}
+
+// The int32 SpMV kernels the CPU supports, with their names
+static std::vector<std::pair<VectorLinesKernel, const char*>> vectorKernels() {
+    std::vector<std::pair<VectorLinesKernel, const char*>> kernels;
+    kernels.emplace_back(&multiplyVectorLinesScalar<std::int32_t, std::uint32_t>, "scalar");
+#ifdef SPARSE_MATRIX_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.emplace_back(&multiplyVectorLinesAVX2, "avx2");
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        kernels.emplace_back(&multiplyVectorLinesAVX512, "avx512");
+    }
+#endif
+    return kernels;
+}
+
+// Every int32 kernel the CPU supports, called directly on each range of rows of a skewed matrix
+static void testVectorKernels() {
+    std::vector<std::pair<VectorLinesKernel, const char*>> kernels = vectorKernels();
+    SparseMatrix<> m = skewedMatrix<std::int32_t>(12, 45, 4);
+    CSRMatrix<> csr = m.toCSR();
+    std::vector<std::int32_t> x(45);
+    for (std::size_t j = 0; j < x.size(); j++) {
+        x[j] = std::int32_t(j) - 20;
+    }
+    std::vector<std::int32_t> expected = referenceProduct(m, x);
+    for (const auto & kernel : kernels) {
+        for (std::size_t first = 1; first <= 13; first++) {
+            for (std::size_t last = first; last <= 13; last++) {
+                std::vector<std::int32_t> y(12, 0);
+                kernel.first(csr.storage, x.data(), y.data(), first, last);
+                bool same = true;
+                for (std::size_t i = 1; i <= 12; i++) {
+                    same = same && y[i - 1] == (i >= first && i < last ? expected[i - 1] : 0);
+                }
+                check(same, std::string(kernel.second) + " kernel on rows [" + std::to_string(first) + ", " + std::to_string(last) + ")");
+            }
+        }
+    }
+}
+
+// Integer SpMV throws where a product or a partial sum in row order overflows, on every kernel, and only there
+static void testVectorOverflow() {
+    const std::int32_t big = std::int32_t(1) << 27;
+    SparseMatrix<> m(6, 20);
+    m.insert(std::int32_t(1) << 30, 1, 1);  // Row 1: 2^30 * 2 does not fit
+    m.insert(INT32_MAX, 2, 2);              // Row 2: INT32_MAX * 1 - INT32_MAX * 1 fits at every step
+    m.insert(-INT32_MAX, 2, 3);
+    m.insert(INT32_MIN, 3, 3);              // Row 3: INT32_MIN * 1 fits
+    for (std::uint32_t j = 1; j <= 20; j++) {
+        m.insert(big, 4, j);                // Row 4: 21 * 2^27 does not fit
+        m.insert(j % 2 == 1 ? big : -big, 5, j);  // Row 5: the sums stay between 2^27 and 2^28
+        m.insert(j <= 15 ? big : -big, 6, j);     // Row 6: 16 * 2^27 overflows before the last 5 entries
+    }
+    std::vector<std::int32_t> x(20, 1);
+    x[0] = 2;  // Column 1 counts twice
+    static const bool OVERFLOWS[] = {true, false, false, true, false, true};
+    const std::int32_t expected[] = {0, 0, INT32_MIN, 0, big, 0};
+    CSRMatrix<> csr = m.toCSR();
+    for (const auto & kernel : vectorKernels()) {
+        for (std::size_t i = 1; i <= 6; i++) {
+            std::string name = std::string(kernel.second) + " kernel on overflow row " + std::to_string(i);
+            std::vector<std::int32_t> y(6, 0);
+            if (OVERFLOWS[i - 1]) {
+                checkThrows<std::overflow_error>([&]() { kernel.first(csr.storage, x.data(), y.data(), i, i + 1); }, name);
+            } else {
+                kernel.first(csr.storage, x.data(), y.data(), i, i + 1);
+                check(y[i - 1] == expected[i - 1], name);
+            }
+        }
+    }
+    ThreadPool pool(2);
+    checkThrows<std::overflow_error>([&]() { csr.multiplyVector(x, pool); }, "parallel CSR SpMV overflow");
+    checkThrows<std::overflow_error>([&]() { m.multiplyVector(x); }, "list SpMV overflow");
+    checkThrows<std::overflow_error>([&]() { m.multiplyVector(x, pool); }, "parallel list SpMV overflow");
+    std::vector<std::int32_t> ones(6, 1);
+    checkThrows<std::overflow_error>([&]() { csr.multiplyVectorTransposed(ones); }, "transposed CSR SpMV overflow");
+    checkThrows<std::overflow_error>([&]() { csr.multiplyVectorTransposed(ones, pool); }, "parallel transposed CSR SpMV overflow");
+    checkThrows<std::overflow_error>([&]() { m.multiplyVectorTransposed(ones); }, "transposed list SpMV overflow");
+}
+
+/**
+ * @brief Writes a 2x3 int32 binary matrix file with the given row pointers and column indices, and values 1, 2...
+ */
+static void writeBinaryFile(const std::string & path, const std::vector<std::uint64_t> & rowPtr, const std::vector<std::uint32_t> & colIndex) {
+    static const char zeros[8] = {0};
+    std::vector<std::int32_t> values(colIndex.size());
+    std::iota(values.begin(), values.end(), 1);
+    BinaryMatrixFile::Header header = BinaryMatrixFile::makeHeader<std::int32_t>(rowPtr.size() - 1, 3, colIndex.size());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(rowPtr.data()), rowPtr.size() * sizeof(std::uint64_t));
+    file.write(reinterpret_cast<const char*>(colIndex.data()), colIndex.size() * sizeof(std::uint32_t));
+    file.write(zeros, BinaryMatrixFile::padded(colIndex.size() * 4) - colIndex.size() * 4);
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(std::int32_t));
+    file.write(zeros, BinaryMatrixFile::padded(values.size() * 4) - values.size() * 4);
+}
+
+// Binary files whose rows are unsorted, hold a column twice or point outside the arrays are refused on load
+static void testCorruptBinaryFile() {
+    const std::string path = "SparseMatrixTests_corrupt.smb";
+    writeBinaryFile(path, {0, 2, 3}, {1, 3, 2});
+    check(BinaryMatrixFile(path).toCSR<std::int32_t>().nonZeros() == 3, "valid binary file");
+
+    static const struct {
+        std::vector<std::uint64_t> rowPtr;
+        std::vector<std::uint32_t> colIndex;
+        const char* what;
+    } CORRUPT[] = {
+        {{0, 2, 3}, {2, 1, 3}, "unsorted columns"},
+        {{0, 2, 3}, {2, 2, 3}, "duplicate column"},
+        {{0, 2, 3}, {1, 4, 2}, "column past numCol"},
+        {{0, 2, 3}, {0, 1, 2}, "column 0"},
+        {{0, 3, 1, 3}, {1, 2, 3}, "decreasing row pointers"},
+        {{0, 5, 3}, {1, 2, 3}, "row pointer past nonZeros"},
+    };
+    for (const auto & corrupt : CORRUPT) {
+        writeBinaryFile(path, corrupt.rowPtr, corrupt.colIndex);
+        checkThrows<std::runtime_error>([&]() { BinaryMatrixFile file(path); }, std::string("binary file with ") + corrupt.what);
+    }
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Writes `text` to the file at `path`.
+ */
+static void writeTextFile(const std::string & path, const std::string & text) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << text;
+}
+
+// Skew-symmetric files mirror every entry negated, which must fit in T, and cannot have diagonal entries
+static void testSkewSymmetricMatrixMarket() {
+    const std::string path = "SparseMatrixTests_skew.mtx";
+    writeTextFile(path, "%%MatrixMarket matrix coordinate integer skew-symmetric\n3 3 2\n2 1 5\n3 2 -7\n");
+    SparseMatrix<> m = SparseMatrix<>::importMatrixMarket(path);
+    check(m.access(2, 1) == 5 && m.access(1, 2) == -5 && m.access(2, 3) == 7 && m.access(3, 2) == -7 && m.toCSR().nonZeros() == 4,
+          "skew-symmetric import");
+
+    writeTextFile(path, "%%MatrixMarket matrix coordinate integer skew-symmetric\n3 3 1\n2 1 -2147483648\n");
+    checkThrows<std::overflow_error>([&]() { SparseMatrix<>::importMatrixMarket(path); }, "skew-symmetric entry INT32_MIN");
+    check(SparseMatrix<std::int64_t>::importMatrixMarket(path).access(1, 2) == 2147483648LL, "skew-symmetric entry INT32_MIN as int64");
+
+    writeTextFile(path, "%%MatrixMarket matrix coordinate integer skew-symmetric\n3 3 1\n2 2 4\n");
+    checkThrows<std::runtime_error>([&]() { SparseMatrix<>::importMatrixMarket(path); }, "skew-symmetric diagonal entry");
+    std::remove(path.c_str());
+}
+
+// A size line claiming far more entries than the file holds is a truncated file, not an allocation failure
+static void testTruncatedMatrixMarket() {
+    const std::string path = "SparseMatrixTests_truncated.mtx";
+    writeTextFile(path, "%%MatrixMarket matrix coordinate integer symmetric\n3 3 100000000000\n1 1 1\n2 1 3\n");
+    checkThrows<std::runtime_error>([&]() { SparseMatrix<>::importMatrixMarket(path); }, "Matrix Market file with 1e11 entries declared");
+    std::remove(path.c_str());
+}
+
+int main() {
+    testSkewedVectorProduct<std::int32_t>();
+    testSkewedVectorProduct<std::int64_t>();
+    testSkewedVectorProduct<double>();
+    testVectorKernels();
+    testVectorOverflow();
+    testCorruptBinaryFile();
+    testSkewSymmetricMatrixMarket();
+    testTruncatedMatrixMarket();
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All tests passed" << std::endl;
+    return 0;
+}